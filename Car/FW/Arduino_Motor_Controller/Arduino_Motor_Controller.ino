@@ -74,6 +74,19 @@ const int echoPin = 9;
 
 #define SENSOR_HZ 25
 
+// Ultrazvucni senzor: merenje je gotovo ili isteklo posle ECHO_TIMEOUT_US
+// (~5 m), a novo pocinje najranije RANGE_PERIOD_MS posle prethodnog,
+// da se odjeci dva merenja ne pomesaju.
+#define ECHO_TIMEOUT_US 30000UL
+#define RANGE_PERIOD_MS 60
+
+// Protokol v2: ENC_SAMPLES uzoraka enkodera u paketu, pa se enkoder
+// uzorkuje ENC_SAMPLES puta brze nego sto se salje.
+// Timer0 (millis) broji do 256 sa preskalerom 64, tj. 1024 us po krugu.
+#define TIMER0_TICK_US (64UL*256*1000000/(F_CPU))
+#define ENC_SAMPLE_TICKS (1000/(SENSOR_HZ)/(ENC_SAMPLES))
+#define ENC_SAMPLE_PERIOD_US ((ENC_SAMPLE_TICKS)*(TIMER0_TICK_US))
+
 ///////////////////////////////////////////////////////////////////////////////
 #define BLDC 0
 #define SERVO 1
@@ -88,6 +101,8 @@ const int echoPin = 9;
 
 #include "fw_pkgs.hpp"
 
+#include "echo_ranger.hpp"
+
 #include <Servo.h>
 
 //bool console_mode = true;  // start u konzolnom režimu radi testiranja
@@ -519,18 +534,128 @@ ISR(PCINT1_vect) {
   prev = curr;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Serije uzoraka enkodera za protokol v2.
+
+// Verzija u kojoj se salje telemetrija, menja je pkg_hello_t od hosta.
+u8 proto_version;
+
+struct enc_batch_t {
+  u16 seq;
+  u32 t_us;
+  i32 enc[ENC_SAMPLES];
+};
+
+/**
+ * Dvostruki bafer: ISR puni enc_batches[enc_batch_fill], a kad ga napuni
+ * okrece bafere i postavlja enc_batch_ready. Ako loop() ne stigne da posalje
+ * seriju pre sledece, starija se pregazi, a host to vidi kao rupu u seq.
+ * read/write:
+ *     - ISR(TIMER0_COMPA_vect)
+ *     - take_enc_batch()
+*/
+volatile enc_batch_t enc_batches[2];
+volatile u8 enc_batch_fill;
+volatile bool enc_batch_ready;
+
+// Serija koju loop() salje, kopija iz enc_batches.
+enc_batch_t enc_batch_out;
+
+// Timer0 compare A, jednom po krugu timer0 (TIMER0_TICK_US).
+// Fiksan period prekida daje uzorke u tacno poznatim trenucima,
+// nezavisno od toga koliko dugo loop() blokira.
+ISR(TIMER0_COMPA_vect) {
+  static u8 ticks;
+  static u8 idx;
+  static u16 seq;
+
+  if(++ticks < ENC_SAMPLE_TICKS){
+    return;
+  }
+  ticks = 0;
+
+  // PCINT1 ne moze da prekine ovaj ISR, pa je citanje enc atomicno.
+  volatile enc_batch_t& b = enc_batches[enc_batch_fill];
+  b.enc[idx] = enc;
+  if(++idx < ENC_SAMPLES){
+    return;
+  }
+  idx = 0;
+  b.t_us = micros();
+  b.seq = seq++;
+
+  enc_batch_fill ^= 1;
+  enc_batch_ready = true;
+}
+
+// Kopira poslednju punu seriju u enc_batch_out; false ako nove serije nema.
+bool take_enc_batch() {
+  bool ready;
+  noInterrupts();
+  ready = enc_batch_ready;
+  if(ready){
+    volatile enc_batch_t& b = enc_batches[enc_batch_fill ^ 1];
+    enc_batch_out.seq = b.seq;
+    enc_batch_out.t_us = b.t_us;
+    for(u8 i = 0; i < ENC_SAMPLES; i++){
+      enc_batch_out.enc[i] = b.enc[i];
+    }
+    enc_batch_ready = false;
+  }
+  interrupts();
+  return ready;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //NOVO
-uint32_t getPulseDuration() {
+
+/**
+ * Merenje echo impulsa, umesto pulseIn() koji je blokirao send_pkg().
+ * read/write:
+ *     - pcint0_hook() (ISR(PCINT0_vect) iz SoftwareSerial2)
+ *     - ranger_update()
+ *     - getPulseDuration()
+*/
+Echo_Ranger ranger(ECHO_TIMEOUT_US);
+
+// Zove ga ISR(PCINT0_vect) na svaku promenu na portu B.
+// echoPin 9 je PB1 (PCINT1).
+void pcint0_hook() {
+  ranger.edge(PINB & _BV(PB1), micros());
+}
+
+// Iz loop(): zavrsava isteklo merenje i pokrece novo kad je vreme.
+// Jedino cekanje je trigger impuls od 12 us.
+void ranger_update() {
+  static unsigned long t_prev;
+
+  noInterrupts();
+  ranger.poll(micros());
+  bool idle = ranger.idle();
+  interrupts();
+
+  if(!idle || millis() - t_prev < RANGE_PERIOD_MS){
+    return;
+  }
+  t_prev = millis();
+
+  noInterrupts();
+  ranger.start(micros());
+  interrupts();
+
   digitalWrite(trigPin, LOW);
   delayMicroseconds(2);
   digitalWrite(trigPin, HIGH);
   delayMicroseconds(10);
   digitalWrite(trigPin, LOW);
+}
 
-  // pulseIn vraća unsigned long (uint32_t), što predstavlja mikrosekunde
-  uint32_t duration = pulseIn(echoPin, HIGH);
+// Poslednje zavrseno merenje u mikrosekundama (0 ako echo nije stigao).
+uint32_t getPulseDuration() {
+  noInterrupts();
+  uint32_t duration = ranger.pulse_us();
+  interrupts();
   /*test
   Serial.print("Distance: ");
   Serial.println(duration*.0343/2);
@@ -547,6 +672,8 @@ void setup() {
   //NOVO
   pinMode(trigPin, OUTPUT);
   pinMode(echoPin, INPUT);
+  irq.pcie0 = 1; // Port B, echo ide kroz pcint0_hook()
+  irq.pcint01 = 1; // omoguci prekid za pin 9 (PCINT1)
   ///////////////////////////////////////////////////////////////////////////////
 
   servo.attach(M1_PWM); // pin 8 za servo
@@ -591,6 +718,13 @@ void setup() {
   // irq.pcint10 = 1;
   // irq.pcint11 = 1;
 
+  // Uzorkovanje enkodera za v2 na compare A timer0, pored millis() prekida.
+  // Pin 6 (OC0A) nije PWM izlaz, pa OCR0A ne menja nista drugo.
+  enc_batch_fill = 0;
+  enc_batch_ready = false;
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+
   
   // for(u8 i = 0; i < 2; i++){
   //  set_target_speed(i, 0);
@@ -603,6 +737,7 @@ void setup() {
   steering_angle_o = 90;
   enc = 0;
   watchdog_cnt = 255;
+  proto_version = 1; // v2 tek kad ga host zatrazi
   
   set_target_speed(0);
   set_target_steering_angle(90);
@@ -663,6 +798,7 @@ void setup() {
   //DEBUG(DEFUALT_BAUDRATE);
   DEBUG(sizeof(pkg_m2s_t));
   DEBUG(sizeof(pkg_s2m_t));
+  DEBUG(sizeof(pkg_s2m_v2_t));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -677,7 +813,9 @@ void poll_pkg() {
 
   int len;
 
+  // Komandni paket ili hello (izbor verzije protokola).
   pkg_magic_t exp_magic = PKG_MAGIC;
+  pkg_magic_t hello_magic = PKG_HELLO_MAGIC;
   pkg_magic_t obs_magic = 0;
   
   for(u8 i = 0; i < sizeof(pkg_magic_t); i++){
@@ -695,7 +833,9 @@ void poll_pkg() {
 
     if(
       reinterpret_cast<u8*>(&exp_magic)[i] !=
-      reinterpret_cast<u8*>(&obs_magic)[i]
+        reinterpret_cast<u8*>(&obs_magic)[i] &&
+      reinterpret_cast<u8*>(&hello_magic)[i] !=
+        reinterpret_cast<u8*>(&obs_magic)[i]
     ){
       // Lost magic.
       //sw_ser.println("ERROR: Lost magic!");
@@ -703,6 +843,15 @@ void poll_pkg() {
     }
   }
 
+  if(obs_magic == PKG_HELLO_MAGIC){
+    poll_hello();
+    return;
+  }
+  if(obs_magic != PKG_MAGIC){
+    // Bajtovi su iz dva razlicita magic-a.
+    return;
+  }
+
   pkg_m2s_t p;
   p.magic = obs_magic;
 
@@ -734,6 +883,32 @@ void poll_pkg() {
   watchdog_rst();
 }
 
+// Ostatak pkg_hello_t, magic je vec procitan u poll_pkg().
+void poll_hello() {
+  pkg_hello_t h;
+  int len = Serial.readBytes(
+    reinterpret_cast<u8*>(&h) + sizeof(pkg_magic_t),
+    sizeof(h) - sizeof(pkg_magic_t)
+  );
+  if(len != sizeof(h) - sizeof(pkg_magic_t)){
+    return;
+  }
+  if(CRC16().add(h.payload).get_crc() != h.crc){
+    return;
+  }
+
+  // Verzija 0 ne postoji, a vise od PKG_PROTOCOL_VERSION ne znamo.
+  u8 v = h.payload.version;
+  if(v < 1){
+    v = 1;
+  }
+  if(v > PKG_PROTOCOL_VERSION){
+    v = PKG_PROTOCOL_VERSION;
+  }
+  proto_version = v;
+  DEBUG(proto_version);
+}
+
 void print_status() {
   static u8 cnt;
   cnt++;
@@ -783,9 +958,7 @@ void print_status_if_changed() {
 
 
 // Metoda za popunjavanje paketa koji se salje sa mikrokontrolera na pc
-void send_pkg() {
-  pkg_s2m_t p;
-  p.magic = PKG_MAGIC;
+void read_status(pkg_s2m_t& p) {
 
   // TODO: Zakomentarisati enkoder jer nam ne treba, realizovati slanje rezultata ultrazvucnog senzora
   // Voting read.
@@ -817,6 +990,13 @@ void send_pkg() {
   //NOVO
   p.payload.ultrasound_pulse = getPulseDuration();
   ///////////////////////////////////////////////////////////////////////////////
+}
+
+// Protokol v1: jedno stanje enkodera po paketu.
+void send_pkg() {
+  pkg_s2m_t p;
+  p.magic = PKG_MAGIC;
+  read_status(p);
   p.crc = CRC16().add(p.payload).get_crc();
 
   // Upisuje paket
@@ -827,6 +1007,38 @@ void send_pkg() {
 }
 
 
+// Protokol v2: serija enc_batch_out sa rednim brojem i vremenom.
+void send_pkg_v2() {
+  pkg_s2m_t s;
+  read_status(s);
+
+  pkg_s2m_v2_t p;
+  p.magic = PKG_V2_MAGIC;
+  p.payload.version = PKG_PROTOCOL_VERSION;
+  p.payload.seq = enc_batch_out.seq;
+  p.payload.t_us = enc_batch_out.t_us;
+  p.payload.sample_period_us = ENC_SAMPLE_PERIOD_US;
+  for(u8 i = 0; i < ENC_SAMPLES; i++){
+    p.payload.enc[i] = enc_batch_out.enc[i];
+  }
+  p.payload.speed_i = s.payload.speed_i;
+  p.payload.speed_o = s.payload.speed_o;
+  p.payload.steering_angle_i = s.payload.steering_angle_i;
+  p.payload.steering_angle_o = s.payload.steering_angle_o;
+  // Merenje i njegov redni broj zajedno, da se ne pomesaju dva merenja.
+  noInterrupts();
+  p.payload.ultrasound_pulse = ranger.pulse_us();
+  p.payload.ultrasound_cnt = ranger.measurements;
+  interrupts();
+  p.crc = CRC16().add(p.payload).get_crc();
+
+  Serial.write(
+    reinterpret_cast<u8*>(&p),
+    sizeof(p)
+  );
+}
+
+
 typedef unsigned long ms_t;
 
 void loop() {
@@ -841,6 +1053,7 @@ void loop() {
 
   
   poll_pkg();
+  ranger_update();
   print_status_if_changed();
   
   ///////////////////////////////////////////////////////////////////////////////
@@ -856,13 +1069,26 @@ void loop() {
   ///////////////////////////////////////////////////////////////////////////////
 
   // Send slower than reading.
-  static ms_t t_prev;
-  ms_t t_curr = millis();
-  
-  if((t_curr - t_prev) > 1000/SENSOR_HZ) {
-    t_prev = t_curr;
-    send_pkg();
+  bool sent = false;
+  if(proto_version >= 2){
+    // Tempo diktira ISR(TIMER0_COMPA_vect): serija na svakih
+    // ENC_SAMPLES*ENC_SAMPLE_PERIOD_US.
+    if(take_enc_batch()){
+      send_pkg_v2();
+      sent = true;
+    }
+  }else{
+    static ms_t t_prev;
+    ms_t t_curr = millis();
+
+    if((t_curr - t_prev) > 1000/SENSOR_HZ) {
+      t_prev = t_curr;
+      send_pkg();
+      sent = true;
+    }
+  }
 
+  if(sent) {
     static u16 cnt = 0;
     cnt++;
     if(cnt == SENSOR_HZ*5){
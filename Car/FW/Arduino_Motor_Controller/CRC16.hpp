@@ -2,40 +2,99 @@
 
 #include <stdint.h>
 
+#if __AVR__
+#include <avr/pgmspace.h>
+#endif
+
 // 0xa001 is the reversed polynomial for CRC-16/ARC (0x8005)
 #define CRC16_DEFAULT_POLYNOME 0xa001
 #define CRC16_POLYNOME CRC16_DEFAULT_POLYNOME
 
+// Shared verbatim by the firmware (Car/FW/Arduino_Motor_Controller) and the
+// host (ackibot_node/include): keep both copies identical.
+//
+// The lookup tables are generated by the compiler from CRC16_POLYNOME with
+// C++11 constexpr, so avr-gcc and the host build the same values.
+// crc16_table[0][i] is the CRC of byte i, crc16_table[k][i] the CRC of
+// byte i followed by k zero bytes (used by slice-by-8).
+namespace crc16_detail {
+	constexpr uint16_t step(uint16_t c) {
+		return (c & 1) ? (c >> 1) ^ CRC16_POLYNOME : c >> 1;
+	}
+
+	constexpr uint16_t entry(uint16_t c, uint8_t bits = 8) {
+		return bits ? entry(step(c), bits - 1) : c;
+	}
+
+	constexpr uint16_t zero_byte(uint16_t c) {
+		return (c >> 8) ^ entry(c & 0xff);
+	}
+
+	constexpr uint16_t slice(uint8_t k, uint16_t i) {
+		return k ? zero_byte(slice(k - 1, i)) : entry(i);
+	}
+}
+
+#define CRC16_T4(k, i) \
+	crc16_detail::slice(k, (i)), crc16_detail::slice(k, (i) + 1), \
+	crc16_detail::slice(k, (i) + 2), crc16_detail::slice(k, (i) + 3)
+#define CRC16_T16(k, i) \
+	CRC16_T4(k, (i)), CRC16_T4(k, (i) + 4), CRC16_T4(k, (i) + 8), CRC16_T4(k, (i) + 12)
+#define CRC16_T64(k, i) \
+	CRC16_T16(k, (i)), CRC16_T16(k, (i) + 16), CRC16_T16(k, (i) + 32), CRC16_T16(k, (i) + 48)
+#define CRC16_T256(k) \
+	{ CRC16_T64(k, 0), CRC16_T64(k, 64), CRC16_T64(k, 128), CRC16_T64(k, 192) }
+
+#if __AVR__
+// 512 B of flash, no RAM. The firmware includes this from one translation unit.
+static const uint16_t crc16_table[1][256] PROGMEM = { CRC16_T256(0) };
+#define CRC16_LOOKUP(i) pgm_read_word(&crc16_table[0][(i)])
+#else
+// 4 KB, one copy per program (C++17 inline variable).
+inline constexpr uint16_t crc16_table[8][256] = {
+	CRC16_T256(0), CRC16_T256(1), CRC16_T256(2), CRC16_T256(3),
+	CRC16_T256(4), CRC16_T256(5), CRC16_T256(6), CRC16_T256(7)
+};
+#define CRC16_LOOKUP(i) crc16_table[0][(i)]
+#endif
+
 // CRC-16/ARC (also known as CRC-16/IBM)
 class CRC16 {
 public:
 	CRC16() {
 		restart();
 	}
-	
+
 	void restart() {
 		_crc = 0; // Or 0xffff for CRC-16/CCITT
 	}
 
+	// One table lookup per byte instead of 8 shift/xor steps.
 	CRC16& add(uint8_t value) {
-		_crc ^= value;
-		for(uint8_t i = 8; i; i--){
-			if(_crc & 1){
-				_crc = (_crc >> 1) ^ CRC16_POLYNOME;
-			}else{
-				_crc = _crc >> 1;
-			}
-		}
+		_crc = (_crc >> 8) ^ CRC16_LOOKUP((_crc ^ value) & 0xff);
 		return *this;
 	}
-	
+
 	CRC16& add(const uint8_t* array, uint16_t length) {
+#if !__AVR__
+		// Slice-by-8: 8 independent lookups per 8 bytes.
+		while(length >= 8){
+			const uint16_t c = _crc ^ (array[0] | (array[1] << 8));
+			_crc =
+				crc16_table[7][c & 0xff] ^ crc16_table[6][c >> 8] ^
+				crc16_table[5][array[2]] ^ crc16_table[4][array[3]] ^
+				crc16_table[3][array[4]] ^ crc16_table[2][array[5]] ^
+				crc16_table[1][array[6]] ^ crc16_table[0][array[7]];
+			array += 8;
+			length -= 8;
+		}
+#endif
 		while(length--){
 			add(*array++);
 		}
 		return *this;
 	}
-	
+
 	template<typename T>
 	CRC16& add(const T& t) {
 		add((uint8_t*)&t, sizeof(T));
@@ -224,9 +224,17 @@ inline void SoftwareSerial::handle_interrupt()
   }
 }
 
+// The sketch can override this to see other pins of the same
+// pin change vector (e.g. the ultrasonic echo pin on port B).
+void pcint0_hook() __attribute__((weak));
+void pcint0_hook()
+{
+}
+
 #if defined(PCINT0_vect)
 ISR(PCINT0_vect)
 {
+  pcint0_hook();
   SoftwareSerial::handle_interrupt();
 }
 #endif
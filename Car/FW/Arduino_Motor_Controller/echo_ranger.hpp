@@ -0,0 +1,101 @@
+#pragma once
+
+#include "type_shorts.h"
+
+// Non-blocking merenje echo impulsa ultrazvucnog senzora (HC-SR04),
+// umesto pulseIn() koji blokira loop() dok impuls ne stigne.
+//
+// loop() posalje trigger impuls i pozove start(), prekid na promenu echo
+// pina zove edge() sa nivoom pina i vremenom micros(), a loop() povremeno
+// zove poll() koji zavrsava merenje kome je isteklo vreme. pulse_us() je
+// poslednje zavrseno merenje, kao rezultat pulseIn(): trajanje visokog
+// nivoa u us, 0 ako echo nije stigao na vreme.
+//
+// Vremena su u32 iz micros(), razlike rade i preko prelivanja.
+// Na AVR-u loop() zove metode sa zabranjenim prekidima.
+// Bez zavisnosti od Arduino-a, pa se testira i na hostu.
+class Echo_Ranger {
+public:
+	enum state_t {
+		IDLE,		// nema merenja u toku
+		WAIT_RISE,	// trigger poslat, ceka se pocetak echo impulsa
+		WAIT_FALL	// echo impuls traje
+	};
+
+	explicit Echo_Ranger(u32 timeout_us)
+		: timeout_us(timeout_us)
+	{
+		state = IDLE;
+		t_start = 0;
+		t_rise = 0;
+		last_pulse_us = 0;
+		measurements = 0;
+		timeouts = 0;
+	}
+
+	// Poziva se uz trigger impuls.
+	void start(u32 t_us) {
+		t_start = t_us;
+		state = WAIT_RISE;
+	}
+
+	// Promena echo pina, iz prekida. Isti nivo dva puta se ignorise.
+	void edge(bool level, u32 t_us) {
+		switch(state){
+		case WAIT_RISE:
+			// Silazna ivica pre uzlazne je ostatak prethodnog echo impulsa.
+			if(level){
+				t_rise = t_us;
+				state = WAIT_FALL;
+			}
+			break;
+		case WAIT_FALL:
+			if(!level){
+				finish(t_us - t_rise);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Zavrsava merenje kome je isteklo vreme, iz loop().
+	void poll(u32 t_us) {
+		if(state == WAIT_RISE && t_us - t_start > timeout_us){
+			timeouts++;
+			finish(0);
+		}else if(state == WAIT_FALL && t_us - t_rise > timeout_us){
+			// Senzor bez prepreke drzi echo ~38 ms.
+			timeouts++;
+			finish(0);
+		}
+	}
+
+	bool idle() const {
+		return state == IDLE;
+	}
+
+	state_t get_state() const {
+		return state;
+	}
+
+	u32 pulse_us() const {
+		return last_pulse_us;
+	}
+
+	uint16_t measurements;	// zavrsena merenja, ukljucujuci istekla
+	uint16_t timeouts;	// merenja bez echo impulsa
+
+private:
+	void finish(u32 pulse) {
+		last_pulse_us = pulse;
+		measurements++;
+		state = IDLE;
+	}
+
+	u32 timeout_us;
+	state_t state;
+	u32 t_start;
+	u32 t_rise;
+	u32 last_pulse_us;
+};
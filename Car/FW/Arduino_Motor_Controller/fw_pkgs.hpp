@@ -38,6 +38,46 @@ struct_packed pkg_s2m_t {
     pkg_crc_t crc;
 };
 
+// Protokol v2: telemetrija u serijama, sa rednim brojem i vremenom MCU-a.
+//
+// Posle reseta firmware uvek salje v1 (pkg_s2m_t), pa stari host radi kao
+// ranije. Host koji zna v2 salje pkg_hello_t sa verzijom koju zeli, a
+// firmware prelazi na min(version, PKG_PROTOCOL_VERSION). Stari firmware
+// ne prepoznaje PKG_HELLO_MAGIC i odbaci hello kao sum, pa ostaje na v1.
+// Host zato u svakom trenutku prihvata i v1 i v2 pakete.
+#define PKG_PROTOCOL_VERSION 2
+#define PKG_HELLO_MAGIC 0xbe11
+#define PKG_V2_MAGIC 0xbef2
+
+// Broj uzoraka enkodera u jednom v2 paketu.
+#define ENC_SAMPLES 4
+
+struct_packed pkg_hello_t {
+	pkg_magic_t magic;
+	struct_packed {
+		u8 version; // verzija koju host zeli
+	} payload;
+	pkg_crc_t crc;
+};
+
+struct_packed pkg_s2m_v2_t {
+	pkg_magic_t magic;
+	struct_packed {
+		u8 version;           // verzija u kojoj firmware salje, PKG_PROTOCOL_VERSION
+		u16 seq;              // redni broj serije; rupa znaci izgubljene serije
+		u32 t_us;             // micros() MCU-a za enc[ENC_SAMPLES-1]
+		u16 sample_period_us; // razmak izmedju uzastopnih uzoraka enc[]
+		i32 enc[ENC_SAMPLES]; // najstariji uzorak prvi
+		i16 speed_i;
+		i16 speed_o;
+		i16 steering_angle_i;
+		i16 steering_angle_o;
+		u32 ultrasound_pulse; // sirovi pulseIn (mikrosekunde)
+		u16 ultrasound_cnt;   // broj zavrsenih merenja; isti broj je ponovljeno merenje
+	} payload;
+	pkg_crc_t crc;
+};
+
 
 #if !__AVR__ && 0
 
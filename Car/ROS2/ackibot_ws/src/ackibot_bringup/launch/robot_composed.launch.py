@@ -0,0 +1,144 @@
+#!/usr/bin/env python3  # koristi Python 3 interpreter za izvršenje fajla
+
+# twist_mux, fw_node i diff_drive_controller rade kao komponente u jednom
+# procesu (component_container).
+# Sa use_intra_process_comms komanda od twist_mux do fw_node ide kao pokazivac,
+# bez DDS serijalizacije. fw_node periodicno ispisuje "cmd_vel latency",
+# pa se kasnjenje moze uporediti sa robot_separate.launch.py (ista topologija,
+# odvojeni procesi); postupak i rezultati su u README.md paketa.
+
+import os  # rad sa fajl sistemom
+from ament_index_python.packages import get_package_share_directory  # vraća putanju do foldera paketa
+from launch import LaunchDescription  # koristi se za kreiranje ROS2 launch opisa
+from launch.actions import (
+    DeclareLaunchArgument,  # deklaracija argumenta koji se može proslediti launch fajlu
+    OpaqueFunction,  # omogućava pozivanje funkcije prilikom pokretanja launch fajla
+    IncludeLaunchDescription  # uključivanje drugog launch fajla
+)
+from launch.launch_description_sources import PythonLaunchDescriptionSource  # za pokretanje Python launch fajlova
+from launch.substitutions import (
+    LaunchConfiguration,  # omogućava parametre koji se mogu menjati pri pokretanju launch fajla
+    ThisLaunchFileDir  # putanja do trenutnog launch fajla
+)
+from launch_ros.actions import ComposableNodeContainer  # proces u koji se ucitavaju komponente
+from launch_ros.descriptions import ComposableNode  # opis jedne komponente
+from launch.conditions import IfCondition  # uslov za uključivanje launch fajlova
+
+from ackibot_utils.utils import show  # funkcija za ispis u konzolu
+from ackibot_utils.usb_mapper import USB_Mapper  # pronalazi USB uređaje po klasi
+
+
+def launch_setup(context, *args, **kwargs):
+    en_teleop = LaunchConfiguration('en_teleop', default='true')  # da li uključiti teleop
+    use_sim_time = LaunchConfiguration('use_sim_time', default='false')  # parametar za simulaciono vreme
+    joypad = LaunchConfiguration('joypad', default='sony')  # koji joypad koristiti
+    port = LaunchConfiguration('port', default='').perform(context)  # port firmware-a, npr. od fw_emulator-a
+
+    arduino_port = port
+    if not arduino_port:
+        um = USB_Mapper()  # kreira instancu USB maper-a
+        show(um.table)  # ispis svih USB uređaja
+        arduino_port = um.get_exactly_1_dev_of_class('Arduino')  # pronalazi tačno jedan Arduino uređaj
+    show(arduino_port)  # ispis porta Arduino uređaja
+
+    params_fn = os.path.join(
+        get_package_share_directory('ackibot_bringup'),
+        'param',
+        'ackibot.yaml'  # parametri za fw_node i diff_drive_controller
+    )
+    twist_mux_fn = os.path.join(
+        get_package_share_directory('ackibot_bringup'),
+        'config',
+        'twist_mux_topics.yaml'  # ulazi twist_mux-a
+    )
+
+    intra_process = [{'use_intra_process_comms': True}]  # ukljucuje intra-process za komponentu
+
+    return [
+        DeclareLaunchArgument(
+            'use_sim_time',
+            default_value=use_sim_time,
+            description='Use simulation (Gazebo) clock if true'),
+        DeclareLaunchArgument(
+            'en_teleop',
+            default_value=en_teleop,
+            description='launch teleop'
+        ),
+        DeclareLaunchArgument(
+            'joypad',
+            default_value='sony'
+        ),
+        DeclareLaunchArgument(
+            'port',
+            default_value='',
+            description='firmware serial port; empty finds the Arduino'
+        ),
+
+        IncludeLaunchDescription(
+            PythonLaunchDescriptionSource([
+                ThisLaunchFileDir(),
+                '/state_publisher.launch.py'
+            ]),
+            launch_arguments={'use_sim_time': use_sim_time}.items(),
+        ),
+
+        IncludeLaunchDescription(
+            PythonLaunchDescriptionSource([
+                os.path.join(
+                    get_package_share_directory('ackibot_teleop'),
+                    'launch',
+                    'teleop.launch.py'
+                )
+            ]),
+            launch_arguments={
+                'machine': 'sbc',
+                'joypad': joypad
+            }.items(),
+            condition=IfCondition(en_teleop),
+        ),
+
+        ComposableNodeContainer(
+            name='drive_container',  # ime procesa sa komponentama
+            namespace='',
+            package='rclcpp_components',
+            executable='component_container',  # jedan SingleThreadedExecutor za sve komponente
+            output='screen',
+            composable_node_descriptions=[
+                ComposableNode(
+                    package='twist_mux',
+                    plugin='twist_mux::TwistMux',
+                    name='twist_mux',
+                    parameters=[twist_mux_fn],
+                    remappings=[
+                        ('cmd_vel_out', '/cmd_vel_node'),  # izlaz ide direktno u fw_node
+                    ],
+                    extra_arguments=intra_process,
+                ),
+                ComposableNode(
+                    package='ackibot_node',
+                    plugin='FW_Node',
+                    name='fw_node',
+                    parameters=[params_fn, {'usb_port': arduino_port}],  # port umesto -i argumenta
+                    remappings=[
+                        ('cmd_vel', '/cmd_vel_node'),  # ulaz komandnog topika je izlaz twist_mux-a
+                    ],
+                    extra_arguments=intra_process,
+                ),
+                ComposableNode(
+                    package='ackibot_node',
+                    plugin='ackibot::DiffDriveController',
+                    name='diff_drive_controller',
+                    parameters=[params_fn],
+                    extra_arguments=intra_process,
+                ),
+            ],
+        ),
+    ]
+
+
+def generate_launch_description():
+    ld = LaunchDescription([
+        OpaqueFunction(function = launch_setup)  # pokreće funkciju za setup nodova
+    ])
+
+    return ld
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+//Odometrija Ackermann auta: jedan enkoder pogona i ugao skretanja
+//prednjih tockova (bicycle model, referentna tacka je sredina zadnje
+//osovine).
+//
+//Stanje je poza (x, y, theta) i njena kovarijansa 3x3. Za jedan korak
+//je ds predjeni put (iz enkodera), a ugao skretanja se menja linearno od
+//prethodnog do trenutnog merenja. Po putu s je
+//  dx/ds = cos(theta), dy/ds = sin(theta), dtheta/ds = tan(delta)/wheelbase
+//i integrise se Runge-Kutta 4. redom, pa i duzi korak u krivini ne
+//odlazi u stranu kao Euler.
+//
+//Kovarijansa se propagira inkrementalno, P = F P F^T + G Q G^T, gde je F
+//jakobijan koraka po pozi, a G po ulazima (ds, delta). Sum puta raste sa
+//predjenim putem (distance_noise^2*|ds|), sum ugla je po koraku. Kada
+//ugao daje IMU (step_heading), umesto ugla skretanja ide sum ugla IMU-a.
+//Sve je ispisano za 3x3, bez alokacija, jer se zove za svaki joint_states.
+class Ackermann_Odometry {
+public:
+	struct Params {
+		double wheelbase;		//m, od zadnje do prednje osovine
+		double distance_noise;	//std. dev. puta po sqrt(m) puta
+		double steering_noise;	//rad, std. dev. ugla skretanja
+		double heading_noise;	//rad, std. dev. promene ugla iz IMU-a po koraku
+	};
+
+	typedef std::array<double, 3> Vec3;
+	typedef std::array<Vec3, 3> Mat3;
+
+	explicit Ackermann_Odometry(const Params& p)
+		: p(p)
+	{
+		reset();
+	}
+
+	void reset() {
+		pose = {0.0, 0.0, 0.0};
+		for(Vec3& r : cov){
+			r = {0.0, 0.0, 0.0};
+		}
+		last_ds = 0.0;
+		last_dtheta = 0.0;
+		last_var_ds = 0.0;
+		last_var_dtheta = 0.0;
+	}
+
+	//ds u m, uglovi skretanja prednjih tockova u rad (pozitivno levo)
+	//na pocetku i na kraju koraka
+	void step(double ds, double delta0, double delta1) {
+		const double k0 = curvature(delta0);
+		const double k1 = curvature(delta1);
+		const double km = curvature(0.5*(delta0 + delta1));
+
+		//RK4; promena ugla zavisi samo od s, pa je ona Simpson
+		const double th = pose[2];
+		const double th2 = th + 0.5*ds*k0;
+		const double th3 = th + 0.5*ds*km;
+		const double th4 = th + ds*km;
+		const double dx = ds/6.0*(std::cos(th) + 2.0*std::cos(th2) + 2.0*std::cos(th3) + std::cos(th4));
+		const double dy = ds/6.0*(std::sin(th) + 2.0*std::sin(th2) + 2.0*std::sin(th3) + std::sin(th4));
+		const double k = (k0 + 4.0*km + k1)/6.0; // srednja krivina
+		const double dth = ds*k;
+
+		//ulazi: put duz pravca u sredini koraka, ugao preko krivine
+		const double thm = th + 0.5*dth;
+		const double c = std::cos(thm);
+		const double s = std::sin(thm);
+		const double cd = std::cos(0.5*(delta0 + delta1));
+		const double dk = 1.0/(p.wheelbase*cd*cd); // d krivina / d delta
+		const double var_ds = p.distance_noise*p.distance_noise*std::abs(ds);
+		const double var_d = p.steering_noise*p.steering_noise;
+		const double g_th = ds*dk;
+		propagate(
+			dx, dy,
+			{c, s, k}, var_ds,
+			{-0.5*ds*s*g_th, 0.5*ds*c*g_th, g_th}, var_d
+		);
+		advance(dx, dy, dth);
+		last_ds = ds;
+		last_var_ds = var_ds;
+		last_var_dtheta = k*k*var_ds + g_th*g_th*var_d;
+	}
+
+	//ds u m, promena ugla iz IMU-a u rad
+	void step_heading(double ds, double dtheta) {
+		const double th = pose[2];
+		const double thm = th + 0.5*dtheta;
+		const double th1 = th + dtheta;
+		//RK4 sa ravnomernom promenom ugla duz puta
+		const double dx = ds/6.0*(std::cos(th) + 4.0*std::cos(thm) + std::cos(th1));
+		const double dy = ds/6.0*(std::sin(th) + 4.0*std::sin(thm) + std::sin(th1));
+
+		const double c = std::cos(thm);
+		const double s = std::sin(thm);
+		const double var_ds = p.distance_noise*p.distance_noise*std::abs(ds);
+		const double var_h = p.heading_noise*p.heading_noise;
+		propagate(
+			dx, dy,
+			{c, s, 0.0}, var_ds,
+			{-0.5*ds*s, 0.5*ds*c, 1.0}, var_h
+		);
+		advance(dx, dy, dtheta);
+		last_ds = ds;
+		last_var_ds = var_ds;
+		last_var_dtheta = var_h;
+	}
+
+	//x, y u m, theta u rad u (-pi, pi]
+	const Vec3& get_pose() const {
+		return pose;
+	}
+
+	const Mat3& covariance() const {
+		return cov;
+	}
+
+	//put i promena ugla poslednjeg koraka, za brzine
+	double delta_s() const {
+		return last_ds;
+	}
+
+	double delta_theta() const {
+		return last_dtheta;
+	}
+
+	//varijanse poslednjeg koraka, za kovarijansu brzina
+	double var_delta_s() const {
+		return last_var_ds;
+	}
+
+	double var_delta_theta() const {
+		return last_var_dtheta;
+	}
+
+private:
+	double curvature(double delta) const {
+		return std::tan(delta)/p.wheelbase;
+	}
+
+	//P = F P F^T + Q_a a a^T + Q_b b b^T, F = I + [0 0 -dy; 0 0 dx; 0 0 0]
+	void propagate(
+		double dx,
+		double dy,
+		const Vec3& a,
+		double q_a,
+		const Vec3& b,
+		double q_b
+	) {
+		const double fx = -dy;
+		const double fy = dx;
+		Mat3& P = cov;
+		const double p00 = P[0][0] + 2.0*fx*P[0][2] + fx*fx*P[2][2];
+		const double p01 = P[0][1] + fx*P[1][2] + fy*P[0][2] + fx*fy*P[2][2];
+		const double p02 = P[0][2] + fx*P[2][2];
+		const double p11 = P[1][1] + 2.0*fy*P[1][2] + fy*fy*P[2][2];
+		const double p12 = P[1][2] + fy*P[2][2];
+		const double p22 = P[2][2];
+
+		P[0][0] = p00 + q_a*a[0]*a[0] + q_b*b[0]*b[0];
+		P[0][1] = p01 + q_a*a[0]*a[1] + q_b*b[0]*b[1];
+		P[0][2] = p02 + q_a*a[0]*a[2] + q_b*b[0]*b[2];
+		P[1][1] = p11 + q_a*a[1]*a[1] + q_b*b[1]*b[1];
+		P[1][2] = p12 + q_a*a[1]*a[2] + q_b*b[1]*b[2];
+		P[2][2] = p22 + q_a*a[2]*a[2] + q_b*b[2]*b[2];
+		P[1][0] = P[0][1];
+		P[2][0] = P[0][2];
+		P[2][1] = P[1][2];
+	}
+
+	void advance(double dx, double dy, double dth) {
+		pose[0] += dx;
+		pose[1] += dy;
+		pose[2] = std::remainder(pose[2] + dth, 2.0*M_PI);
+		last_dtheta = dth;
+	}
+
+	Params p;
+	Vec3 pose;
+	Mat3 cov;
+	double last_ds;
+	double last_dtheta;
+	double last_var_ds;
+	double last_var_dtheta;
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+
+#include "type_shorts.h"
+
+//Preslikavanje vremena MCU-a (us, odmotano u 64 bita) na vreme hosta (ns).
+//
+//Svaki paket daje par (vreme MCU-a, vreme prijema na hostu). Prijem kasni
+//za nepoznato i promenljivo vreme (USB, jezgro, read nit), ali uvek >= 0.
+//Zato se iz poslednjih WINDOW parova:
+// - nagib (odnos brzina casovnika, drift kristala MCU-a) racuna linearnom
+//   regresijom, jer kasnjenje ne zavisi od vremena i ne menja nagib;
+//   druga regresija samo po donjoj cetvrtini ostataka prve odbacuje rep
+//   kasnjenja, pa je nagib mnogo manje rasut,
+// - pomeraj postavlja na najmanji ostatak, tj. na donju ivicu oblaka
+//   tacaka, gde je kasnjenje najmanje.
+//Dok parova ima manje od MIN_FIT, nagib je nominalan (1 us = 1000 ns).
+class Clock_Sync {
+public:
+	static constexpr size_t WINDOW = 256;	//~10 s na 25 paketa u sekundi
+	static constexpr size_t MIN_FIT = 16;
+	static constexpr int REFINE = 3;
+	//ceramicki rezonator je do 0.5 %, sve preko je greska merenja
+	static constexpr double MAX_DRIFT = 0.01;
+
+	Clock_Sync() {
+		reset();
+	}
+
+	void reset() {
+		n = 0;
+		pos = 0;
+		ref_mcu_us = 0;
+		ref_host_ns = 0;
+		slope = 1000.0;
+		offset = 0.0;
+	}
+
+	//jedan par; mcu_us mora da raste
+	void add(i64 mcu_us, i64 host_ns) {
+		mcu[pos] = mcu_us;
+		host[pos] = host_ns;
+		pos = (pos + 1) % WINDOW;
+		if(n < WINDOW){
+			n++;
+		}
+		fit(mcu_us, host_ns);
+	}
+
+	i64 to_host_ns(i64 mcu_us) const {
+		return ref_host_ns + i64(offset + slope*double(mcu_us - ref_mcu_us));
+	}
+
+	//ns hosta po us MCU-a, 1000 kada su casovnici iste brzine
+	double ns_per_us() const {
+		return slope;
+	}
+
+	//koliko MCU zuri u odnosu na host, u ppm
+	double drift_ppm() const {
+		return (1000.0/slope - 1.0)*1e6;
+	}
+
+	size_t size() const {
+		return n;
+	}
+
+private:
+	//racuna u odnosu na poslednji par, da double ne gubi preciznost
+	void fit(i64 ref_x, i64 ref_y) {
+		ref_mcu_us = ref_x;
+		ref_host_ns = ref_y;
+
+		slope = 1000.0;
+		if(n >= MIN_FIT){
+			double s;
+			if(regress(ref_x, ref_y, 1e300, s)){
+				//donja cetvrtina zavisi od nagiba, pa se par puta ponavlja
+				for(int k = 0; k < REFINE; k++){
+					for(size_t i = 0; i < n; i++){
+						scratch[i] = residual(i, ref_x, ref_y, s);
+					}
+					std::nth_element(scratch, scratch + n/4, scratch + n);
+					regress(ref_x, ref_y, scratch[n/4], s, s);
+				}
+				if(s > 1000.0*(1 - MAX_DRIFT) && s < 1000.0*(1 + MAX_DRIFT)){
+					slope = s;
+				}
+			}
+		}
+
+		offset = 0.0;
+		for(size_t i = 0; i < n; i++){
+			const double r = residual(i, ref_x, ref_y, slope);
+			if(i == 0 || r < offset){
+				offset = r;
+			}
+		}
+	}
+
+	double residual(size_t i, i64 ref_x, i64 ref_y, double s) const {
+		return double(host[i] - ref_y) - s*double(mcu[i] - ref_x);
+	}
+
+	//nagib kroz parove ciji je ostatak (za nagib s0) <= max_r; false ako ga nema
+	bool regress(i64 ref_x, i64 ref_y, double max_r, double& s, double s0 = 1000.0) const {
+		double sx = 0, sy = 0;
+		size_t m = 0;
+		for(size_t i = 0; i < n; i++){
+			if(residual(i, ref_x, ref_y, s0) <= max_r){
+				sx += double(mcu[i] - ref_x);
+				sy += double(host[i] - ref_y);
+				m++;
+			}
+		}
+		if(m < 2){
+			return false;
+		}
+		const double mx = sx/m;
+		const double my = sy/m;
+		double sxx = 0, sxy = 0;
+		for(size_t i = 0; i < n; i++){
+			if(residual(i, ref_x, ref_y, s0) <= max_r){
+				const double dx = double(mcu[i] - ref_x) - mx;
+				const double dy = double(host[i] - ref_y) - my;
+				sxx += dx*dx;
+				sxy += dx*dy;
+			}
+		}
+		if(sxx <= 0){
+			return false;
+		}
+		s = sxy/sxx;
+		return true;
+	}
+
+	i64 mcu[WINDOW];
+	i64 host[WINDOW];
+	double scratch[WINDOW];
+	size_t n;
+	size_t pos;
+
+	i64 ref_mcu_us;
+	i64 ref_host_ns;
+	double slope;	//ns/us
+	double offset;	//ns, u odnosu na ref_host_ns
+};
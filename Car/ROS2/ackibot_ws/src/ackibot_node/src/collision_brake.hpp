@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "type_shorts.h"
+
+//Procena rastojanja do prepreke ispred i brzine priblizavanja, iz
+//merenja ultrazvucnog senzora (samo nova merenja, vidi Range_Sequence).
+//
+//Alfa-beta filter: stanje je rastojanje i njegov izvod, merenje se
+//poredi sa predikcijom. Merenje dalje od predikcije za vise od gate_m je
+//odbacen izuzetak (odbijen echo, drugi senzor); tek max_rejects takvih
+//zaredom znaci da se scena zaista promenila, pa filter krece od tog
+//merenja. Merenja van [min_m, max_m] (0 je echo koji nije stigao) se
+//ignorisu, a max_rejects zaredom znaci da ispred nema prepreke, osim ako
+//je prepreka vec blize od hold_m: tu senzor cesto ne vidi echo, pa se
+//pamti poslednje rastojanje.
+//Sve je O(1), bez alokacija, jer radi u read niti za svako merenje.
+class Range_Filter {
+public:
+	struct Params {
+		double alpha;		//udeo reziduala u rastojanju
+		double beta;		//udeo reziduala/dt u brzini
+		double gate_m;		//najveci prihvaceni rezidual
+		double min_m;		//blize od ovoga senzor ne meri
+		double max_m;		//dalje od ovoga nema echo-a
+		u32 max_rejects;
+		double max_gap_s;	//duza pauza izmedju merenja brise stanje
+		double hold_m;		//blize od ovoga izostali echo ne brise prepreku
+	};
+
+	static Params default_params() {
+		return {0.5, 0.15, 0.25, 0.02, 4.0, 3, 0.5, 0.3};
+	}
+
+	explicit Range_Filter(const Params& params = default_params())
+		: p(params)
+	{
+		reset();
+	}
+
+	void reset() {
+		n = 0;
+		t_ns = 0;
+		r = 0.0;
+		r_dot = 0.0;
+		rejects = 0;
+		invalid = 0;
+		outliers = 0;
+	}
+
+	//jedno merenje u metrima; false ako je odbaceno
+	bool update(i64 t, double z) {
+		if(!(z > p.min_m && z < p.max_m)){
+			if(++invalid >= p.max_rejects && !(n != 0 && r < p.hold_m)){
+				n = 0;
+			}
+			return false;
+		}
+		invalid = 0;
+
+		const double dt = (t - t_ns)*1e-9;
+		if(n == 0 || dt <= 0.0 || dt > p.max_gap_s){
+			start(t, z);
+			return true;
+		}
+
+		const double r_pred = r + r_dot*dt;
+		const double res = z - r_pred;
+		if(std::abs(res) > p.gate_m){
+			outliers++;
+			if(++rejects >= p.max_rejects){
+				start(t, z);
+				return true;
+			}
+			return false;
+		}
+		rejects = 0;
+
+		t_ns = t;
+		if(n == 1){
+			//drugo merenje daje prvu procenu brzine
+			r_dot = (z - r)/dt;
+			r = z;
+		}else{
+			r = r_pred + p.alpha*res;
+			r_dot += p.beta/dt*res;
+		}
+		n++;
+		return true;
+	}
+
+	//ima li prepreke (bar jedno prihvaceno merenje od poslednjeg brisanja)
+	bool valid() const {
+		return n != 0;
+	}
+
+	//brzina je procenjena tek posle dva merenja
+	bool has_rate() const {
+		return n >= 2;
+	}
+
+	double range() const {
+		return r;
+	}
+
+	//m/s, negativno kad se prepreka priblizava
+	double rate() const {
+		return r_dot;
+	}
+
+	i64 time() const {
+		return t_ns;
+	}
+
+	u32 outliers;	//odbacena merenja, ukupno od reset()
+
+private:
+	void start(i64 t, double z) {
+		n = 1;
+		t_ns = t;
+		r = z;
+		r_dot = 0.0;
+		rejects = 0;
+	}
+
+	Params p;
+	u32 n;			//merenja od poslednjeg pocetka
+	i64 t_ns;		//vreme poslednjeg prihvacenog merenja
+	double r;		//m
+	double r_dot;	//m/s
+	u32 rejects;	//odbacenih zaredom
+	u32 invalid;	//van opsega zaredom
+};
+
+//Paketi telemetrije idu cesce nego merenja senzora (SENSOR_HZ prema
+//RANGE_PERIOD_MS u firmware-u), pa vise paketa zaredom nosi isto merenje.
+//Ponovljeno merenje bi Range_Filter video kao prepreku koja stoji i vukao
+//brzinu priblizavanja ka nuli. Firmware zato salje i broj zavrsenih
+//merenja, a filter dobija samo merenja ciji se broj promenio.
+class Range_Sequence {
+public:
+	Range_Sequence() {
+		reset();
+	}
+
+	//posle reseta firmware-a brojac krece ispocetka
+	void reset() {
+		started = false;
+		last = 0;
+	}
+
+	//true ako cnt pripada novom merenju
+	bool fresh(u16 cnt) {
+		const bool f = !started || cnt != last;
+		started = true;
+		last = cnt;
+		return f;
+	}
+
+private:
+	bool started;
+	u16 last;
+};
+
+//Kocenje po vremenu do sudara, umesto fiksnog praga rastojanja.
+//
+//Iz filtriranog rastojanja r i brzine priblizavanja c = -rate():
+// - raspoloziv put d = r - margin_m - c*latency_s, jer komanda stize do
+//   motora tek posle latency_s (paket, executor, firmware),
+// - najveca brzina napred sa koje se jos stigne zaustaviti usporenjem
+//   decel: sqrt(2*decel*d), 0 kad je d <= 0,
+// - vreme do sudara ttc = (r - margin_m)/c; ispod ttc_stop_s je limit 0
+//   bez obzira na profil (prepreka se brzo priblizava sama).
+//Rezultat je ogranicenje brzine napred u m/s; unazad se uvek moze.
+class Collision_Brake {
+public:
+	struct Params {
+		double decel;		//m/s^2, profil usporenja
+		double margin_m;	//rastojanje na kom se staje
+		double latency_s;	//kasnjenje od merenja do komande na motoru
+		double ttc_stop_s;	//ispod ovoga odmah stop
+	};
+
+	static Params default_params() {
+		return {1.5, 0.2, 0.1, 0.5};
+	}
+
+	static constexpr double NONE = std::numeric_limits<double>::infinity();
+
+	explicit Collision_Brake(const Params& params = default_params())
+		: p(params),
+		limit(NONE),
+		ttc_s(NONE)
+	{
+	}
+
+	void update(const Range_Filter& f) {
+		limit = NONE;
+		ttc_s = NONE;
+		if(!f.valid()){
+			return;
+		}
+		const double c = f.has_rate() && f.rate() < 0.0 ? -f.rate() : 0.0;
+		const double d = f.range() - p.margin_m - c*p.latency_s;
+		limit = d > 0.0 ? std::sqrt(2.0*p.decel*d) : 0.0;
+		if(c > 0.0){
+			ttc_s = std::max(0.0, f.range() - p.margin_m)/c;
+			if(ttc_s < p.ttc_stop_s){
+				limit = 0.0;
+			}
+		}
+	}
+
+	//najveca dozvoljena brzina napred, m/s; NONE kad nema prepreke
+	double speed_limit() const {
+		return limit;
+	}
+
+	//s, NONE kad se prepreka ne priblizava
+	double ttc() const {
+		return ttc_s;
+	}
+
+private:
+	Params p;
+	double limit;
+	double ttc_s;
+};
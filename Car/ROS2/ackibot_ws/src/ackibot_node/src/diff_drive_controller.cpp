@@ -14,6 +14,21 @@ using ackibot::DiffDriveController;
 //poziva konstruktor Node klase, omogucava intra-process komunikaciju
 DiffDriveController::DiffDriveController(const float wheel_seperation, const float wheel_radius)
 : Node("diff_drive_controller", rclcpp::NodeOptions().use_intra_process_comms(true))
+{
+  init(wheel_seperation, wheel_radius);
+}
+
+//kao komponenta nema pristup FW_Node-u, pa iste vrednosti dobija kroz parametre
+DiffDriveController::DiffDriveController(const rclcpp::NodeOptions & options)
+: Node("diff_drive_controller", options)
+{
+  const float wheel_seperation = this->declare_parameter<float>("wheels.separation", 0.160);
+  const float wheel_radius = this->declare_parameter<float>("wheels.radius", 0.033);
+
+  init(wheel_seperation, wheel_radius);
+}
+
+void DiffDriveController::init(const float wheel_seperation, const float wheel_radius)
 {
   //pametni pokazivac na Node objekat
   nh_ = std::shared_ptr<::rclcpp::Node>(this, [](::rclcpp::Node *) {});
@@ -27,3 +42,6 @@ DiffDriveController::DiffDriveController(const float wheel_seperation, const flo
   RCLCPP_INFO(this->get_logger(), "Run!");
 }
 
+#include <rclcpp_components/register_node_macro.hpp>
+
+RCLCPP_COMPONENTS_REGISTER_NODE(ackibot::DiffDriveController)
@@ -14,9 +14,13 @@ class DiffDriveController : public rclcpp::Node
 {
 public:
   explicit DiffDriveController(const float wheel_seperation, const float wheel_radius);
+  //konstruktor komponente, dimenzije tockova se citaju iz parametara wheels.*
+  explicit DiffDriveController(const rclcpp::NodeOptions & options);
   virtual ~DiffDriveController() {}
 
 private:
+  void init(const float wheel_seperation, const float wheel_radius);
+
   std::shared_ptr<rclcpp::Node> nh_;
   std::unique_ptr<Odometry> odometry_;
 };
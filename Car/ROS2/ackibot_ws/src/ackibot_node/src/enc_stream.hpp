@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "clock_sync.hpp"
+#include "fw_pkgs.hpp"
+
+//Jedan uzorak enkodera sa vremenom na hostu.
+struct enc_sample_t {
+	i64 t_ns;
+	i32 enc;
+};
+
+//Rekonstrukcija toka uzoraka enkodera iz v2 paketa (pkg_s2m_v2_t).
+//
+//Redni broj: rupa u seq su izgubljene serije (lost), isti seq je duplikat
+//koji se odbacuje, a seq unazad znaci da je firmware resetovan, pa tok
+//krece ispocetka (restarts). Serijski port ne menja redosled paketa.
+//
+//Vreme: t_us MCU-a se odmotava u 64 bita (micros() se preliva na ~71 min)
+//i na vreme hosta preslikava preko Clock_Sync (drift i najmanje kasnjenje).
+//Uzorci u paketu su razmaknuti sample_period_us, poslednji je uzet u t_us.
+class Enc_Stream {
+public:
+	Enc_Stream() {
+		reset();
+	}
+
+	void reset() {
+		restart();
+		last_t_ns = 0;
+		pkgs = 0;
+		lost = 0;
+		duplicates = 0;
+		restarts = 0;
+	}
+
+	//host_ns je vreme prijema paketa na hostu.
+	//Upisuje uzorke u out (najstariji prvi) i vraca njihov broj, 0 za duplikat.
+	size_t push(
+		const pkg_s2m_v2_t& p,
+		i64 host_ns,
+		enc_sample_t (&out)[ENC_SAMPLES]
+	) {
+		if(started){
+			const u16 d = p.payload.seq - last_seq;
+			if(d == 0){
+				duplicates++;
+				return 0;
+			}
+			if(d >= 0x8000){
+				restart();
+				restarts++;
+			}else{
+				lost += d - 1;
+			}
+		}
+
+		if(started){
+			mcu_us += u32(p.payload.t_us - last_t_us);
+		}else{
+			mcu_us = p.payload.t_us;
+			started = true;
+		}
+		last_seq = p.payload.seq;
+		last_t_us = p.payload.t_us;
+		pkgs++;
+
+		sync.add(mcu_us, host_ns);
+
+		for(size_t i = 0; i < ENC_SAMPLES; i++){
+			const i64 age_us = i64(ENC_SAMPLES - 1 - i)*p.payload.sample_period_us;
+			i64 t_ns = sync.to_host_ns(mcu_us - age_us);
+			//novo najmanje kasnjenje pomera vreme unazad, a tok mora da raste
+			if(t_ns <= last_t_ns){
+				t_ns = last_t_ns + 1;
+			}
+			last_t_ns = t_ns;
+			out[i].t_ns = t_ns;
+			out[i].enc = p.payload.enc[i];
+		}
+		return ENC_SAMPLES;
+	}
+
+	//preslikavanje vremena MCU-a na vreme hosta
+	const Clock_Sync& clock() const {
+		return sync;
+	}
+
+	//statistika od poslednjeg reset()
+	u32 pkgs;		//prihvaceni paketi
+	u32 lost;		//izgubljene serije (rupe u seq)
+	u32 duplicates;	//odbaceni paketi sa istim seq
+	u32 restarts;	//reseti firmware-a (seq unazad)
+
+private:
+	//novi pocetak toka, bez brisanja statistike
+	void restart() {
+		started = false;
+		last_seq = 0;
+		last_t_us = 0;
+		mcu_us = 0;
+		sync.reset();
+	}
+
+	bool started;
+	u16 last_seq;
+	u32 last_t_us;
+	i64 mcu_us;		//odmotano vreme MCU-a
+	i64 last_t_ns;	//vreme poslednjeg izdatog uzorka
+	Clock_Sync sync;
+};
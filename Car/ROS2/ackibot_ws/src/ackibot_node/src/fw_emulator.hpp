@@ -0,0 +1,464 @@
+#pragma once
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fw_pkgs.hpp"
+
+//Emulator firmware-a (Arduino_Motor_Controller) na pseudo-terminalu.
+//
+//Otvara par master/slave; FW_Node se pokrece sa -i port() umesto porta
+//kontrolera (/dev/ttyUSB0). Emulator prima pkg_m2s_t i pkg_hello_t i
+//salje telemetriju kao firmware: posle reseta v1 (pkg_s2m_t) na SENSOR_HZ,
+//a posle hello v2 (pkg_s2m_v2_t) u serijama od ENC_SAMPLES uzoraka. speed_i i
+//steering_angle_i su poslednja primljena komanda (potvrda), a enkoder
+//broji srazmerno brzini, bez rampe, kao set_target_speed() u firmware-u.
+//
+//Veza se kvari po Config-u, u oba smera: kasnjenje (uz slucajni jitter,
+//redosled bajtova ostaje isti), gubitak pojedinacnih bajtova i prekid
+//(blackout). Paketi ka hostu se jos mogu i ostetiti (jedan bit payload-a),
+//pa ih host odbacuje na CRC-u.
+//
+//Sve radi jedna nit; ostale metode su bezbedne iz bilo koje niti.
+class FW_Emulator {
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef Clock::time_point Time_Point;
+
+	//isto kao u firmware-u
+	static constexpr u32 SENSOR_HZ = 25;
+	static constexpr u32 SAMPLE_PERIOD_US = 10240; // ENC_SAMPLE_PERIOD_US
+	static constexpr u32 RANGE_PERIOD_MS = 60;
+
+	struct Config {
+		double latency_ms = 0.0;	//kasnjenje svakog bajta, u oba smera
+		double jitter_ms = 0.0;		//dodatno slucajno kasnjenje [0, jitter_ms)
+		double byte_drop = 0.0;		//verovatnoca gubitka bajta, u oba smera
+		double pkg_corrupt = 0.0;	//verovatnoca ostecenog paketa ka hostu
+		u8 max_version = PKG_PROTOCOL_VERSION; //1 je stari firmware bez hello
+		double enc_ticks_per_s = 2000.0; //enkoder pri speed_i = MODULUS - 1
+		double drift_ppm = 0.0;		//koliko casovnik MCU-a zuri
+		float distance_cm = 100.0f;	//prepreka ispred ultrazvucnog senzora
+		u32 seed = 1;
+	};
+
+	struct Stats {
+		u32 cmds;			//ispravni pkg_m2s_t
+		u32 hellos;			//ispravni pkg_hello_t
+		u32 rx_crc_errors;	//odbaceni paketi od hosta
+		u32 tx_pkgs;		//poslati paketi telemetrije
+		u32 tx_corrupted;	//od toga namerno osteceni
+		u32 dropped_bytes;	//izgubljeni bajtovi, oba smera
+		u32 overflow_bytes;	//host ne cita, pun bafer pseudo-terminala
+		u8 proto_version;
+		i16 speed_i;
+		i16 steering_angle_i;
+		i32 enc;
+		Time_Point speed_changed;	//kada je speed_i poslednji put promenjen
+		i64 cpu_ns;					//procesorsko vreme niti emulatora
+	};
+
+	FW_Emulator()
+		: FW_Emulator(Config())
+	{
+	}
+
+	explicit FW_Emulator(const Config& c)
+		: cfg(c),
+		rng(c.seed),
+		master_fd(-1),
+		slave_fd(-1),
+		running(false)
+	{
+		st = Stats();
+		reset();
+	}
+
+	~FW_Emulator() {
+		close();
+	}
+
+	//otvara pseudo-terminal i pokrece firmware; false ako ne uspe
+	bool open() {
+		master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+		if(master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0){
+			close();
+			return false;
+		}
+		char name[128];
+		if(ptsname_r(master_fd, name, sizeof(name)) != 0){
+			close();
+			return false;
+		}
+		slave_path = name;
+
+		//slave ostaje otvoren i ovde, pa master ne dobija EIO izmedju dva
+		//otvaranja od strane hosta; raw, da linijska disciplina ne menja bajtove
+		slave_fd = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+		termios t;
+		if(slave_fd < 0 || tcgetattr(slave_fd, &t) != 0){
+			close();
+			return false;
+		}
+		cfmakeraw(&t);
+		tcsetattr(slave_fd, TCSANOW, &t);
+		fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+
+		running = true;
+		thread = std::thread(&FW_Emulator::loop, this);
+		return true;
+	}
+
+	void close() {
+		running = false;
+		if(thread.joinable()){
+			thread.join();
+		}
+		if(slave_fd >= 0){
+			::close(slave_fd);
+			slave_fd = -1;
+		}
+		if(master_fd >= 0){
+			::close(master_fd);
+			master_fd = -1;
+		}
+	}
+
+	//putanja za FW_Node -i
+	const std::string& port() const {
+		return slave_path;
+	}
+
+	Stats stats() const {
+		std::lock_guard<std::mutex> lock(m);
+		return st;
+	}
+
+	//reset MCU-a: ponovo v1, stoji, seq, enkoder i micros() od nule
+	void reset() {
+		std::lock_guard<std::mutex> lock(m);
+		const Time_Point now = Clock::now();
+		st.proto_version = 1;
+		st.speed_i = 0;
+		st.steering_angle_i = 90;
+		st.enc = 0;
+		enc_pos = 0.0;
+		mcu_start = now;
+		next_sample = now + sample_period();
+		next_v1 = now + std::chrono::milliseconds(1000/SENSOR_HZ);
+		enc_t = now;
+		batch_idx = 0;
+		batch_seq = 0;
+	}
+
+	//veza u prekidu narednih d, svi bajtovi se gube
+	void blackout(Clock::duration d) {
+		std::lock_guard<std::mutex> lock(m);
+		blackout_until = Clock::now() + d;
+	}
+
+	void set_distance_cm(float d) {
+		std::lock_guard<std::mutex> lock(m);
+		cfg.distance_cm = d;
+	}
+
+private:
+	struct Chunk {
+		Time_Point t;	//kada bajtovi stizu na drugu stranu
+		std::vector<u8> b;
+	};
+
+	Clock::duration sample_period() const {
+		return std::chrono::nanoseconds(
+			i64(std::llround(SAMPLE_PERIOD_US*1e3/(1.0 + cfg.drift_ppm*1e-6)))
+		);
+	}
+
+	//micros() MCU-a u trenutku t
+	u32 mcu_us(Time_Point t) const {
+		const double ns = std::chrono::duration<double, std::nano>(t - mcu_start).count();
+		return u32(i64(ns*(1.0 + cfg.drift_ppm*1e-6)/1e3));
+	}
+
+	void loop() {
+		std::vector<u8> rx;
+		while(running){
+			{
+				std::lock_guard<std::mutex> lock(m);
+				const Time_Point now = Clock::now();
+				receive(now);
+				deliver(to_fw, now, [&](const std::vector<u8>& b) {
+					rx.insert(rx.end(), b.begin(), b.end());
+				});
+				parse(rx, now);
+				firmware(now);
+				deliver(to_host, now, [&](const std::vector<u8>& b) {
+					transmit(b);
+				});
+				timespec cpu;
+				clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+				st.cpu_ns = i64(cpu.tv_sec)*1000000000 + cpu.tv_nsec;
+			}
+			wait();
+		}
+	}
+
+	//spava do sledeceg dogadjaja ili bajta od hosta, najvise 10 ms zbog close()
+	void wait() {
+		Time_Point until;
+		{
+			std::lock_guard<std::mutex> lock(m);
+			until = std::min(next_sample, next_v1);
+			if(!to_fw.empty()){
+				until = std::min(until, to_fw.front().t);
+			}
+			if(!to_host.empty()){
+				until = std::min(until, to_host.front().t);
+			}
+		}
+		const i64 ns = std::clamp<i64>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(until - Clock::now()).count(),
+			0,
+			10000000
+		);
+		const timespec ts = {time_t(ns/1000000000), long(ns%1000000000)};
+		pollfd p = {master_fd, POLLIN, 0};
+		ppoll(&p, 1, &ts, nullptr);
+	}
+
+	//bajtovi od hosta, na put ka firmware-u
+	void receive(Time_Point now) {
+		u8 buf[256];
+		ssize_t r;
+		while((r = read(master_fd, buf, sizeof(buf))) > 0){
+			send(to_fw, buf, r, now);
+		}
+	}
+
+	//kvari bajtove po Config-u i stavlja ih u red sa vremenom dolaska
+	void send(std::deque<Chunk>& q, const u8* b, size_t n, Time_Point now) {
+		Chunk c;
+		c.b.reserve(n);
+		for(size_t i = 0; i < n; i++){
+			if(now < blackout_until || chance(cfg.byte_drop)){
+				st.dropped_bytes++;
+			}else{
+				c.b.push_back(b[i]);
+			}
+		}
+		if(c.b.empty()){
+			return;
+		}
+		double ms = cfg.latency_ms;
+		if(cfg.jitter_ms > 0){
+			ms += std::uniform_real_distribution<double>(0, cfg.jitter_ms)(rng);
+		}
+		c.t = now + std::chrono::nanoseconds(i64(ms*1e6));
+		//serijska veza ne menja redosled
+		if(!q.empty() && c.t < q.back().t){
+			c.t = q.back().t;
+		}
+		q.push_back(std::move(c));
+	}
+
+	template<typename F>
+	void deliver(std::deque<Chunk>& q, Time_Point now, F&& f) {
+		while(!q.empty() && q.front().t <= now){
+			f(q.front().b);
+			q.pop_front();
+		}
+	}
+
+	void transmit(const std::vector<u8>& b) {
+		size_t done = 0;
+		while(done < b.size()){
+			const ssize_t w = write(master_fd, b.data() + done, b.size() - done);
+			if(w <= 0){
+				st.overflow_bytes += b.size() - done;
+				return;
+			}
+			done += w;
+		}
+	}
+
+	//kao poll_pkg(): trazi magic bajt po bajt, a paket sa pogresnim
+	//CRC-om odbacuje ceo
+	void parse(std::vector<u8>& rx, Time_Point now) {
+		size_t pos = 0;
+		while(rx.size() - pos >= sizeof(pkg_magic_t)){
+			pkg_magic_t magic;
+			memcpy(&magic, rx.data() + pos, sizeof(magic));
+			const bool hello = magic == PKG_HELLO_MAGIC && cfg.max_version >= 2;
+			size_t len;
+			if(magic == PKG_MAGIC){
+				len = sizeof(pkg_m2s_t);
+			}else if(hello){
+				len = sizeof(pkg_hello_t);
+			}else{
+				pos++;
+				continue;
+			}
+			if(rx.size() - pos < len){
+				break;
+			}
+			if(hello){
+				pkg_hello_t h;
+				memcpy(&h, rx.data() + pos, len);
+				if(CRC16().add(h.payload).get_crc() == h.crc){
+					st.hellos++;
+					st.proto_version = std::clamp<u8>(h.payload.version, 1, cfg.max_version);
+				}else{
+					st.rx_crc_errors++;
+				}
+			}else{
+				pkg_m2s_t p;
+				memcpy(&p, rx.data() + pos, len);
+				if(CRC16().add(p.payload).get_crc() == p.crc){
+					st.cmds++;
+					advance(now);
+					if(p.payload.speed != st.speed_i){
+						st.speed_changed = now;
+					}
+					st.speed_i = p.payload.speed;
+					st.steering_angle_i = p.payload.steering_angle;
+				}else{
+					st.rx_crc_errors++;
+				}
+			}
+			pos += len;
+		}
+		rx.erase(rx.begin(), rx.begin() + pos);
+	}
+
+	//enkoder do trenutka t, trenutnom brzinom
+	void advance(Time_Point t) {
+		if(t <= enc_t){
+			return;
+		}
+		const double s = std::chrono::duration<double>(t - enc_t).count();
+		enc_pos += st.speed_i*cfg.enc_ticks_per_s/(MODULUS - 1)*s;
+		enc_t = t;
+		st.enc = i32(std::floor(enc_pos));
+	}
+
+	//ISR(TIMER0_COMPA_vect) i loop() firmware-a
+	void firmware(Time_Point now) {
+		while(next_sample <= now){
+			advance(next_sample);
+			batch.payload.enc[batch_idx] = st.enc;
+			if(++batch_idx == ENC_SAMPLES){
+				batch_idx = 0;
+				batch.payload.t_us = mcu_us(next_sample);
+				batch.payload.seq = batch_seq++;
+				if(st.proto_version >= 2){
+					send_v2(next_sample);
+				}
+			}
+			next_sample += sample_period();
+		}
+		while(next_v1 <= now){
+			if(st.proto_version < 2){
+				advance(next_v1);
+				send_v1(next_v1);
+			}
+			next_v1 += std::chrono::milliseconds(1000/SENSOR_HZ);
+		}
+	}
+
+	void send_v1(Time_Point t) {
+		pkg_s2m_t p;
+		p.magic = PKG_MAGIC;
+		p.payload.enc = st.enc;
+		p.payload.speed_i = st.speed_i;
+		p.payload.speed_o = st.speed_i;
+		p.payload.steering_angle_i = st.steering_angle_i;
+		p.payload.steering_angle_o = st.steering_angle_i;
+		p.payload.ultrasound_pulse = pulse_us();
+		p.crc = CRC16().add(p.payload).get_crc();
+		send_pkg(reinterpret_cast<u8*>(&p), sizeof(p), t);
+	}
+
+	void send_v2(Time_Point t) {
+		pkg_s2m_v2_t& p = batch;
+		p.magic = PKG_V2_MAGIC;
+		p.payload.version = st.proto_version;
+		p.payload.sample_period_us = SAMPLE_PERIOD_US;
+		p.payload.speed_i = st.speed_i;
+		p.payload.speed_o = st.speed_i;
+		p.payload.steering_angle_i = st.steering_angle_i;
+		p.payload.steering_angle_o = st.steering_angle_i;
+		p.payload.ultrasound_pulse = pulse_us();
+		p.payload.ultrasound_cnt = range_cnt(t);
+		p.crc = CRC16().add(p.payload).get_crc();
+		pkg_s2m_v2_t out = p;
+		send_pkg(reinterpret_cast<u8*>(&out), sizeof(out), t);
+	}
+
+	//paket ka hostu; ostecuje se jedan bit posle magic-a, pre CRC-a
+	void send_pkg(u8* b, size_t n, Time_Point t) {
+		st.tx_pkgs++;
+		if(chance(cfg.pkg_corrupt)){
+			st.tx_corrupted++;
+			const size_t i = std::uniform_int_distribution<size_t>(
+				sizeof(pkg_magic_t),
+				n - sizeof(pkg_crc_t) - 1
+			)(rng);
+			b[i] ^= u8(1 << std::uniform_int_distribution<int>(0, 7)(rng));
+		}
+		send(to_host, b, n, t);
+	}
+
+	u32 pulse_us() const {
+		return u32(cfg.distance_cm*2.0f/0.0343f);
+	}
+
+	//senzor meri na RANGE_PERIOD_MS od reseta, nezavisno od paketa
+	u16 range_cnt(Time_Point t) const {
+		return u16(mcu_us(t)/(RANGE_PERIOD_MS*1000));
+	}
+
+	bool chance(double p) {
+		return p > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < p;
+	}
+
+	Config cfg;
+	std::mt19937 rng;
+
+	int master_fd;
+	int slave_fd;
+	std::string slave_path;
+	std::atomic<bool> running;
+	std::thread thread;
+
+	mutable std::mutex m; // stiti sve ispod
+	Stats st;
+	std::deque<Chunk> to_fw;
+	std::deque<Chunk> to_host;
+	Time_Point blackout_until;
+
+	Time_Point mcu_start;
+	Time_Point next_sample;
+	Time_Point next_v1;
+	Time_Point enc_t;
+	double enc_pos = 0.0;
+	pkg_s2m_v2_t batch = {};
+	size_t batch_idx;
+	u16 batch_seq;
+};
@@ -0,0 +1,85 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <rcutils/cmdline_parser.h>
+
+#include "fw_emulator.hpp"
+
+//emulator firmware-a na pseudo-terminalu, za fw_node bez hardvera:
+//  fw_emulator -l 5 -d 0.001
+//  fw_node -i <ispisani port>
+
+static std::atomic<bool> running(true);
+
+static void on_signal(int) {
+	running = false;
+}
+
+void help_print()
+{
+	printf("Firmware emulator on a pseudo-terminal : \n");
+	printf("fw_emulator [-l ms] [-j ms] [-d p] [-c p] [-v version] [-r cm] [-h]\n");
+	printf("options:\n");
+	printf("-h : Print this help function.\n");
+	printf("-l ms: Latency of every byte, both directions.\n");
+	printf("-j ms: Random extra latency, up to ms.\n");
+	printf("-d p: Probability of a dropped byte, both directions.\n");
+	printf("-c p: Probability of a corrupted package to the host.\n");
+	printf("-v version: Newest protocol version the firmware knows (1 ignores hello).\n");
+	printf("-r cm: Distance reported by the ultrasound sensor.\n");
+}
+
+//vrednost opcije kao broj, ili def ako je nema
+static double option(char** argv, int argc, const char* name, double def)
+{
+	const char* v = rcutils_cli_get_option(argv, argv + argc, name);
+	return v ? atof(v) : def;
+}
+
+int main(int argc, char * argv[])
+{
+	setvbuf(stdout, NULL, _IONBF, BUFSIZ);
+
+	if (rcutils_cli_option_exist(argv, argv + argc, "-h")) {
+		help_print();
+		return 0;
+	}
+
+	FW_Emulator::Config cfg;
+	cfg.latency_ms = option(argv, argc, "-l", cfg.latency_ms);
+	cfg.jitter_ms = option(argv, argc, "-j", cfg.jitter_ms);
+	cfg.byte_drop = option(argv, argc, "-d", cfg.byte_drop);
+	cfg.pkg_corrupt = option(argv, argc, "-c", cfg.pkg_corrupt);
+	cfg.max_version = u8(option(argv, argc, "-v", cfg.max_version));
+	cfg.distance_cm = float(option(argv, argc, "-r", cfg.distance_cm));
+
+	FW_Emulator emu(cfg);
+	if (!emu.open()) {
+		fprintf(stderr, "Cannot open pseudo-terminal!\n");
+		return 1;
+	}
+	printf("Firmware emulator at %s\n", emu.port().c_str());
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	//jednom u sekundi ispisuje sta se desavalo na vezi
+	while (running) {
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		const FW_Emulator::Stats s = emu.stats();
+		printf(
+			"v%u speed_i %d steering %d enc %d | cmds %u hellos %u rx_crc %u | "
+			"tx %u corrupted %u dropped_bytes %u overflow %u\n",
+			s.proto_version, s.speed_i, s.steering_angle_i, s.enc,
+			s.cmds, s.hellos, s.rx_crc_errors,
+			s.tx_pkgs, s.tx_corrupted, s.dropped_bytes, s.overflow_bytes
+		);
+	}
+
+	return 0;
+}
@@ -1,8 +1,14 @@
 #include "fw_node.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include "sabertooth.h"
 #include <rcpputils/asserts.hpp>
 
@@ -15,7 +21,12 @@ using namespace std::chrono_literals;
 
 
 #define REPEATER_HZ 25
+//koliko cesto executor objavljuje ono sto je read nit procitala
+#define PUBLISH_HZ 100
 #define WATCHDOG_TIMEOUT_PERIODS 3
+//stari firmware ne zna za hello, pa se posle ovoliko pokusaja ostaje na v1
+#define HELLO_TRIES 5
+#define LATENCY_REPORT_PERIOD 5s
 
 
 #define L_WHEEL 0
@@ -29,25 +40,71 @@ using namespace std::chrono_literals;
 
 
 FW_Node::FW_Node(const std::string & usb_port)
+	: FW_Node(
+		rclcpp::NodeOptions().use_intra_process_comms(true),
+		usb_port
+	)
+{
+}
+
+FW_Node::FW_Node(
+	const rclcpp::NodeOptions & options,
+	const std::string & usb_port
+)
 	: Node(
 		"fw_node",
-		rclcpp::NodeOptions().use_intra_process_comms(true)
+		options
 	),
 	//inicijalizacija clanova klase
-	watchdog_cnt(0)
+	watchdog_cnt(0),
+	fw_version(0),
+	hello__cnt(0),
+	hello__tick(0),
+	read__running(true),
+	read__wake_fd(-1),
+	rd_crc_errors(0),
+	rd_lost(0),
+	rd_samples_dropped(0),
+	pub_range_seq(0),
+	pub_samples_dropped(0)
 {
 	RCLCPP_INFO(get_logger(), "Init FW_Node Node Main");
 
+	//kada se ucitava kao komponenta, port dolazi iz parametra
+	std::string port = this->declare_parameter<std::string>(
+		"usb_port",
+		"/dev/ttyUSB0"
+	);
+	if(!usb_port.empty()){
+		port = usb_port;
+	}
+	RCLCPP_INFO(
+		this->get_logger(),
+		"Serial port %s, intra-process %s",
+		port.c_str(),
+		options.use_intra_process_comms() ? "on" : "off"
+	);
+
+	cmd_vel__latency = {0.0, 0.0, 0, this->now()};
+
 	prev_enc = 0;
 	//prev_enc[1] = 0;
 
-	//priprema bafera za slanje i prijem paketa
+	//priprema bafera za slanje paketa
 	wr_buf.resize(sizeof(pkg_m2s_t));
-	rd_buf.resize(sizeof(pkg_s2m_t)-sizeof(pkg_magic_t));
 
 	//debug logovanje velicina paketa
 DEBUG(sizeof(pkg_m2s_t));
 DEBUG(sizeof(pkg_s2m_t));
+DEBUG(sizeof(pkg_s2m_v2_t));
+
+	//verzija telemetrije koja se trazi od firmware-a, 1 zadrzava stari protokol
+	protocol_version = this->declare_parameter<int>(
+		"protocol_version",
+		PKG_PROTOCOL_VERSION
+	);
+	protocol_version = std::clamp(protocol_version, 1, PKG_PROTOCOL_VERSION);
+	DEBUG(protocol_version);
 
 	//kreira publisher koji objavljuje poruke tipa sensor_msgs/JointState na topic joint_states
 	joint_state__pub = this->create_publisher<sensor_msgs::msg::JointState>(
@@ -87,16 +144,45 @@ DEBUG(sizeof(pkg_s2m_t));
 	this->get_parameter_or<float>("wheels.separation", wheels_.separation, 0.160);
 	this->get_parameter_or<float>("wheels.radius", wheels_.radius, 0.033);
 
+	//regulator brzine: cmd_vel linear.x u m/s, povratna sprega sa enkodera
+	max_speed = this->declare_parameter<double>("speed_control.max_speed", 0.9);
+	if(this->declare_parameter<bool>("speed_control.enabled", false)){
+		Speed_Controller::Params sc;
+		sc.kp = this->declare_parameter<double>("speed_control.kp", 2500.0);
+		sc.ki = this->declare_parameter<double>("speed_control.ki", 15000.0);
+		sc.max_speed = max_speed;
+		sc.tau_s = this->declare_parameter<double>("speed_control.filter_tau", 0.03);
+		speed_ctrl = std::make_unique<Speed_Controller>(
+			sc,
+			tick_to_rad*wheels_.radius
+		);
+		RCLCPP_INFO(
+			this->get_logger(),
+			"Closed-loop speed control: kp %.1f ki %.1f max_speed %.2f m/s",
+			sc.kp,
+			sc.ki,
+			sc.max_speed
+		);
+	}
+
+	//kocenje pred preprekom po vremenu do sudara
+	Collision_Brake::Params cb;
+	cb.decel = this->declare_parameter<double>("collision.decel", 1.5);
+	cb.margin_m = this->declare_parameter<double>("collision.margin", 0.2);
+	cb.latency_s = this->declare_parameter<double>("collision.latency", 0.1);
+	cb.ttc_stop_s = this->declare_parameter<double>("collision.ttc_stop", 0.5);
+	rd_brake = Collision_Brake(cb);
+
 
 	//pokusava da ostvari serijsku komunikaciju sa sabertoothom preko USB porta
 	try{
-		motor_ctrl_sensor_hub_serial.Open(usb_port);
+		motor_ctrl_sensor_hub_serial.Open(port);
 		motor_ctrl_sensor_hub_serial.SetBaudRate(LibSerial::BaudRate::BAUD_115200);
 		motor_ctrl_sensor_hub_serial.SetStopBits(LibSerial::StopBits::STOP_BITS_1);
 	}catch(...){
 		RCLCPP_ERROR_STREAM(
 			this->get_logger(),
-			"Cannot open Sabertooth at \"" << usb_port << "\"!"
+			"Cannot open Sabertooth at \"" << port << "\"!"
 		);
 		RCLCPP_INFO_STREAM(
 			this->get_logger(),
@@ -119,8 +205,14 @@ DEBUG(sizeof(pkg_s2m_t));
 		std::bind(&FW_Node::repeater__cb, this)
 	);
 
+	publish__tmr = this->create_wall_timer(
+		std::chrono::milliseconds(1000/PUBLISH_HZ),
+		std::bind(&FW_Node::publish__cb, this)
+	);
+
 
-	//pokrece nit koja stalno cita pakete sa subskrajbera
+	//pokrece nit koja cita pakete sa serijskog porta
+	read__wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
 	read__thread = std::thread(
 		&FW_Node::read__loop,
 		this
@@ -130,6 +222,23 @@ DEBUG(sizeof(pkg_s2m_t));
 	RCLCPP_INFO(this->get_logger(), "Run!");
 }
 
+FW_Node::~FW_Node() {
+	//zaustavlja nit za citanje pre unistavanja cvora (npr. unload komponente)
+	read__running = false;
+	if(read__wake_fd >= 0){
+		const uint64_t one = 1;
+		if(write(read__wake_fd, &one, sizeof(one)) < 0){
+			RCLCPP_WARN(this->get_logger(), "Cannot wake read thread!");
+		}
+	}
+	if(read__thread.joinable()){
+		read__thread.join();
+	}
+	if(read__wake_fd >= 0){
+		close(read__wake_fd);
+	}
+}
+
 FW_Node::Wheels * FW_Node::get_wheels() {
 	return &wheels_;
 }
@@ -144,6 +253,9 @@ void FW_Node::watchdog_dec() {
 		watchdog_cnt--;
 		if(watchdog_cnt == 0){
 			RCLCPP_WARN_STREAM(this->get_logger(), "Watchdog stop motors!");
+			if(speed_ctrl){
+				speed_ctrl->set_target(0.0);
+			}
 		}
 	}
 }
@@ -158,9 +270,11 @@ void FW_Node::watchdog_apply() {
 
 
 //poziva se kada stigne nova poruka na cmd_vel topik
-void FW_Node::cmd_vel__cb(const geometry_msgs::msg::TwistStamped::SharedPtr msg) {
+void FW_Node::cmd_vel__cb(const geometry_msgs::msg::TwistStamped::ConstSharedPtr msg) {
+	cmd_vel__latency_add(msg->header.stamp);
+
 	//pravi referencu na deo poruke koji sadrzi linearne i ugaone brzine
-	geometry_msgs::msg::Twist& cmd = msg->twist;
+	const geometry_msgs::msg::Twist& cmd = msg->twist;
 
 	//da li je trenutna komanda razlicita od prethodne
 	bool cmd_is_new = cmd != prev_cmd;
@@ -180,6 +294,10 @@ void FW_Node::cmd_vel__cb(const geometry_msgs::msg::TwistStamped::SharedPtr msg)
 
 	// [-1.0, 1.0] -> [reverse, forward]
 	target_speed = static_cast<i16>(cmd.linear.x*2047);
+	// u zatvorenoj petlji linear.x je brzina u m/s
+	if(speed_ctrl){
+		speed_ctrl->set_target(cmd.linear.x);
+	}
 
 	// [1.0, -1.0] -> [left, right].
 	steering_angle = static_cast<i16>(((-cmd.angular.z + 1.0)/2.0 * 180));  //mapira ugaonu brzinu na uglove od 0 do 180
@@ -249,30 +367,118 @@ void FW_Node::cmd_vel__cb(const geometry_msgs::msg::TwistStamped::SharedPtr msg)
 	//write_pkg();
 }
 
+//meri kasnjenje od header.stamp do prijema komande
+//poredi se pokretanje u odvojenim procesima (DDS) i u jednom kontejneru (intra-process)
+void FW_Node::cmd_vel__latency_add(const rclcpp::Time & stamp) {
+	const rclcpp::Time now = this->now();
+	if(stamp.nanoseconds() > 0){
+		const double ms = (now - stamp).seconds()*1e3;
+		cmd_vel__latency.sum_ms += ms;
+		cmd_vel__latency.max_ms = std::max(cmd_vel__latency.max_ms, ms);
+		cmd_vel__latency.cnt++;
+	}
+
+	if(now - cmd_vel__latency.since < rclcpp::Duration(LATENCY_REPORT_PERIOD)){
+		return;
+	}
+	if(cmd_vel__latency.cnt != 0){
+		RCLCPP_INFO(
+			this->get_logger(),
+			"cmd_vel latency: mean %.3f ms max %.3f ms (%u msgs)",
+			cmd_vel__latency.sum_ms/cmd_vel__latency.cnt,
+			cmd_vel__latency.max_ms,
+			cmd_vel__latency.cnt
+		);
+	}
+	cmd_vel__latency = {0.0, 0.0, 0, now};
+}
+
 //callback funkcija koja periodicno proverava i azurira stanje motora i ako nisu stigle nove komande
 void FW_Node::repeater__cb() {
 	watchdog_dec();
-	int16_t final_speed = this->target_speed;
-
-	// EMERGENCY STOP LOGIKA
-    // Ako je prepreka bliža od 20cm (a nije 0, što može biti greška senzora)
-    if (ultrasound_distances[0] > 0.1f && ultrasound_distances[0] < 20.0f) {
-		//Ukoliko pokusava da se krece napred kocimo, moze da ide samo u rikverc
-		if (final_speed > 0)
-		{
-			RCLCPP_WARN(this->get_logger(), "Emergency Stop! Distance: %.2f cm", ultrasound_distances[0]);
-        	final_speed = 0;
+	drive();
+	hello__update();
+}
+
+//salje komandu voznje: iz regulatora ili otvorene petlje, uz emergency stop i watchdog
+void FW_Node::drive() {
+	int16_t final_speed = speed_ctrl ? speed_ctrl->output() : this->target_speed;
+
+	// KOCENJE PRED PREPREKOM
+	// Najnovija procena direktno iz read niti, cela (seqlock), ne ceka publish__cb.
+	// Napred najvise brzina sa koje se jos stigne zaustaviti, unazad se uvek moze.
+	range_sample_t range;
+	if(rd_range.load(range) != 0 && final_speed > 0){
+		const double cap = std::min(1.0, range.limit_mps/max_speed)*Speed_Controller::U_MAX;
+		if(final_speed > cap){
+			RCLCPP_WARN_THROTTLE(
+				this->get_logger(),
+				*this->get_clock(),
+				1000,
+				"Collision brake! Range %.2f m, rate %.2f m/s, ttc %.2f s, limit %.2f m/s",
+				range.range_m,
+				range.rate,
+				range.ttc,
+				range.limit_mps
+			);
+			final_speed = i16(cap);
 		}
-    }
+	}
 
 	if(watchdog_cnt == 0){
 		final_speed = 0;
 		this->steering_angle = 90;
 	}
+	//motor ne dobija izlaz regulatora, pa integrator ne sme da se puni
+	if(speed_ctrl && final_speed != speed_ctrl->output()){
+		speed_ctrl->hold();
+	}
 	this->speed=final_speed;
 	write_pkg();
 }
 
+//jednom u sekundi trazi protocol_version dok firmware salje drugu verziju;
+//posle HELLO_TRIES neuspelih pokusaja odustaje (stari firmware)
+void FW_Node::hello__update() {
+	const u8 v = fw_version;
+	if(v == 0 || v == protocol_version){
+		hello__cnt = 0;
+		hello__tick = 0;
+		return;
+	}
+	if(hello__cnt >= HELLO_TRIES){
+		return;
+	}
+	if(++hello__tick < REPEATER_HZ){
+		return;
+	}
+	hello__tick = 0;
+	hello__cnt++;
+	if(hello__cnt == HELLO_TRIES){
+		RCLCPP_WARN(
+			this->get_logger(),
+			"Firmware stays at protocol v%u, wanted v%d",
+			v,
+			protocol_version
+		);
+	}
+	write_hello();
+}
+
+void FW_Node::write_hello() {
+	pkg_hello_t p;
+	p.magic = PKG_HELLO_MAGIC;
+	p.payload.version = protocol_version;
+	p.crc = CRC16().add(p.payload).get_crc();
+
+	if(motor_ctrl_sensor_hub_serial.IsOpen()){
+		const u8* b = reinterpret_cast<const u8*>(&p);
+		motor_ctrl_sensor_hub_serial.Write(
+			std::vector<u8>(b, b + sizeof(p))
+		);
+	}
+}
+
 //salje trenutne brzine motora preko sabertootha
 void FW_Node::write_pkg() {
 
@@ -295,83 +501,93 @@ void FW_Node::write_pkg() {
 	}
 }
 
-//cita podatke sa sabertootha 
+//cita podatke sa sabertootha
+//nit spava u epoll_wait() dok na serijskom portu nema bajtova (ili dok je destruktor ne probudi),
+//pa u mirovanju ne trosi procesor; kad bajtovi stignu, svi se odmah prebace u rd_framer
 void FW_Node::read__loop() {
 	//ako nije otvorena serijska veza, ne radi nista
-	if(!motor_ctrl_sensor_hub_serial.IsOpen()){
+	if(!motor_ctrl_sensor_hub_serial.IsOpen() || read__wake_fd < 0){
 		return;
 	}
-	while(true){
-		read_pkg();
-	}
-}
+	const int serial_fd = motor_ctrl_sensor_hub_serial.GetFileDescriptor();
 
-void FW_Node::read_pkg() {
-	//sluzi za sinhronizaciju paketa
-	pkg_magic_t exp_magic = PKG_MAGIC;
-	pkg_magic_t obs_magic = 0;
-	
-	//proverava da li paket pocinje sa ocekivanim magic brojem
-	for(u8 i = 0; i < sizeof(pkg_magic_t); i++){
-		try{
-			motor_ctrl_sensor_hub_serial.Read(
-				rd_buf,
-				1,
-				1 // [ms]
-			);
-		}catch(LibSerial::ReadTimeout& e){
-			// Timeout.
-			return;
+	const int ep_fd = epoll_create1(EPOLL_CLOEXEC);
+	if(ep_fd < 0){
+		RCLCPP_ERROR(this->get_logger(), "epoll_create1 failed: %s", strerror(errno));
+		return;
+	}
+	epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = serial_fd;
+	epoll_ctl(ep_fd, EPOLL_CTL_ADD, serial_fd, &ev);
+	ev.data.fd = read__wake_fd;
+	epoll_ctl(ep_fd, EPOLL_CTL_ADD, read__wake_fd, &ev);
+
+	while(read__running){
+		epoll_event events[2];
+		const int n = epoll_wait(ep_fd, events, 2, -1);
+		if(n < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			RCLCPP_ERROR(this->get_logger(), "epoll_wait failed: %s", strerror(errno));
+			break;
 		}
-
-		//upisuje procitani bajt u obs_magic
-		reinterpret_cast<u8*>(&obs_magic)[i] = rd_buf[0];
-		//ako primlljeni bajt nije jednak ocekivanom magic bajtu, izlazi iz funkcije, paket je izgubljlen
-		if(
-			reinterpret_cast<u8*>(&exp_magic)[i] !=
-			reinterpret_cast<u8*>(&obs_magic)[i]
-		){
-			// Lost magic.
-			return;
+		for(int i = 0; i < n; i++){
+			if(events[i].data.fd != serial_fd){
+				continue; // budjenje iz destruktora, read__running je false
+			}
+			if(events[i].events & (EPOLLERR | EPOLLHUP) || !read_available(serial_fd)){
+				RCLCPP_ERROR(this->get_logger(), "Serial port closed, stop reading!");
+				read__running = false;
+			}
 		}
 	}
 
+	close(ep_fd);
+}
 
-	//cita ostatak paketa
-	//ako ne uspe da procita u zadatom vremenu, izlazi iz funkcije
-	try{
-		motor_ctrl_sensor_hub_serial.Read(
-			rd_buf,
-			sizeof(pkg_s2m_t)-sizeof(pkg_magic_t),		//cita sve sem magicnih brojeva
-			// Until all bytes are received.
-			10*sizeof(pkg_s2m_t)*1000/9600*2+5 // [ms]	//odredjuje timeout
-			//procenat greske * velicina paketa * ocekivano vreme prenosa u ms + mali dodatak
-
-		);
-	}catch(LibSerial::ReadTimeout& e){
-		RCLCPP_WARN(this->get_logger(), "Cannot read sensor pkg!");
-		return;
+//jedan read() svega sto je stiglo (epoll je level-triggered, ostatak javlja sledeci put),
+//pa obrada svih celih paketa iz bafera
+bool FW_Node::read_available(int fd) {
+	size_t len;
+	u8* dst = rd_framer.write_ptr(len);
+	const ssize_t r = read(fd, dst, len);
+	if(r < 0){
+		return errno == EINTR || errno == EAGAIN;
+	}
+	if(r == 0){
+		return true; // VMIN = 0: nema bajtova
+	}
+	rd_framer.commit(r);
+	//vreme prijema za sve pakete iz ovog read(), Enc_Stream uzima najmanje kasnjenje
+	const i64 t_ns = this->now().nanoseconds();
+
+	pkg_s2m_any_t p;
+	pkg_kind_t kind;
+	while((kind = rd_framer.next(p)) != PKG_NONE){
+		if(kind == PKG_S2M_V2){
+			read_pkg(p.v2, t_ns);
+		}else{
+			read_pkg(p.v1, t_ns);
+		}
 	}
 
-	
-	pkg_s2m_t p;				//struktura koja sadrzi primljeni paket
-	p.magic = obs_magic;		//postavlja magic broj na osnovu primljenog
-	//kopira ostatak paketa iz bafera u strukturu
-	copy(
-		rd_buf.begin(),
-		rd_buf.end(),
-		reinterpret_cast<uint8_t*>(&p) + sizeof(pkg_magic_t)
-	);
-
-	//proverava se integritet paketa preko CRC16 sume, ako ne odgovara paket je ostecen
-	pkg_crc_t obs_crc = CRC16().add(p.payload).get_crc();
-	if(obs_crc != p.crc){
-		RCLCPP_WARN(this->get_logger(), "Wrong CRC!");
-		DEBUG(obs_crc);
-		DEBUG(p.crc);
-//		return;
+	//proverava se integritet paketa preko CRC16 sume, framer odbacuje ostecene pakete
+	if(rd_framer.crc_errors != rd_crc_errors){
+		RCLCPP_WARN(
+			this->get_logger(),
+			"Wrong CRC! (%u packages, %u bytes skipped to resync)",
+			rd_framer.crc_errors - rd_crc_errors,
+			rd_framer.skipped
+		);
+		rd_crc_errors = rd_framer.crc_errors;
 	}
+	return true;
+}
 
+//obradjuje jedan ispravan paket iz rd_framer-a
+void FW_Node::read_pkg(const pkg_s2m_t & p, i64 t_ns) {
 	//promena znaka enkodera desnog tocka?????????????????????????????????????????????
 	// Switch sign of 1 enc.
 	// p.payload.enc[R_WHEEL] = -p.payload.enc[R_WHEEL];
@@ -402,39 +618,158 @@ void FW_Node::read_pkg() {
 	// }
 	prev_enc = p.payload.enc;
 
-	//publikuje procitane vrednosti enkodera na joint_states topik
+	read__version(1);
+	push_sample({t_ns, p.payload.enc}, p.payload.steering_angle_i);
+	//v1 nema brojac merenja; stari firmware meri pulseIn-om za svaki paket
+	this->front_sensor_check(p.payload.ultrasound_pulse, t_ns);
+}
+
+//obradjuje v2 paket: ENC_SAMPLES uzoraka enkodera, svaki sa svojim vremenom
+void FW_Node::read_pkg(const pkg_s2m_v2_t & p, i64 t_ns) {
+	read__version(p.payload.version);
+
+	enc_sample_t samples[ENC_SAMPLES];
+	const size_t n = rd_enc_stream.push(p, t_ns, samples);
+	for(size_t i = 0; i < n; i++){
+		push_sample(samples[i], p.payload.steering_angle_i);
+	}
+	if(n == 0){
+		return; // duplikat
+	}
+	prev_enc = samples[n - 1].enc;
+
+	if(rd_enc_stream.lost != rd_lost){
+		RCLCPP_WARN(
+			this->get_logger(),
+			"Lost %u telemetry batches (seq %u)!",
+			rd_enc_stream.lost - rd_lost,
+			p.payload.seq
+		);
+		rd_lost = rd_enc_stream.lost;
+	}
+	if(rd_enc_stream.pkgs % Clock_Sync::WINDOW == 0){
+		RCLCPP_DEBUG(
+			this->get_logger(),
+			"MCU clock drift %.0f ppm",
+			rd_enc_stream.clock().drift_ppm()
+		);
+	}
+
+	//paketi idu cesce nego merenja, ponovljeno merenje ne ide u filter
+	if(rd_range_seq.fresh(p.payload.ultrasound_cnt)){
+		this->front_sensor_check(p.payload.ultrasound_pulse, samples[n - 1].t_ns);
+	}
+}
+
+//prati verziju koju firmware salje; povratak na v1 znaci da je firmware resetovan
+void FW_Node::read__version(u8 version) {
+	const u8 prev = fw_version.exchange(version);
+	if(prev == version){
+		return;
+	}
+	RCLCPP_INFO(this->get_logger(), "Firmware telemetry protocol v%u", version);
+	if(version == 1){
+		rd_enc_stream.reset();
+		rd_range_seq.reset();
+		rd_lost = 0;
+	}
+}
+
+//iz read niti; ako executor kasni i red je pun, uzorak se odbacuje
+void FW_Node::push_sample(const enc_sample_t & s, i16 steering_angle) {
+	if(!rd_samples.push({s, steering_angle})){
+		rd_samples_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+//na executor-u: objavljuje sve sto je read nit predala od proslog poziva
+void FW_Node::publish__cb() {
+	joint_sample_t s;
+	bool have_samples = false;
+	while(rd_samples.pop(s)){
+		publish_joints(
+			s,
+			rclcpp::Time(s.enc.t_ns, this->get_clock()->get_clock_type())
+		);
+		if(speed_ctrl){
+			speed_ctrl->update(s.enc.enc, s.enc.t_ns);
+		}
+		have_samples = true;
+	}
+	//regulator radi na brzini paketa, komanda ide odmah a ne tek u repeater__cb
+	if(speed_ctrl && have_samples){
+		drive();
+	}
+
+	const u32 dropped = rd_samples_dropped.load(std::memory_order_relaxed);
+	if(dropped != pub_samples_dropped){
+		RCLCPP_WARN(
+			this->get_logger(),
+			"Executor too slow, dropped %u encoder samples!",
+			dropped - pub_samples_dropped
+		);
+		pub_samples_dropped = dropped;
+	}
+
+	range_sample_t range;
+	const u32 seq = rd_range.load(range);
+	if(seq != pub_range_seq){
+		pub_range_seq = seq;
+		//Prednji senzor
+		ultrasound_distances[0] = range.dist_cm;
+
+		// Slanje podatka na ROS topik
+		auto message = std_msgs::msg::Float32MultiArray();
+		message.data = ultrasound_distances; // Kopira ceo vektor u poruku
+		ultrasound_pub->publish(message);
+	}
+}
+
+//publikuje procitane vrednosti enkodera i ugao servoa na joint_states topik
+void FW_Node::publish_joints(const joint_sample_t & s, const rclcpp::Time & stamp) {
 	auto msg = std::make_unique<sensor_msgs::msg::JointState>();
 
 	//postavlja zaglavlje ros poruke
 	msg->header.frame_id = "base_link";
-	msg->header.stamp = this->now();
+	msg->header.stamp = stamp;
 	//postavlja imena zglobova
 	//msg->name.push_back("wheel_left_joint");
 	//msg->name.push_back("wheel_right_joint");
 	msg->name.push_back("bldc_position");
+	msg->name.push_back("steering_servo");
 	//pretvaraju enkoder tikove u rotaciju tockova i stavljaju u poruku da bi ostali cvorovi znali kako su tockovi okrenuti
 	// msg->position.push_back(tick_to_rad * p.payload.enc[L_WHEEL]);
 	// msg->position.push_back(tick_to_rad * p.payload.enc[R_WHEEL]);
-	msg->position.push_back(tick_to_rad * p.payload.enc);
-
-	this->front_sensor_check(p);
+	msg->position.push_back(tick_to_rad * s.enc.enc);
+	//otklon servoa od pravca u rad, pozitivno levo (90 stepeni je pravo)
+	msg->position.push_back((90 - s.steering_angle)*M_PI/180.0);
 
 	joint_state__pub->publish(std::move(msg));
-	
 }
 
-void FW_Node::front_sensor_check(const pkg_s2m_t & p){
+//iz read niti, za svako novo merenje: filtrira rastojanje, racuna limit brzine
+//i objavljuje sve za drive() i publish__cb
+void FW_Node::front_sensor_check(u32 ultrasound_pulse, i64 t_ns){
 	// OBRADA ULTRAZVUČNOG SENZORA
     
     // Konverzija: mikrosekunde (uint32) -> centimetri (float)
     // Formula: (vreme * brzina_zvuka) / 2
-    float dist = static_cast<float>(p.payload.ultrasound_pulse) * 0.0343f / 2.0f;
-	//Prednji senzor
-    ultrasound_distances[0] = dist;
-
-    // Slanje podatka na ROS topik ?
-    auto message = std_msgs::msg::Float32MultiArray();
-    message.data = ultrasound_distances; // Kopira ceo vektor u poruku
-    ultrasound_pub->publish(message);
+    // Pulse 0 je echo koji nije stigao, filter ga ne racuna kao prepreku
+    float dist = static_cast<float>(ultrasound_pulse) * 0.0343f / 2.0f;
+
+	rd_range_filter.update(t_ns, dist/100.0);
+	rd_brake.update(rd_range_filter);
+
+	range_sample_t s;
+	s.t_ns = t_ns;
+	s.dist_cm = dist;
+	s.range_m = rd_range_filter.valid() ? rd_range_filter.range() : 0.0f;
+	s.rate = rd_range_filter.has_rate() ? rd_range_filter.rate() : 0.0f;
+	s.ttc = rd_brake.ttc();
+	s.limit_mps = rd_brake.speed_limit();
+	rd_range.store(s);
 }
 
+#include <rclcpp_components/register_node_macro.hpp>
+
+RCLCPP_COMPONENTS_REGISTER_NODE(FW_Node)
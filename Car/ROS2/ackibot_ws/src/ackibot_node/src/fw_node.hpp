@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <map>
@@ -24,7 +25,13 @@
 
 #include <libserial/SerialPort.h>
 
+#include "collision_brake.hpp"
+#include "enc_stream.hpp"
 #include "fw_pkgs.hpp"
+#include "pkg_framer.hpp"
+#include "seqlock.hpp"
+#include "speed_controller.hpp"
+#include "spsc_ring.hpp"
 
 class FW_Node : public rclcpp::Node {
 public:
@@ -43,7 +50,12 @@ public:
 
 	//konstruktor i destruktor
 	explicit FW_Node(const std::string & usb_port);
-	virtual ~FW_Node() {}
+	//konstruktor komponente, port se cita iz parametra usb_port ako nije prosledjen
+	explicit FW_Node(
+		const rclcpp::NodeOptions & options,
+		const std::string & usb_port = ""
+	);
+	virtual ~FW_Node();
 
 	//deklaracija metoda implementiranih u fw_node.cpp
 
@@ -74,25 +86,82 @@ private:
 	void watchdog_apply();
 
 	rclcpp::Subscription<geometry_msgs::msg::TwistStamped>::SharedPtr cmd_vel__sub;
-	void cmd_vel__cb(const geometry_msgs::msg::TwistStamped::SharedPtr msg);
+	// ConstSharedPtr: u istom procesu poruka od twist_mux stize kao pokazivac, bez kopije.
+	void cmd_vel__cb(const geometry_msgs::msg::TwistStamped::ConstSharedPtr msg);
+	// Kasnjenje cmd_vel od header.stamp do prijema, periodicno se ispisuje.
+	struct {
+		double sum_ms;
+		double max_ms;
+		u32 cnt;
+		rclcpp::Time since;
+	} cmd_vel__latency;
+	void cmd_vel__latency_add(const rclcpp::Time & stamp);
 	geometry_msgs::msg::Twist prev_cmd;
 	rclcpp::TimerBase::SharedPtr repeater__tmr;
 	void repeater__cb();
+	//zatvorena petlja brzine po enkoderu; nullptr je otvorena petlja
+	//(linear.x je tada normalizovan na [-1, 1], a ne u m/s)
+	std::unique_ptr<Speed_Controller> speed_ctrl;
+	double max_speed; // m/s pri komandi MODULUS - 1, za limit kocenja
+	void drive();
 	std::vector<u8> wr_buf;
 	void write_pkg();
-	void front_sensor_check(const pkg_s2m_t & p);
+	void front_sensor_check(u32 ultrasound_pulse, i64 t_ns);
+
+	//izbor verzije telemetrije (pkg_hello_t)
+	int protocol_version; // zeljena verzija, parametar
+	std::atomic<u8> fw_version; // verzija poslednjeg paketa od firmware-a, 0 dok ne stigne
+	u32 hello__cnt; // poslati hello od poslednje potvrde
+	u32 hello__tick;
+	void hello__update();
+	void write_hello();
 
 
 	std::thread read__thread;
+	std::atomic<bool> read__running;
+	int read__wake_fd; // eventfd koji budi read__loop pri gasenju
 	void read__loop();
-	std::vector<u8> rd_buf;
-	void read_pkg();
+	Pkg_Framer<> rd_framer;
+	u32 rd_crc_errors; // vec prijavljene CRC greske
+	Enc_Stream rd_enc_stream;
+	u32 rd_lost; // vec prijavljene izgubljene serije
+	bool read_available(int fd);
+	void read_pkg(const pkg_s2m_t & p, i64 t_ns);
+	void read_pkg(const pkg_s2m_v2_t & p, i64 t_ns);
+	void read__version(u8 version);
 	i32 prev_enc;
+	Range_Filter rd_range_filter; // samo u read niti
+	Range_Sequence rd_range_seq; // samo u read niti
+	Collision_Brake rd_brake; // samo u read niti
+
+	//predaja od read__loop ka executor-u, bez zakljucavanja:
+	//read nit samo upisuje, a publish__cb jedini objavljuje poruke
+	struct joint_sample_t {
+		enc_sample_t enc;
+		i16 steering_angle; // servo, stepeni, iz istog paketa (steering_angle_i)
+	};
+	struct range_sample_t {
+		i64 t_ns;
+		float dist_cm; // sirovo merenje
+		float range_m; // filtrirano, 0 kad nema prepreke
+		float rate; // m/s, negativno kad se prepreka priblizava
+		float ttc; // s
+		float limit_mps; // najveca brzina napred, inf kad nema prepreke
+	};
+	SPSC_Ring<joint_sample_t, 256> rd_samples; // uzorci za joint_states
+	std::atomic<u32> rd_samples_dropped; // pun rd_samples
+	Seqlock<range_sample_t> rd_range; // poslednje rastojanje, za kocenje pred preprekom
+	void push_sample(const enc_sample_t & s, i16 steering_angle);
+	u32 pub_range_seq; // poslednji objavljen upis u rd_range
+	u32 pub_samples_dropped; // vec prijavljeni izgubljeni uzorci
+	rclcpp::TimerBase::SharedPtr publish__tmr;
+	void publish__cb();
+	void publish_joints(const joint_sample_t & s, const rclcpp::Time & stamp);
 	//i32 prev_enc[2];
 	rclcpp::Publisher<sensor_msgs::msg::JointState>::SharedPtr joint_state__pub;
 
 	///NOVO
 	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr ultrasound_pub;
-	std::vector<float> ultrasound_distances;
+	std::vector<float> ultrasound_distances; // samo na executor-u (publish__cb)
 
 };
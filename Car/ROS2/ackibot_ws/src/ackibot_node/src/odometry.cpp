@@ -3,12 +3,21 @@
 
 #include "odometry.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
 
 using ackibot::Odometry;
 using namespace std::chrono_literals;
+
+namespace
+{
+const char DRIVE_JOINT[] = "bldc_position";     //enkoder pogona, FW_Node
+const char STEERING_JOINT[] = "steering_servo";  //otklon servoa u rad, FW_Node
+const size_t NO_JOINT = size_t(-1);
+}  // namespace
 //PUBLISHUJE NA ENC_ODOM
 //SUBSCRIBUJE NA JOINT_STATES AKO IMU JESTE KORISTEN
 //konstruktor koji prima tri parametra
@@ -21,7 +30,18 @@ Odometry::Odometry(
   wheels_radius_(wheels_radius),
   use_imu_(false),
   publish_tf_(false),
-  imu_angle_(0.0f)
+  steering_ratio_(0.0),
+  odometry_(declare_params(*nh)),
+  drive_joint_(NO_JOINT),
+  steering_joint_(NO_JOINT),
+  have_last_(false),
+  last_drive_position_(0.0),
+  last_steering_(0.0),
+  last_imu_angle_(0.0),
+  drive_position_(0.0),
+  steering_(0.0),
+  imu_angle_(0.0),
+  robot_vel_({0.0, 0.0, 0.0})
   //inicijalizacija promenljivih
 {
   //logovanje pocetka
@@ -56,7 +76,24 @@ Odometry::Odometry(
     child_frame_id_of_odometry_,
     std::string("base_footprint"));
 
-  
+  //ugao prednjih tockova = steering_ratio * otklon servoa (poluga volana)
+  steering_ratio_ = nh_->declare_parameter<double>("odometry.steering_ratio", 0.35);
+
+  //zaglavlja i konstantni delovi poruka se postavljaju jednom
+  odom_msg_.header.frame_id = frame_id_of_odometry_;
+  odom_msg_.child_frame_id = child_frame_id_of_odometry_;
+  odom_msg_.pose.pose.position.z = 0;  //z uvek 0 jer se robot krece po ravni
+  //z, roll i pitch su fiksni za auto u ravni
+  odom_msg_.pose.covariance[14] = 1.0e-9;
+  odom_msg_.pose.covariance[21] = 1.0e-9;
+  odom_msg_.pose.covariance[28] = 1.0e-9;
+  odom_msg_.twist.covariance[7] = 1.0e-9;   //nema bocnog klizanja u modelu
+  odom_msg_.twist.covariance[14] = 1.0e-9;
+  odom_msg_.twist.covariance[21] = 1.0e-9;
+  odom_msg_.twist.covariance[28] = 1.0e-9;
+  odom_tf_.header.frame_id = frame_id_of_odometry_;
+  odom_tf_.child_frame_id = child_frame_id_of_odometry_;
+
   //kreiranje publishera koji objavljuje odometriju
   auto qos = rclcpp::QoS(rclcpp::KeepLast(10));
   odom_pub_ = nh_->create_publisher<nav_msgs::msg::Odometry>("/enc_odom", qos);
@@ -126,18 +163,25 @@ if (use_imu_) {
   }
 }
 
+//parametri modela, citaju se pre konstrukcije odometry_
+Ackermann_Odometry::Params Odometry::declare_params(rclcpp::Node & nh)
+{
+  Ackermann_Odometry::Params p;
+  p.wheelbase = nh.declare_parameter<double>("odometry.wheelbase", 0.32);
+  p.distance_noise = nh.declare_parameter<double>("odometry.distance_noise", 0.02);
+  p.steering_noise = nh.declare_parameter<double>("odometry.steering_noise", 0.02);
+  p.heading_noise = nh.declare_parameter<double>("odometry.imu_heading_noise", 0.002);
+  return p;
+}
+
 //obradjuje joint_state poruke i racuna odometriju kada IMU nije koriscen
-void Odometry::joint_state_callback(const sensor_msgs::msg::JointState::SharedPtr joint_state_msg)
+void Odometry::joint_state_callback(const sensor_msgs::msg::JointState::ConstSharedPtr joint_state_msg)
 {
   const rclcpp::Time current_time = joint_state_msg->header.stamp;  //vreme poruke
-  static rclcpp::Time last_time = current_time;             //vreme prethodne poruke  
-  const rclcpp::Duration duration = current_time - last_time;     //vremenski interval izmedju dve poruke
 
-  update_joint_state(joint_state_msg);
-  calculate_odometry(duration);
-  publish(current_time);        //publishuje poruku odometrije i TF transformaciju
-
-  last_time = current_time;
+  if (update_joint_state(*joint_state_msg) && calculate_odometry(current_time)) {
+    publish(current_time);        //publishuje poruku odometrije i TF transformaciju
+  }
 }
 
 //obradjuje poruke joint_state i IMU i racuna odometriju
@@ -152,98 +196,114 @@ void Odometry::joint_state_and_imu_callback(
     imu_msg->header.stamp.nanosec);
 
   const rclcpp::Time current_time = joint_state_msg->header.stamp;
-  static rclcpp::Time last_time = current_time;
-  const rclcpp::Duration duration = current_time - last_time;
 
-  update_joint_state(joint_state_msg);
   update_imu(imu_msg);
-  calculate_odometry(duration);
-  publish(current_time);
-
-  last_time = current_time;
+  if (update_joint_state(*joint_state_msg) && calculate_odometry(current_time)) {
+    publish(current_time);
+  }
 }
 
 //slanje poruke odometrije i TF transformacije
 void Odometry::publish(const rclcpp::Time & now)
 {
-  auto odom_msg = std::make_unique<nav_msgs::msg::Odometry>();  //kreira se poruka odometrije
+  const Ackermann_Odometry::Vec3 & pose = odometry_.get_pose();
+  const Ackermann_Odometry::Mat3 & cov = odometry_.covariance();
 
-  odom_msg->header.frame_id = frame_id_of_odometry_;
-  odom_msg->child_frame_id = child_frame_id_of_odometry_;
-  odom_msg->header.stamp = now;
+  odom_msg_.header.stamp = now;
 
   //pozicija robota
-  odom_msg->pose.pose.position.x = robot_pose_[0];    //x
-  odom_msg->pose.pose.position.y = robot_pose_[1];    //y
-  odom_msg->pose.pose.position.z = 0;  //z uvek 0 jer se robot krece po ravni
-
-
-  //orijentacija robota se predstavlja kvaternionom
-  tf2::Quaternion q;
-  q.setRPY(0.0, 0.0, robot_pose_[2]);       //theta
-
-  //postavljanje kvaterniona u poruci odometrije
-
-  odom_msg->pose.pose.orientation.x = q.x();
-  odom_msg->pose.pose.orientation.y = q.y();
-  odom_msg->pose.pose.orientation.z = q.z();
-  odom_msg->pose.pose.orientation.w = q.w();
+  odom_msg_.pose.pose.position.x = pose[0];    //x
+  odom_msg_.pose.pose.position.y = pose[1];    //y
+
+  //orijentacija robota se predstavlja kvaternionom, samo oko z ose
+  odom_msg_.pose.pose.orientation.x = 0.0;
+  odom_msg_.pose.pose.orientation.y = 0.0;
+  odom_msg_.pose.pose.orientation.z = std::sin(0.5 * pose[2]);
+  odom_msg_.pose.pose.orientation.w = std::cos(0.5 * pose[2]);
+
+  //kovarijansa poze (x, y, yaw) u 6x6 matrici (x, y, z, roll, pitch, yaw)
+  const int idx[3] = {0, 1, 5};
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      odom_msg_.pose.covariance[idx[i] * 6 + idx[j]] = cov[i][j];
+    }
+  }
 
   //postavljanje brzine robota u poruci odometrije
 
-  odom_msg->twist.twist.linear.x = robot_vel_[0];
-  odom_msg->twist.twist.angular.z = robot_vel_[2];
-
-  // TODO(Will Son): Find more accurate covariance.
-  // odom_msg->pose.covariance[0] = 0.05;
-  // odom_msg->pose.covariance[7] = 0.05;
-  // odom_msg->pose.covariance[14] = 1.0e-9;
-  // odom_msg->pose.covariance[21] = 1.0e-9;
-  // odom_msg->pose.covariance[28] = 1.0e-9;
-  // odom_msg->pose.covariance[35] = 0.0872665;
-
-  // odom_msg->twist.covariance[0] = 0.001;
-  // odom_msg->twist.covariance[7] = 1.0e-9;
-  // odom_msg->twist.covariance[14] = 1.0e-9;
-  // odom_msg->twist.covariance[21] = 1.0e-9;
-  // odom_msg->twist.covariance[28] = 1.0e-9;
-  // odom_msg->twist.covariance[35] = 0.001;
-
-  //kreira se TF transformacija izmedju koordinatnih sistema odometrije i robota
-
-  geometry_msgs::msg::TransformStamped odom_tf;
+  odom_msg_.twist.twist.linear.x = robot_vel_[0];
+  odom_msg_.twist.twist.angular.z = robot_vel_[2];
 
 //popunjavanje TF transformacije podacima iz poruke odometrije
-  odom_tf.transform.translation.x = odom_msg->pose.pose.position.x;
-  odom_tf.transform.translation.y = odom_msg->pose.pose.position.y;
-  odom_tf.transform.translation.z = odom_msg->pose.pose.position.z;
-  odom_tf.transform.rotation = odom_msg->pose.pose.orientation;
-
-//definisanje zaglavlja TF transformacije i vremena
-  odom_tf.header.frame_id = frame_id_of_odometry_;
-  odom_tf.child_frame_id = child_frame_id_of_odometry_;
-  odom_tf.header.stamp = now;
+  odom_tf_.transform.translation.x = odom_msg_.pose.pose.position.x;
+  odom_tf_.transform.translation.y = odom_msg_.pose.pose.position.y;
+  odom_tf_.transform.translation.z = odom_msg_.pose.pose.position.z;
+  odom_tf_.transform.rotation = odom_msg_.pose.pose.orientation;
+  odom_tf_.header.stamp = now;
 
 //publishovanje poruke odometrije
-  odom_pub_->publish(std::move(odom_msg));
+  odom_pub_->publish(odom_msg_);
 
 //slanje TF transformacije ako je publish_tf_ true
   if (publish_tf_) {
-    tf_broadcaster_->sendTransform(odom_tf);
+    tf_broadcaster_->sendTransform(odom_tf_);
   }
 }
 
-//prati promenu pozicija tockova i racuna razliku u odnosu na prethodnu poziciju
-void Odometry::update_joint_state(
-  const std::shared_ptr<sensor_msgs::msg::JointState const> & joint_state)
+//nalazi indekse zglobova po imenu; FW_Node salje uvek isti raspored,
+//pa se posle prve poruke samo proverava da se nije promenio
+bool Odometry::find_joints(const sensor_msgs::msg::JointState & joint_state)
 {
-  static std::array<double, 2> last_joint_positions = {0.0f, 0.0f};
+  const size_t n = std::min(joint_state.name.size(), joint_state.position.size());
+  const bool cached =
+    drive_joint_ < n && joint_state.name[drive_joint_] == DRIVE_JOINT &&
+    (steering_joint_ == NO_JOINT ||
+    (steering_joint_ < n && joint_state.name[steering_joint_] == STEERING_JOINT));
+  if (cached) {
+    return true;
+  }
+
+  drive_joint_ = NO_JOINT;
+  steering_joint_ = NO_JOINT;
+  for (size_t i = 0; i < n; i++) {
+    if (joint_state.name[i] == DRIVE_JOINT) {
+      drive_joint_ = i;
+    } else if (joint_state.name[i] == STEERING_JOINT) {
+      steering_joint_ = i;
+    }
+  }
+  if (drive_joint_ == NO_JOINT) {
+    RCLCPP_WARN_THROTTLE(
+      nh_->get_logger(), *nh_->get_clock(), 5000,
+      "joint_states without %s, no odometry", DRIVE_JOINT);
+    return false;
+  }
+  if (steering_joint_ == NO_JOINT) {
+    RCLCPP_WARN(
+      nh_->get_logger(),
+      "joint_states without %s, assuming straight steering", STEERING_JOINT);
+  }
+  return true;
+}
 
-  diff_joint_positions_[0] = joint_state->position[0] - last_joint_positions[0];
-  diff_joint_positions_[1] = joint_state->position[1] - last_joint_positions[1];
+//cita polozaj pogona i ugao skretanja iz poruke
+bool Odometry::update_joint_state(const sensor_msgs::msg::JointState & joint_state)
+{
+  if (!find_joints(joint_state)) {
+    return false;
+  }
 
-  last_joint_positions[0] = joint_state->position[0];
-  last_joint_positions[1] = joint_state->position[1];
+  drive_position_ = joint_state.position[drive_joint_];
+  steering_ = steering_joint_ == NO_JOINT ?
+    0.0 :
+    steering_ratio_ * joint_state.position[steering_joint_];
+  if (std::isnan(drive_position_)) {
+    drive_position_ = last_drive_position_;
+  }
+  if (std::isnan(steering_)) {
+    steering_ = last_steering_;
+  }
+  return true;
 }
 
 //koristi podatke sa IMU senzora da azurira ugao rotacije robota oko z ose
@@ -254,65 +314,42 @@ void Odometry::update_imu(const std::shared_ptr<sensor_msgs::msg::Imu const> & i
     0.5f - imu->orientation.y * imu->orientation.y - imu->orientation.z * imu->orientation.z);
 }
 
-//prima vremenski interval izmedju dve poruke
-bool Odometry::calculate_odometry(const rclcpp::Duration & duration)
+//integrise korak od prethodne poruke; false za prvu poruku
+bool Odometry::calculate_odometry(const rclcpp::Time & current_time)
 {
-  //razlika u poziciji tockova od prethodne poruke
-  double wheel_l = diff_joint_positions_[0];
-  double wheel_r = diff_joint_positions_[1];
-
-  double delta_s = 0.0;
-  double delta_theta = 0.0;
-
-  double theta = 0.0;
-  static double last_theta = 0.0;
-
-  double v = 0.0;
-  double w = 0.0;
-
-  double step_time = duration.seconds();
-
-  //provera vremenskog intervala, vrednosti tockova
-  if (step_time == 0.0) {
+  if (!have_last_) {
+    have_last_ = true;
+    last_time_ = current_time;
+    last_drive_position_ = drive_position_;
+    last_steering_ = steering_;
+    last_imu_angle_ = imu_angle_;
     return false;
   }
 
-  if (std::isnan(wheel_l)) {
-    wheel_l = 0.0;
-  }
-
-  if (std::isnan(wheel_r)) {
-    wheel_r = 0.0;
-  }
-
-  //predjena udaljenost centra robota - prosecna vrednost oba tocka * radijus
-  delta_s = wheels_radius_ * (wheel_r + wheel_l) / 2.0;
+  //predjeni put zadnje osovine iz enkodera pogona
+  const double delta_s = wheels_radius_ * (drive_position_ - last_drive_position_);
 
   // racunanje promene ugla theta sa ili bez IMU
   if (use_imu_) {
-    theta = imu_angle_;
-    delta_theta = theta - last_theta;
+    odometry_.step_heading(delta_s, std::remainder(imu_angle_ - last_imu_angle_, 2.0 * M_PI));
   } else {
-    //ako nema IMU racuna se ugao na osnovu razlike u poziciji tockova
-    theta = wheels_radius_ * (wheel_r - wheel_l) / wheels_separation_;
-
-    delta_theta = theta;
+    //bez IMU ugao ide iz ugla skretanja, koji se menja linearno tokom koraka
+    odometry_.step(delta_s, last_steering_, steering_);
   }
 
+  // racunanje linearne i ugaone brzine; duplikat vremena ne menja brzine
+  const double step_time = (current_time - last_time_).seconds();
+  if (step_time > 0.0) {
+    robot_vel_[0] = odometry_.delta_s() / step_time;
+    robot_vel_[1] = 0.0;    //brzina po y je uvek 0
+    robot_vel_[2] = odometry_.delta_theta() / step_time;
+    odom_msg_.twist.covariance[0] = odometry_.var_delta_s() / (step_time * step_time);
+    odom_msg_.twist.covariance[35] = odometry_.var_delta_theta() / (step_time * step_time);
+  }
 
- // azuriranje pozicije robota
-  robot_pose_[0] += delta_s * cos(robot_pose_[2] + (delta_theta / 2.0));
-  robot_pose_[1] += delta_s * sin(robot_pose_[2] + (delta_theta / 2.0));
-  robot_pose_[2] += delta_theta;
-
-  // racunanje linearne i ugaone brzine
-  v = delta_s / step_time;
-  w = delta_theta / step_time;
-
-  robot_vel_[0] = v;
-  robot_vel_[1] = 0.0;    //brzina po y je uvek 0
-  robot_vel_[2] = w;
-
-  last_theta = theta;
+  last_time_ = current_time;
+  last_drive_position_ = drive_position_;
+  last_steering_ = steering_;
+  last_imu_angle_ = imu_angle_;
   return true;
 }
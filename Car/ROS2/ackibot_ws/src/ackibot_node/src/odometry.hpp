@@ -9,7 +9,6 @@
 #include <message_filters/sync_policies/approximate_time.h>
 #include <message_filters/synchronizer.h>
 #include <tf2_ros/transform_broadcaster.h>
-#include <tf2/LinearMath/Quaternion.h>
 
 #include <geometry_msgs/msg/transform_stamped.hpp>
 #include <nav_msgs/msg/odometry.hpp>
@@ -17,6 +16,8 @@
 #include <sensor_msgs/msg/imu.hpp>
 #include <sensor_msgs/msg/joint_state.hpp>
 
+#include "ackermann_odometry.hpp"
+
 
 namespace ackibot
 {
@@ -31,12 +32,15 @@ public:
 
 private:
 //deklaracije metoda koje su implementirane u odometry.cpp
-  bool calculate_odometry(const rclcpp::Duration & duration);
+  static Ackermann_Odometry::Params declare_params(rclcpp::Node & nh);
+
+  bool calculate_odometry(const rclcpp::Time & current_time);
 
   void update_imu(const std::shared_ptr<sensor_msgs::msg::Imu const> & imu);
-  void update_joint_state(const std::shared_ptr<sensor_msgs::msg::JointState const> & joint_state);
+  bool update_joint_state(const sensor_msgs::msg::JointState & joint_state);
+  bool find_joints(const sensor_msgs::msg::JointState & joint_state);
 
-  void joint_state_callback(const sensor_msgs::msg::JointState::SharedPtr joint_state_msg);
+  void joint_state_callback(const sensor_msgs::msg::JointState::ConstSharedPtr joint_state_msg);
 
   void joint_state_and_imu_callback(
     const std::shared_ptr<sensor_msgs::msg::JointState const> & joint_state_msg,
@@ -69,11 +73,26 @@ private:
 
   bool use_imu_;
   bool publish_tf_;
-
-  std::array<double, 2> diff_joint_positions_;
+  double steering_ratio_;   //ugao prednjih tockova po uglu servoa
+
+  //sve stanje je po instanci, ne u static promenljivim
+  Ackermann_Odometry odometry_;
+  size_t drive_joint_;      //indeks bldc_position u poslednjoj poruci
+  size_t steering_joint_;   //indeks steering_servo, NO_JOINT ako ga nema
+  bool have_last_;          //prva poruka samo postavlja pocetne vrednosti
+  rclcpp::Time last_time_;
+  double last_drive_position_;
+  double last_steering_;
+  double last_imu_angle_;
+
+  double drive_position_;
+  double steering_;
   double imu_angle_;
 
-  std::array<double, 3> robot_pose_;
   std::array<double, 3> robot_vel_;
+
+  //poruke se popunjavaju u mestu, callback ne alocira
+  nav_msgs::msg::Odometry odom_msg_;
+  geometry_msgs::msg::TransformStamped odom_tf_;
 };
 }  // namespace ackibot
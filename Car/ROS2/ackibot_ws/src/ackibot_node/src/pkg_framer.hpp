@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "fw_pkgs.hpp"
+
+//Vrsta paketa koju je Pkg_Framer::next() izvadio.
+enum pkg_kind_t {
+	PKG_NONE = 0,	//u baferu nema celog paketa
+	PKG_S2M_V1,		//pkg_s2m_t
+	PKG_S2M_V2		//pkg_s2m_v2_t
+};
+
+//Mesto za bilo koji paket od firmware-a, polje bira pkg_kind_t.
+union pkg_s2m_any_t {
+	pkg_s2m_t v1;
+	pkg_s2m_v2_t v2;
+};
+
+//Framer za pakete sa serijskog porta.
+//Bajtovi se upisuju u ring bafer onako kako stignu (bilo koja velicina komada),
+//a next() iz njega vadi pakete: po magic-u bira verziju (PKG_MAGIC ili
+//PKG_V2_MAGIC), proverava CRC i na gresci pomera pocetak za samo jedan bajt,
+//pa sledeci paket nije izgubljen. Obe verzije mogu da se mesaju u toku.
+//Jedan pisac i jedan citac u istoj niti (read__loop), bez zakljucavanja.
+template<size_t N = 512>
+class Pkg_Framer {
+	static_assert((N & (N - 1)) == 0, "N must be a power of two");
+	static_assert(N >= 2*sizeof(pkg_s2m_any_t), "N must hold at least two packages");
+
+public:
+	Pkg_Framer() {
+		reset();
+	}
+
+	void reset() {
+		head = 0;
+		tail = 0;
+		crc_errors = 0;
+		skipped = 0;
+		pkgs = 0;
+	}
+
+	//broj bajtova u baferu koji jos nisu obradjeni
+	size_t size() const {
+		return head - tail;
+	}
+
+	//neprekidan slobodan deo bafera, za direktan read() u njega
+	u8* write_ptr(size_t& len) {
+		const size_t pos = head & (N - 1);
+		len = N - size();
+		if(len > N - pos){
+			len = N - pos;
+		}
+		return buf + pos;
+	}
+
+	//potvrdjuje n bajtova upisanih preko write_ptr()
+	void commit(size_t n) {
+		head += n;
+	}
+
+	//kopira bajtove u bafer; vraca koliko je stalo
+	size_t write(const u8* data, size_t len) {
+		size_t done = 0;
+		while(done < len){
+			size_t free;
+			u8* dst = write_ptr(free);
+			if(free == 0){
+				break;
+			}
+			if(free > len - done){
+				free = len - done;
+			}
+			memcpy(dst, data + done, free);
+			commit(free);
+			done += free;
+		}
+		return done;
+	}
+
+	//vadi sledeci ispravan paket; PKG_NONE ako u baferu nema celog paketa
+	pkg_kind_t next(pkg_s2m_any_t& p) {
+		while(size() >= sizeof(pkg_magic_t)){
+			//preskace sve do prvog poznatog magic-a
+			pkg_magic_t magic;
+			copy_out(reinterpret_cast<u8*>(&magic), sizeof(magic));
+			pkg_kind_t kind;
+			size_t len;
+			if(magic == PKG_MAGIC){
+				kind = PKG_S2M_V1;
+				len = sizeof(pkg_s2m_t);
+			}else if(magic == PKG_V2_MAGIC){
+				kind = PKG_S2M_V2;
+				len = sizeof(pkg_s2m_v2_t);
+			}else{
+				drop(1);
+				skipped++;
+				continue;
+			}
+
+			if(size() < len){
+				return PKG_NONE;
+			}
+			copy_out(reinterpret_cast<u8*>(&p), len);
+			if(!crc_ok(p, kind)){
+				//magic je bio deo podataka ili je paket ostecen;
+				//sledeci pravi magic moze biti vec unutar ovih bajtova
+				drop(1);
+				skipped++;
+				crc_errors++;
+				continue;
+			}
+
+			drop(len);
+			pkgs++;
+			return kind;
+		}
+		return PKG_NONE;
+	}
+
+	//statistika od poslednjeg reset()
+	u32 crc_errors;	//paketi sa pogresnim CRC-om
+	u32 skipped;	//bajtovi odbaceni pri resinhronizaciji
+	u32 pkgs;		//ispravni paketi
+
+private:
+	static bool crc_ok(const pkg_s2m_any_t& p, pkg_kind_t kind) {
+		if(kind == PKG_S2M_V2){
+			return CRC16().add(p.v2.payload).get_crc() == p.v2.crc;
+		}
+		return CRC16().add(p.v1.payload).get_crc() == p.v1.crc;
+	}
+
+	void drop(size_t n) {
+		tail += n;
+	}
+
+	void copy_out(u8* dst, size_t n) const {
+		const size_t pos = tail & (N - 1);
+		const size_t first = n < N - pos ? n : N - pos;
+		memcpy(dst, buf + pos, first);
+		memcpy(dst + first, buf, n - first);
+	}
+
+	u8 buf[N];
+	//slobodno rastuci indeksi, pozicija u baferu je indeks & (N - 1)
+	size_t head;
+	size_t tail;
+};
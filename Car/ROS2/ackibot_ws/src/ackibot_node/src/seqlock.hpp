@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "type_shorts.h"
+
+//Poslednja vrednost koju jedan pisac objavljuje, a bilo ko cita bez
+//zakljucavanja i uvek cela (npr. rastojanje za emergency stop).
+//Pisac nikad ne ceka; citac ponavlja citanje ako ga je upis prekinuo.
+//Podaci su u atomic recima (relaxed), pa istovremeni upis i citanje
+//nisu data race.
+template<typename T>
+class Seqlock {
+	static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(u64) - 1)/sizeof(u64);
+
+public:
+	Seqlock()
+		: seq(0)
+	{
+		for(size_t i = 0; i < WORDS; i++){
+			data[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	//samo jedan pisac
+	void store(const T& v) {
+		u64 w[WORDS] = {};
+		memcpy(w, &v, sizeof(T));
+
+		const u32 s = seq.load(std::memory_order_relaxed);
+		seq.store(s + 1, std::memory_order_relaxed); //neparan: upis u toku
+		std::atomic_thread_fence(std::memory_order_release);
+		for(size_t i = 0; i < WORDS; i++){
+			data[i].store(w[i], std::memory_order_relaxed);
+		}
+		seq.store(s + 2, std::memory_order_release);
+	}
+
+	//vraca broj upisa do procitane vrednosti, 0 ako store() jos nije pozvan
+	u32 load(T& v) const {
+		u64 w[WORDS];
+		u32 s;
+		for(;;){
+			s = seq.load(std::memory_order_acquire);
+			if(s & 1){
+				continue;
+			}
+			for(size_t i = 0; i < WORDS; i++){
+				w[i] = data[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(seq.load(std::memory_order_relaxed) == s){
+				break;
+			}
+		}
+		memcpy(&v, w, sizeof(T));
+		return s/2;
+	}
+
+private:
+	std::atomic<u32> seq;
+	std::atomic<u64> data[WORDS];
+};
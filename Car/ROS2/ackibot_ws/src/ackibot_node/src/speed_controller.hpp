@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "fw_pkgs.hpp"
+
+//Regulator brzine voznje na hostu: feed-forward + PI, sa anti-windup-om.
+//
+//Brzina se meri iz razlike enkodera izmedju dva uzorka (m_per_tick je
+//tick_to_rad*wheels.radius) i filtrira niskopropusnim filtrom, jer pri
+//maloj brzini u jednom uzorku ima tek par tikova. Izlaz je komanda za
+//firmware u opsegu pkg_m2s_t::speed, [-(MODULUS - 1), MODULUS - 1].
+//
+//Feed-forward target/max_speed*(MODULUS - 1) je isto sto i dosadasnja
+//komanda u otvorenoj petlji; PI ispravlja samo ono sto opterecenje,
+//nagib ili prazna baterija oduzmu. Integrator se ne puni dok je izlaz u
+//zasicenju u smeru greske (clamping), pa posle dugog zasicenja nema
+//prebacaja. Cilj 0 je stop: izlaz 0 i prazan integrator.
+class Speed_Controller {
+public:
+	struct Params {
+		double kp;			//komanda po m/s greske
+		double ki;			//komanda po m greske (m/s * s)
+		double max_speed;	//m/s pri komandi MODULUS - 1, za feed-forward
+		double tau_s;		//vremenska konstanta filtra merene brzine
+	};
+
+	static constexpr double U_MAX = MODULUS - 1;
+	//duze bez uzorka je prekid toka, brzina se meri ispocetka
+	static constexpr double MAX_DT_S = 0.5;
+
+	Speed_Controller(const Params& p, double m_per_tick)
+		: p(p),
+		m_per_tick(m_per_tick)
+	{
+		target = 0.0;
+		restart();
+	}
+
+	//posle prekida toka ili reseta firmware-a
+	void restart() {
+		have_sample = false;
+		last_enc = 0;
+		last_t_ns = 0;
+		v = 0.0;
+		u = 0.0;
+		integ = 0.0;
+	}
+
+	//zadata brzina u m/s
+	void set_target(double v_mps) {
+		target = v_mps;
+		if(target == 0.0){
+			integ = 0.0;
+		}
+	}
+
+	//komandu je preuzeo neko drugi (emergency stop, watchdog), pa
+	//integrator ne sme da se puni dok izlaz ne stize do motora
+	void hold() {
+		integ = 0.0;
+	}
+
+	//jedan uzorak enkodera; racuna novi izlaz
+	i16 update(i32 enc, i64 t_ns) {
+		const double dt = (t_ns - last_t_ns)*1e-9;
+		if(!have_sample || dt <= 0.0 || dt > MAX_DT_S){
+			have_sample = true;
+			last_enc = enc;
+			last_t_ns = t_ns;
+			return control(0.0);
+		}
+		const double v_raw = double(enc - last_enc)*m_per_tick/dt;
+		last_enc = enc;
+		last_t_ns = t_ns;
+		//skok enkodera (reset firmware-a) nije brzina
+		if(std::abs(v_raw) > 4.0*p.max_speed){
+			return control(0.0);
+		}
+		v += (v_raw - v)*dt/(p.tau_s + dt);
+		return control(dt);
+	}
+
+	i16 output() const {
+		return i16(std::lround(u));
+	}
+
+	//filtrirana izmerena brzina, m/s
+	double speed() const {
+		return v;
+	}
+
+	double get_target() const {
+		return target;
+	}
+
+private:
+	i16 control(double dt) {
+		if(target == 0.0){
+			integ = 0.0;
+			u = 0.0;
+			return 0;
+		}
+		const double ff = target/p.max_speed*U_MAX;
+		const double e = target - v;
+		const double pi = ff + p.kp*e + integ;
+		const bool saturated = (pi >= U_MAX && e > 0) || (pi <= -U_MAX && e < 0);
+		if(!saturated){
+			integ = std::clamp(integ + p.ki*e*dt, -U_MAX, U_MAX);
+		}
+		u = std::clamp(ff + p.kp*e + integ, -U_MAX, U_MAX);
+		return output();
+	}
+
+	Params p;
+	double m_per_tick;
+
+	double target;	//m/s
+	bool have_sample;
+	i32 last_enc;
+	i64 last_t_ns;
+	double v;		//m/s, filtrirano
+	double u;		//komanda
+	double integ;	//deo komande od I clana
+};
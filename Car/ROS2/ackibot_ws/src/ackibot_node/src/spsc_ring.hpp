@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+
+//Lock-free red za jednog pisca i jednog citaca (npr. read__loop -> executor).
+//push() zove samo pisac, pop() samo citac; nijedan ne ceka drugog.
+//Kad je red pun, push() vraca false i pisac odlucuje sta ce (broji gubitak).
+template<typename T, size_t N>
+class SPSC_Ring {
+	static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+	SPSC_Ring()
+		: head(0),
+		tail(0),
+		buf()
+	{
+	}
+
+	//pisac
+	bool push(const T& v) {
+		const size_t h = head.load(std::memory_order_relaxed);
+		if(h - tail.load(std::memory_order_acquire) == N){
+			return false;
+		}
+		buf[h & (N - 1)] = v;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	//citac
+	bool pop(T& v) {
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if(head.load(std::memory_order_acquire) == t){
+			return false;
+		}
+		v = buf[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	//priblizno, ako druga strana radi u isto vreme
+	size_t size() const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+	}
+
+	static constexpr size_t capacity() {
+		return N;
+	}
+
+private:
+	//svaki indeks u svojoj liniji kesa, da se pisac i citac ne ometaju
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+	alignas(64) T buf[N];
+};
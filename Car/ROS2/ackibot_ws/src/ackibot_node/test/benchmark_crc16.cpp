@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "CRC16.hpp"
+#include "fw_pkgs.hpp"
+
+//Mikro-benchmark CRC16 na hostu: originalna bit-po-bit petlja, tabela
+//bajt po bajt (ono sto radi firmver) i slice-by-8 (host), za payload
+//paketa i za veci blok. Rezultati moraju biti isti, vremena se samo ispisuju.
+
+namespace {
+
+constexpr size_t TOTAL_BYTES = 16 << 20;
+
+uint16_t crc16_bitwise(const uint8_t* data, size_t length) {
+	uint16_t crc = 0;
+	while(length--){
+		crc ^= *data++;
+		for(uint8_t i = 8; i; i--){
+			crc = (crc & 1) ? (crc >> 1) ^ CRC16_POLYNOME : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+uint16_t crc16_bytewise(const uint8_t* data, size_t length) {
+	CRC16 crc;
+	while(length--){
+		crc.add(*data++);
+	}
+	return crc.get_crc();
+}
+
+uint16_t crc16_slice8(const uint8_t* data, size_t length) {
+	return CRC16().add(data, length).get_crc();
+}
+
+//ns po bajtu; xor svih rezultata ide u sink da kompajler ne izbaci petlju
+template<typename F>
+double ns_per_byte(const std::vector<uint8_t>& data, size_t block, F&& crc, uint16_t& sink) {
+	const size_t blocks = data.size() / block;
+	const size_t rounds = TOTAL_BYTES / (blocks * block);
+	const auto start = std::chrono::steady_clock::now();
+	for(size_t r = 0; r < rounds; r++){
+		for(size_t b = 0; b < blocks; b++){
+			sink ^= crc(data.data() + b*block, block);
+		}
+	}
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (rounds * blocks * block);
+}
+
+void run(size_t block) {
+	std::mt19937 rng(7);
+	std::vector<uint8_t> data(4096 / block * block);
+	for(auto& b : data){
+		b = rng();
+	}
+
+	uint16_t bitwise_sink = 0;
+	uint16_t bytewise_sink = 0;
+	uint16_t slice8_sink = 0;
+	const double bitwise = ns_per_byte(data, block, crc16_bitwise, bitwise_sink);
+	const double bytewise = ns_per_byte(data, block, crc16_bytewise, bytewise_sink);
+	const double slice8 = ns_per_byte(data, block, crc16_slice8, slice8_sink);
+
+	std::printf(
+		"[ %4zu B ] bitwise %.3f ns/B, table %.3f ns/B (%.1fx), slice-by-8 %.3f ns/B (%.1fx)\n",
+		block, bitwise, bytewise, bitwise/bytewise, slice8, bitwise/slice8
+	);
+	EXPECT_EQ(bitwise_sink, bytewise_sink);
+	EXPECT_EQ(bitwise_sink, slice8_sink);
+}
+
+}
+
+TEST(CRC16Benchmark, PackagePayload) {
+	run(sizeof(pkg_s2m_t::payload));
+}
+
+TEST(CRC16Benchmark, Block4K) {
+	run(4096);
+}
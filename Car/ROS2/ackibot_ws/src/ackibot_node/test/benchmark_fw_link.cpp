@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <geometry_msgs/msg/twist_stamped.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/joint_state.hpp>
+
+#include "fw_emulator.hpp"
+#include "fw_node.hpp"
+
+//FW_Node na FW_Emulator-u, u jednom procesu: test publikuje cmd_vel kao
+//twist_mux i prati joint_states. Meri se:
+// - kasnjenje komande: od cmd_vel do prijema u firmware-u, i do prvog
+//   joint_states koji pokazuje zadato kretanje (potvrda nazad),
+// - oporavak: od kraja prekida veze do prvog joint_states, i od reseta
+//   MCU-a do ponovnog v2 (hello),
+// - procesorsko vreme hosta (proces bez niti emulatora), po sekundi.
+//Vrednosti se samo ispisuju, proverava se da veza radi i da se oporavlja.
+
+namespace {
+
+typedef FW_Emulator::Clock Clock;
+typedef geometry_msgs::msg::TwistStamped TwistStamped;
+typedef sensor_msgs::msg::JointState JointState;
+
+const auto CMD_PERIOD = std::chrono::milliseconds(50); // twist_mux na 20 Hz
+const int TRIALS = 20;
+
+double ms(Clock::duration d) {
+	return std::chrono::duration<double, std::milli>(d).count();
+}
+
+i64 process_cpu_ns() {
+	rusage u;
+	getrusage(RUSAGE_SELF, &u);
+	return (i64(u.ru_utime.tv_sec) + u.ru_stime.tv_sec)*1000000000
+		+ (i64(u.ru_utime.tv_usec) + u.ru_stime.tv_usec)*1000;
+}
+
+void report(const char* what, std::vector<double> v) {
+	ASSERT_FALSE(v.empty());
+	std::sort(v.begin(), v.end());
+	std::printf(
+		"[ %-24s ] median %7.2f ms, p95 %7.2f ms, max %7.2f ms (%zu)\n",
+		what,
+		v[v.size()/2],
+		v[std::min(v.size() - 1, v.size()*95/100)],
+		v.back(),
+		v.size()
+	);
+}
+
+class Rig {
+public:
+	Rig()
+		: Rig(FW_Emulator::Config())
+	{
+	}
+
+	explicit Rig(const FW_Emulator::Config& cfg)
+		: emu(cfg),
+		position(0.0),
+		last_joint_state(Clock::now())
+	{
+		EXPECT_TRUE(emu.open());
+		node = std::make_shared<FW_Node>(
+			rclcpp::NodeOptions().use_intra_process_comms(true),
+			emu.port()
+		);
+		probe = std::make_shared<rclcpp::Node>(
+			"benchmark_fw_link",
+			rclcpp::NodeOptions().use_intra_process_comms(true)
+		);
+		cmd_vel__pub = probe->create_publisher<TwistStamped>("cmd_vel", 1);
+		joint_state__sub = probe->create_subscription<JointState>(
+			"joint_states",
+			100,
+			[this](const JointState::ConstSharedPtr msg) {
+				position = msg->position[0];
+				last_joint_state = Clock::now();
+			}
+		);
+		exec.add_node(node);
+		exec.add_node(probe);
+	}
+
+	//vrti executor i salje cmd_vel na CMD_PERIOD dok done() ne vrati true;
+	//false ako je isteklo vreme
+	bool run(double speed, Clock::duration timeout, const std::function<bool()>& done) {
+		const Clock::time_point until = Clock::now() + timeout;
+		Clock::time_point next_cmd = Clock::now();
+		while(!done()){
+			const Clock::time_point now = Clock::now();
+			if(now >= until){
+				return false;
+			}
+			if(now >= next_cmd){
+				auto msg = std::make_unique<TwistStamped>();
+				msg->header.stamp = probe->now();
+				msg->twist.linear.x = speed;
+				cmd_vel__pub->publish(std::move(msg));
+				next_cmd = now + CMD_PERIOD;
+			}
+			exec.spin_once(std::chrono::milliseconds(5));
+		}
+		return true;
+	}
+
+	//stoji i joint_states vise ne menja polozaj
+	void stop() {
+		ASSERT_TRUE(run(0.0, std::chrono::seconds(2), [this]() {
+			return emu.stats().speed_i == 0;
+		}));
+		double prev = position;
+		Clock::time_point since = Clock::now();
+		ASSERT_TRUE(run(0.0, std::chrono::seconds(2), [&]() {
+			if(position != prev){
+				prev = position;
+				since = Clock::now();
+			}
+			return Clock::now() - since > std::chrono::milliseconds(150);
+		}));
+	}
+
+	//jedna komanda; vraca kasnjenje do firmware-a i do joint_states
+	void command(double speed, std::vector<double>& to_fw, std::vector<double>& to_ack) {
+		stop();
+		const double rest = position;
+		const Clock::time_point t0 = Clock::now();
+		Clock::time_point t_ack;
+		const bool ok = run(speed, std::chrono::seconds(2), [&]() {
+			if(speed > 0 ? position > rest : position < rest){
+				t_ack = Clock::now();
+				return true;
+			}
+			return false;
+		});
+		ASSERT_TRUE(ok);
+		to_fw.push_back(ms(emu.stats().speed_changed - t0));
+		to_ack.push_back(ms(t_ack - t0));
+	}
+
+	FW_Emulator emu; // nadzivi FW_Node, cija read nit cita sa njega
+	std::shared_ptr<FW_Node> node;
+	rclcpp::Node::SharedPtr probe;
+	rclcpp::Publisher<TwistStamped>::SharedPtr cmd_vel__pub;
+	rclcpp::Subscription<JointState>::SharedPtr joint_state__sub;
+	rclcpp::executors::SingleThreadedExecutor exec;
+	double position;
+	Clock::time_point last_joint_state;
+};
+
+void latency(const char* name, const FW_Emulator::Config& cfg) {
+	Rig rig(cfg);
+	//ceka v2 (hello), da se ne meri prelaz
+	ASSERT_TRUE(rig.run(0.0, std::chrono::seconds(3), [&]() {
+		return rig.emu.stats().proto_version == PKG_PROTOCOL_VERSION;
+	}));
+
+	std::vector<double> to_fw, to_ack;
+	for(int i = 0; i < TRIALS; i++){
+		rig.command(i % 2 ? -0.3 : 0.3, to_fw, to_ack);
+	}
+	std::printf("%s\n", name);
+	report("cmd_vel -> firmware", to_fw);
+	report("cmd_vel -> joint_states", to_ack);
+}
+
+}
+
+class FWLinkBenchmark : public ::testing::Test {
+protected:
+	static void SetUpTestSuite() {
+		rclcpp::init(0, nullptr);
+	}
+
+	static void TearDownTestSuite() {
+		rclcpp::shutdown();
+	}
+};
+
+TEST_F(FWLinkBenchmark, LatencyCleanLink) {
+	latency("clean link", FW_Emulator::Config());
+}
+
+TEST_F(FWLinkBenchmark, LatencyNoisyLink) {
+	FW_Emulator::Config cfg;
+	cfg.latency_ms = 2.0;
+	cfg.jitter_ms = 3.0;
+	cfg.byte_drop = 1e-3;
+	cfg.pkg_corrupt = 1e-2;
+	latency("2 ms + 3 ms jitter, 0.1 % bytes dropped, 1 % packages corrupted", cfg);
+}
+
+TEST_F(FWLinkBenchmark, Recovery) {
+	Rig rig;
+	ASSERT_TRUE(rig.run(0.3, std::chrono::seconds(3), [&]() {
+		return rig.emu.stats().proto_version == PKG_PROTOCOL_VERSION;
+	}));
+
+	//prekid veze: prvi joint_states posle kraja prekida
+	std::vector<double> blackout;
+	for(int i = 0; i < 5; i++){
+		const auto d = std::chrono::milliseconds(500);
+		rig.emu.blackout(d);
+		const Clock::time_point end = Clock::now() + d;
+		ASSERT_TRUE(rig.run(0.3, std::chrono::seconds(3), [&]() {
+			return rig.last_joint_state > end;
+		}));
+		blackout.push_back(ms(rig.last_joint_state - end));
+	}
+
+	//reset MCU-a: firmware se vraca na v1, FW_Node ponovo trazi v2
+	std::vector<double> reset;
+	for(int i = 0; i < 3; i++){
+		const Clock::time_point t0 = Clock::now();
+		rig.emu.reset();
+		ASSERT_TRUE(rig.run(0.3, std::chrono::seconds(3), [&]() {
+			return rig.emu.stats().proto_version == 1;
+		}));
+		ASSERT_TRUE(rig.run(0.3, std::chrono::seconds(3), [&]() {
+			return rig.emu.stats().proto_version == PKG_PROTOCOL_VERSION;
+		}));
+		reset.push_back(ms(Clock::now() - t0));
+	}
+
+	report("blackout end -> data", blackout);
+	report("MCU reset -> v2", reset);
+}
+
+TEST_F(FWLinkBenchmark, HostCpu) {
+	Rig rig;
+	ASSERT_TRUE(rig.run(0.3, std::chrono::seconds(3), [&]() {
+		return rig.emu.stats().proto_version == PKG_PROTOCOL_VERSION;
+	}));
+
+	const i64 cpu0 = process_cpu_ns() - rig.emu.stats().cpu_ns;
+	const Clock::time_point t0 = Clock::now();
+	const u32 tx0 = rig.emu.stats().tx_pkgs;
+	rig.run(0.3, std::chrono::seconds(5), []() {
+		return false;
+	});
+	const double wall = ms(Clock::now() - t0);
+	const double cpu = (process_cpu_ns() - rig.emu.stats().cpu_ns - cpu0)/1e6;
+	const u32 pkgs = rig.emu.stats().tx_pkgs - tx0;
+
+	std::printf(
+		"[ host CPU                 ] %.2f %% of one core, %.1f us per package (%u packages)\n",
+		100.0*cpu/wall,
+		1e3*cpu/pkgs,
+		pkgs
+	);
+	EXPECT_GT(pkgs, 0u);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <cmath>
+#include <random>
+
+#include "ackermann_odometry.hpp"
+
+//Ackermann_Odometry: tacnost RK4 na kruznici sa krupnim korakom i
+//kovarijansa u odnosu na Monte Carlo istog modela sa sumom na ulazima.
+
+namespace {
+
+const Ackermann_Odometry::Params PARAMS = {0.32, 0.02, 0.01, 0.005};
+
+//isti korak kao pre ovog modela: pravac u sredini koraka, Euler po putu
+void euler(double& x, double& y, double& th, double ds, double delta) {
+	const double dth = ds*std::tan(delta)/PARAMS.wheelbase;
+	x += ds*std::cos(th + 0.5*dth);
+	y += ds*std::sin(th + 0.5*dth);
+	th += dth;
+}
+
+} // namespace
+
+TEST(AckermannOdometry, Straight) {
+	Ackermann_Odometry o(PARAMS);
+	for(int i = 0; i < 100; i++){
+		o.step(0.01, 0.0, 0.0);
+	}
+	EXPECT_NEAR(o.get_pose()[0], 1.0, 1e-12);
+	EXPECT_EQ(o.get_pose()[1], 0.0);
+	EXPECT_EQ(o.get_pose()[2], 0.0);
+	//sum puta raste sa putem, a bocna greska dolazi samo od ugla
+	EXPECT_NEAR(o.covariance()[0][0], PARAMS.distance_noise*PARAMS.distance_noise*1.0, 1e-12);
+	EXPECT_EQ(o.covariance()[0][1], 0.0);
+	EXPECT_EQ(o.covariance()[0][2], 0.0);
+	EXPECT_GT(o.covariance()[1][1], 0.0);
+	EXPECT_DOUBLE_EQ(o.delta_s(), 0.01);
+}
+
+TEST(AckermannOdometry, CircleWithCoarseSteps) {
+	//cetvrt kruga poluprecnika 1 m u 5 koraka, skretanje pre polaska
+	const double delta = std::atan(PARAMS.wheelbase/1.0);
+	const double ds = M_PI/2/5;
+	Ackermann_Odometry o(PARAMS);
+	double x = 0, y = 0, th = 0;
+	o.step(0.0, 0.0, delta);
+	for(int i = 0; i < 5; i++){
+		o.step(ds, delta, delta);
+		euler(x, y, th, ds, delta);
+	}
+	EXPECT_NEAR(o.get_pose()[0], 1.0, 1e-4);
+	EXPECT_NEAR(o.get_pose()[1], 1.0, 1e-4);
+	EXPECT_NEAR(o.get_pose()[2], M_PI/2, 1e-9);
+	EXPECT_NEAR(o.delta_theta(), ds, 1e-9);
+
+	//pravac iz sredine koraka ide po tetivama, pa krug ispadne manji
+	EXPECT_GT(std::hypot(x - 1.0, y - 1.0), 5e-3);
+}
+
+TEST(AckermannOdometry, SteeringRamp) {
+	//ugao skretanja raste linearno duz puta: tacan ugao je integral krivine
+	Ackermann_Odometry fine(PARAMS), coarse(PARAMS);
+	const int N = 1000;
+	const double len = 1.0;
+	const double max_delta = 0.4;
+	for(int i = 0; i < N; i++){
+		fine.step(len/N, max_delta*i/N, max_delta*(i + 1)/N);
+	}
+	for(int i = 0; i < 10; i++){
+		coarse.step(len/10, max_delta*i/10, max_delta*(i + 1)/10);
+	}
+	for(int i = 0; i < 3; i++){
+		EXPECT_NEAR(coarse.get_pose()[i], fine.get_pose()[i], 1e-4) << i;
+	}
+}
+
+TEST(AckermannOdometry, ImuHeading) {
+	Ackermann_Odometry o(PARAMS);
+	const double ds = 2*M_PI/20;
+	for(int i = 0; i < 20; i++){
+		o.step_heading(ds, ds);
+	}
+	EXPECT_NEAR(o.get_pose()[0], 0.0, 1e-3);
+	EXPECT_NEAR(o.get_pose()[1], 0.0, 1e-3);
+	//bez ugla skretanja ugao nosi samo sum IMU-a
+	EXPECT_NEAR(o.covariance()[2][2], 20*PARAMS.heading_noise*PARAMS.heading_noise, 1e-12);
+}
+
+TEST(AckermannOdometry, CovarianceMatchesMonteCarlo) {
+	//luk od 2 m sa skretanjem, u 50 koraka
+	const int STEPS = 50;
+	const double ds = 0.04;
+	const double delta = 0.3;
+	Ackermann_Odometry ref(PARAMS);
+	for(int i = 0; i < STEPS; i++){
+		ref.step(ds, delta, delta);
+	}
+
+	std::mt19937 rng(1);
+	std::normal_distribution<double> n(0.0, 1.0);
+	const int RUNS = 4000;
+	double mean[3] = {0, 0, 0};
+	double m2[3][3] = {};
+	for(int r = 0; r < RUNS; r++){
+		Ackermann_Odometry o(PARAMS);
+		for(int i = 0; i < STEPS; i++){
+			const double d = delta + PARAMS.steering_noise*n(rng);
+			o.step(ds + PARAMS.distance_noise*std::sqrt(ds)*n(rng), d, d);
+		}
+		for(int i = 0; i < 3; i++){
+			const double e_i = o.get_pose()[i] - ref.get_pose()[i];
+			mean[i] += e_i/RUNS;
+			for(int j = 0; j < 3; j++){
+				m2[i][j] += e_i*(o.get_pose()[j] - ref.get_pose()[j])/RUNS;
+			}
+		}
+	}
+	for(int i = 0; i < 3; i++){
+		const double sd_i = std::sqrt(ref.covariance()[i][i]);
+		EXPECT_NEAR(std::sqrt(m2[i][i]), sd_i, 0.1*sd_i) << i;
+		for(int j = 0; j < 3; j++){
+			//korelacija, nezavisno od razmera
+			const double rho = ref.covariance()[i][j]
+				/std::sqrt(ref.covariance()[i][i]*ref.covariance()[j][j]);
+			const double rho_mc = m2[i][j]/std::sqrt(m2[i][i]*m2[j][j]);
+			EXPECT_NEAR(rho, rho_mc, 0.1) << i << j;
+		}
+	}
+}
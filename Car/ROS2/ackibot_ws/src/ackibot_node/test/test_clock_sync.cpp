@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <cmath>
+#include <random>
+
+#include "clock_sync.hpp"
+
+//Clock_Sync sa simuliranim MCU-om: casovnik MCU-a zuri ili kasni,
+//a paket do hosta stize sa slucajnim kasnjenjem (najmanje 1 ms).
+
+namespace {
+
+struct Link {
+	explicit Link(double drift_ppm, u32 seed = 1)
+		: drift(drift_ppm*1e-6), rng(seed), tail(1.0/1.5e6) {}
+
+	//vreme MCU-a (us) u trenutku host_true_ns
+	i64 mcu_us(i64 host_true_ns) const {
+		return i64(std::llround(host_true_ns*(1 + drift)/1000.0)) + 123456789;
+	}
+
+	//vreme prijema: 1 ms + eksponencijalni rep sa srednjom vrednoscu 1.5 ms
+	i64 arrival_ns(i64 host_true_ns) {
+		return host_true_ns + 1000000 + i64(tail(rng));
+	}
+
+	double drift;
+	std::mt19937 rng;
+	std::exponential_distribution<double> tail;
+};
+
+const i64 PERIOD_NS = 40960000; // jedna serija v2 paketa
+
+} // namespace
+
+TEST(ClockSync, NominalUntilEnoughPairs) {
+	Clock_Sync c;
+	c.add(1000, 5000000);
+	c.add(2000, 6000000 + 300000);
+	EXPECT_EQ(c.ns_per_us(), 1000.0);
+	//pomeraj je najmanje kasnjenje
+	EXPECT_EQ(c.to_host_ns(1000), 5000000);
+	EXPECT_EQ(c.to_host_ns(3000), 7000000);
+}
+
+TEST(ClockSync, TracksDrift) {
+	for(double drift_ppm : {-5000.0, -100.0, 0.0, 300.0, 5000.0}){
+		Clock_Sync c;
+		Link link(drift_ppm);
+		i64 t = 1000000000;
+		for(size_t i = 0; i < Clock_Sync::WINDOW; i++, t += PERIOD_NS){
+			c.add(link.mcu_us(t), link.arrival_ns(t));
+		}
+		EXPECT_NEAR(c.drift_ppm(), drift_ppm, 30.0) << drift_ppm;
+
+		//preslikano vreme uzorka je blizu stvarnog plus 1 ms najmanjeg kasnjenja
+		const i64 err = c.to_host_ns(link.mcu_us(t)) - (t + 1000000);
+		EXPECT_LT(std::abs(err), 300000) << drift_ppm;
+	}
+}
+
+TEST(ClockSync, RemovesArrivalJitter) {
+	Clock_Sync c;
+	Link link(2000.0, 3);
+	i64 t = 0;
+	i64 prev_arrival = 0;
+	i64 prev_mapped = 0;
+	double jitter_arrival = 0;
+	double jitter_mapped = 0;
+	int n = 0;
+	for(int i = 0; i < 1000; i++, t += PERIOD_NS){
+		const i64 mcu = link.mcu_us(t);
+		const i64 arrival = link.arrival_ns(t);
+		c.add(mcu, arrival);
+		const i64 mapped = c.to_host_ns(mcu);
+		if(i > int(Clock_Sync::WINDOW)){
+			jitter_arrival += std::abs(double(arrival - prev_arrival - PERIOD_NS));
+			jitter_mapped += std::abs(double(mapped - prev_mapped - PERIOD_NS));
+			n++;
+		}
+		prev_arrival = arrival;
+		prev_mapped = mapped;
+	}
+	jitter_arrival /= n;
+	jitter_mapped /= n;
+	//razmak prijema skace za ~1.5 ms, preslikano vreme za par us
+	EXPECT_GT(jitter_arrival, 1e6);
+	EXPECT_LT(jitter_mapped, 50e3);
+}
+
+TEST(ClockSync, IgnoresImplausibleSlope) {
+	Clock_Sync c;
+	for(int i = 0; i < 64; i++){
+		//host vreme ide duplo brze, npr. pogresno odmotan brojac
+		c.add(i*40960, i64(i)*2*40960000);
+	}
+	EXPECT_EQ(c.ns_per_us(), 1000.0);
+}
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <random>
+
+#include "collision_brake.hpp"
+
+//Range_Filter i Collision_Brake na skriptovanim prilazima prepreci.
+//
+//Simulacija: auto prati komandu uz ograniceno ubrzanje i kocenje, komanda
+//stize do motora sa kasnjenjem. Senzor meri na RANGE_PERIOD (kao
+//firmware), uz sum, povremene pogresne echo-e i echo-e koji ne stignu (0),
+//a paket telemetrije nosi poslednje merenje i broj merenja na svakih
+//PKG_PERIOD.
+
+namespace {
+
+const i64 MS = 1000000;
+const i64 STEP_NS = 10*MS;
+const i64 RANGE_PERIOD_NS = 60*MS;
+const i64 PKG_PERIOD_NS = 40*MS;
+const i64 CMD_DELAY_NS = 80*MS;
+
+struct Sim {
+	//obstacle(t_s): polozaj prepreke u m, auto krece iz 0
+	Sim(std::function<double(double)> obstacle, u32 seed = 1)
+		: obstacle(obstacle), rng(seed), noise(0.0, 0.01), u(0.0, 1.0),
+		t_ns(0), x(0.0), v(0.0), held(0.0), min_gap(1e9), outliers(0.0) {}
+
+	double gap() const {
+		return obstacle(t_ns*1e-9) - x;
+	}
+
+	//vozi dok ne istekne s sekundi; policy vraca komandu iz poslednjeg merenja
+	void run(double s, double target, const std::function<double(double, u16)>& policy) {
+		for(i64 end = t_ns + i64(s*1e9); t_ns < end; t_ns += STEP_NS){
+			if(t_ns % RANGE_PERIOD_NS == 0){
+				held = measure();
+				cnt++;
+			}
+			if(t_ns % PKG_PERIOD_NS == 0){
+				cmds.push_back(std::min(target, policy(held, cnt)));
+			}
+			if(cmds.size()*PKG_PERIOD_NS > size_t(CMD_DELAY_NS)){
+				cmd = cmds.front();
+				cmds.pop_front();
+			}
+			//kocnica jaca od profila, ubrzanje slabije
+			const double dt = STEP_NS*1e-9;
+			v = std::clamp(cmd, v - 3.0*dt, v + 1.0*dt);
+			x += v*dt;
+			min_gap = std::min(min_gap, gap());
+		}
+	}
+
+	double measure() {
+		const double p = u(rng);
+		if(p < outliers){
+			return 0.0; // echo nije stigao
+		}
+		if(p < 2*outliers){
+			return 0.05 + 3.0*u(rng); // pogresan echo
+		}
+		const double g = gap();
+		return g < 4.0 ? g + noise(rng) : 0.0;
+	}
+
+	std::function<double(double)> obstacle;
+	std::mt19937 rng;
+	std::normal_distribution<double> noise;
+	std::uniform_real_distribution<double> u;
+
+	i64 t_ns;
+	double x;
+	double v;
+	double held;	//poslednje merenje senzora
+	u16 cnt = 0;	//broj merenja, kao Echo_Ranger::measurements
+	double cmd = 0.0;
+	std::deque<double> cmds;
+	double min_gap;
+	double outliers; //verovatnoca za 0 i za pogresan echo, svaka
+};
+
+//Collision_Brake kao u FW_Node: novo merenje iz paketa, limit brzine napred
+struct Brake_Policy {
+	double operator()(double z, u16 cnt) {
+		if(seq.fresh(cnt)){
+			filter.update(t_ns, z);
+			brake.update(filter);
+		}
+		t_ns += PKG_PERIOD_NS;
+		return std::min(1e9, brake.speed_limit());
+	}
+
+	Range_Sequence seq;
+	Range_Filter filter;
+	Collision_Brake brake;
+	i64 t_ns = 0;
+};
+
+//stari nacin: stop napred kad je sirovo merenje izmedju 0.1 i 20 cm
+double old_policy(double z, u16) {
+	return z*100 > 0.1 && z*100 < 20.0 ? 0.0 : 1e9;
+}
+
+} // namespace
+
+TEST(RangeFilter, TracksApproachRate) {
+	Range_Filter f;
+	std::mt19937 rng(3);
+	std::normal_distribution<double> noise(0.0, 0.01);
+	for(int i = 0; i < 50; i++){
+		const double t = i*0.04;
+		f.update(i64(t*1e9), 3.0 - 0.8*t + noise(rng));
+	}
+	EXPECT_NEAR(f.rate(), -0.8, 0.1);
+	EXPECT_NEAR(f.range(), 3.0 - 0.8*49*0.04, 0.03);
+}
+
+//paketi na 41 ms nose merenja na 60 ms: ponovljeno merenje filter vidi kao
+//prepreku koja stoji, pa brzina posle pocetka kasni ka nuli
+TEST(RangeFilter, RepeatedSamples) {
+	const i64 pkg_ns = 41*MS;
+	Range_Filter all;
+	Range_Filter fresh;
+	Range_Sequence seq;
+	double z = 0.0;
+	u16 cnt = 0;
+	int pkgs = 0;
+	double fresh_min = 0.0;
+	double fresh_max = -1.0;
+	for(i64 t = 0, next = 0; t < 3000*MS; t += pkg_ns, pkgs++){
+		for(; next <= t; next += RANGE_PERIOD_NS){
+			z = 3.0 - 0.5*next*1e-9;
+			cnt++;
+		}
+		all.update(t, z);
+		if(seq.fresh(cnt)){
+			fresh.update(t, z);
+		}
+		if(pkgs == 4){
+			EXPECT_NEAR(fresh.rate(), -0.5, 0.1);
+			EXPECT_GT(all.rate(), -0.35);
+		}
+		if(t >= 1000*MS){
+			fresh_min = std::min(fresh_min, fresh.rate());
+			fresh_max = std::max(fresh_max, fresh.rate());
+		}
+	}
+	//ostatak je trzanje vremena paketa u odnosu na merenje
+	EXPECT_GT(fresh_min, -0.56);
+	EXPECT_LT(fresh_max, -0.48);
+
+	//isti brojac dva puta zaredom nije novo merenje, posle reseta jeste
+	EXPECT_FALSE(seq.fresh(cnt));
+	seq.reset();
+	EXPECT_TRUE(seq.fresh(cnt));
+}
+
+TEST(RangeFilter, RejectsOutliers) {
+	Range_Filter f;
+	for(int i = 0; i < 20; i++){
+		const double z = i == 10 ? 0.3 : (i == 15 ? 3.9 : 2.0);
+		f.update(i*40*MS, z);
+	}
+	EXPECT_EQ(f.outliers, 2u);
+	EXPECT_NEAR(f.range(), 2.0, 1e-6);
+	EXPECT_NEAR(f.rate(), 0.0, 1e-6);
+
+	//echo koji ne stigne se ignorise
+	f.update(20*40*MS, 0.0);
+	EXPECT_TRUE(f.valid());
+	EXPECT_NEAR(f.range(), 2.0, 1e-6);
+}
+
+TEST(RangeFilter, FollowsRealJumpAndClear) {
+	Range_Filter f;
+	i64 t = 0;
+	for(int i = 0; i < 10; i++, t += 40*MS){
+		f.update(t, 3.0);
+	}
+	//prepreka uleti ispred: posle max_rejects merenja filter je prihvata
+	for(int i = 0; i < 3; i++, t += 40*MS){
+		f.update(t, 0.8);
+	}
+	EXPECT_NEAR(f.range(), 0.8, 1e-6);
+	EXPECT_EQ(f.rate(), 0.0);
+
+	//i ode: bez echo-a nema prepreke
+	for(int i = 0; i < 3; i++, t += 40*MS){
+		f.update(t, 0.0);
+	}
+	EXPECT_FALSE(f.valid());
+	Collision_Brake b;
+	b.update(f);
+	EXPECT_EQ(b.speed_limit(), Collision_Brake::NONE);
+}
+
+TEST(CollisionBrake, ProfileAndTtc) {
+	Collision_Brake b;
+	Range_Filter f;
+	//prepreka stoji 1.2 m ispred, auto stoji: limit po profilu
+	f.update(0, 1.2);
+	f.update(40*MS, 1.2);
+	b.update(f);
+	EXPECT_NEAR(b.speed_limit(), std::sqrt(2*1.5*(1.2 - 0.2)), 1e-9);
+	EXPECT_EQ(b.ttc(), Collision_Brake::NONE);
+
+	//ista prepreka prilazi 3 m/s: ttc ~0.3 s, odmah stop
+	Range_Filter g;
+	g.update(0, 1.2);
+	g.update(40*MS, 1.2 - 0.12);
+	b.update(g);
+	EXPECT_NEAR(b.ttc(), (1.08 - 0.2)/3.0, 1e-6);
+	EXPECT_EQ(b.speed_limit(), 0.0);
+
+	//blize od margin: stop
+	Range_Filter h;
+	h.update(0, 0.15);
+	b.update(h);
+	EXPECT_EQ(b.speed_limit(), 0.0);
+}
+
+TEST(CollisionBrake, StopsBeforeWall) {
+	for(double target : {0.3, 0.6, 0.9}){
+		Sim sim([](double) { return 3.0; });
+		sim.outliers = 0.03;
+		Brake_Policy policy;
+		sim.run(15.0, target, std::ref(policy));
+		EXPECT_EQ(sim.v, 0.0) << target;
+		EXPECT_GT(sim.min_gap, 0.1) << target;
+		EXPECT_LT(sim.gap(), 0.3) << target;
+	}
+}
+
+TEST(CollisionBrake, OldThresholdIsTooLate) {
+	Sim sim([](double) { return 3.0; });
+	sim.run(8.0, 0.9, old_policy);
+	EXPECT_LT(sim.min_gap, 0.05);
+}
+
+TEST(CollisionBrake, ApproachingObstacle) {
+	//prepreka ide ka autu 0.5 m/s i staje 2.5 m od starta
+	Sim sim([](double t) { return std::max(2.5, 4.0 - 0.5*t); });
+	sim.outliers = 0.03;
+	Brake_Policy policy;
+	sim.run(15.0, 0.5, std::ref(policy));
+	EXPECT_EQ(sim.v, 0.0);
+	EXPECT_GT(sim.min_gap, 0.1);
+	EXPECT_LT(sim.gap(), 0.3);
+}
+
+TEST(CollisionBrake, BlindZoneKeepsObstacle) {
+	Range_Filter f;
+	i64 t = 0;
+	for(int i = 0; i < 5; i++, t += 40*MS){
+		f.update(t, 0.15);
+	}
+	//preblizu, echo se ne vraca
+	for(int i = 0; i < 10; i++, t += 40*MS){
+		f.update(t, 0.0);
+	}
+	EXPECT_TRUE(f.valid());
+	Collision_Brake b;
+	b.update(f);
+	EXPECT_EQ(b.speed_limit(), 0.0);
+}
+
+TEST(CollisionBrake, FollowsWithoutBraking) {
+	//prepreka 1.5 m ispred ide istom brzinom: nema kocenja
+	Sim sim([](double t) { return 1.5 + 0.5*t; });
+	Brake_Policy policy;
+	sim.run(1.0, 0.5, std::ref(policy));
+	sim.run(3.0, 0.5, std::ref(policy));
+	EXPECT_NEAR(sim.v, 0.5, 1e-9);
+	EXPECT_GT(sim.min_gap, 1.2);
+}
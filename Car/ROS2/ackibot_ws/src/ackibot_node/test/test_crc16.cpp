@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "CRC16.hpp"
+#include "fw_pkgs.hpp"
+
+//Test vektori za CRC-16/ARC i poredjenje tabelarne i slice-by-8 verzije
+//sa originalnom bit-po-bit petljom (referenca, ista kao pre tabela).
+
+namespace {
+
+uint16_t crc16_bitwise(const uint8_t* data, size_t length, uint16_t crc = 0) {
+	while(length--){
+		crc ^= *data++;
+		for(uint8_t i = 8; i; i--){
+			crc = (crc & 1) ? (crc >> 1) ^ CRC16_POLYNOME : crc >> 1;
+		}
+	}
+	return crc;
+}
+
+uint16_t crc16_of(const char* s) {
+	return CRC16().add(reinterpret_cast<const uint8_t*>(s), strlen(s)).get_crc();
+}
+
+std::vector<uint8_t> random_bytes(size_t n, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::vector<uint8_t> v(n);
+	for(auto& b : v){
+		b = rng();
+	}
+	return v;
+}
+
+}
+
+//Poznate vrednosti CRC-16/ARC (check = CRC("123456789")).
+TEST(CRC16, KnownVectors) {
+	EXPECT_EQ(0x0000, CRC16().get_crc());
+	EXPECT_EQ(0x0000, crc16_of(""));
+	EXPECT_EQ(0xbb3d, crc16_of("123456789"));
+	EXPECT_EQ(0x30c0, crc16_of("A"));
+	EXPECT_EQ(0x0000, CRC16().add(uint8_t(0)).get_crc());
+	EXPECT_EQ(0x4040, CRC16().add(uint8_t(0xff)).get_crc());
+}
+
+//Tabela je generisana iz polinoma: T[0][i] je CRC jednog bajta i.
+TEST(CRC16, TableMatchesPolynome) {
+	for(int i = 0; i < 256; i++){
+		const uint8_t b = i;
+		ASSERT_EQ(crc16_bitwise(&b, 1), crc16_table[0][i]) << i;
+	}
+	//T[k][i] je CRC bajta i iza kog sledi k nula
+	for(int k = 1; k < 8; k++){
+		for(int i = 0; i < 256; i++){
+			uint8_t buf[8] = {uint8_t(i)};
+			ASSERT_EQ(crc16_bitwise(buf, k + 1), crc16_table[k][i]) << k << " " << i;
+		}
+	}
+}
+
+//Sve duzine (i ostatak posle blokova od 8 bajtova) i neporavnati poceci.
+TEST(CRC16, SliceBy8MatchesBitwise) {
+	const auto data = random_bytes(300, 1);
+	for(size_t offset = 0; offset < 8; offset++){
+		for(size_t length = 0; length + offset <= data.size(); length += 1 + length/16){
+			ASSERT_EQ(
+				crc16_bitwise(data.data() + offset, length),
+				CRC16().add(data.data() + offset, length).get_crc()
+			) << "offset " << offset << " length " << length;
+		}
+	}
+}
+
+//Racunanje u delovima daje isto kao odjednom.
+TEST(CRC16, IncrementalMatchesWhole) {
+	const auto data = random_bytes(1000, 2);
+	std::mt19937 rng(3);
+	CRC16 crc;
+	for(size_t i = 0; i < data.size(); ){
+		const size_t n = std::min<size_t>(rng() % 23, data.size() - i);
+		if(n == 1){
+			crc.add(data[i]);
+		}else{
+			crc.add(data.data() + i, n);
+		}
+		i += n;
+	}
+	EXPECT_EQ(crc16_bitwise(data.data(), data.size()), crc.get_crc());
+}
+
+//Paketi izmedju firmvera i hosta.
+TEST(CRC16, Packages) {
+	pkg_s2m_t p;
+	memset(&p, 0, sizeof(p));
+	p.magic = PKG_MAGIC;
+	p.payload.enc = -123456;
+	p.payload.speed_i = 2047;
+	p.payload.steering_angle_o = 90;
+	p.payload.ultrasound_pulse = 5831;
+	EXPECT_EQ(
+		crc16_bitwise(reinterpret_cast<const uint8_t*>(&p.payload), sizeof(p.payload)),
+		CRC16().add(p.payload).get_crc()
+	);
+
+	pkg_m2s_t m;
+	m.payload.speed = -1000;
+	m.payload.steering_angle = 45;
+	EXPECT_EQ(
+		crc16_bitwise(reinterpret_cast<const uint8_t*>(&m.payload), sizeof(m.payload)),
+		CRC16().add(m.payload).get_crc()
+	);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include "echo_ranger.hpp"
+
+//Echo_Ranger iz firmware-a (Car/FW/Arduino_Motor_Controller) sa izmisljenim
+//vremenima ivica, umesto micros() i prekida na echo pinu.
+
+namespace {
+
+const u32 TIMEOUT_US = 30000;
+
+//trigger u t, echo pocinje posle 450 us i traje pulse us
+void echo(Echo_Ranger& r, u32 t, u32 pulse) {
+	r.start(t);
+	r.poll(t + 100);
+	r.edge(true, t + 450);
+	r.poll(t + 450 + pulse/2);
+	r.edge(false, t + 450 + pulse);
+}
+
+} // namespace
+
+TEST(EchoRanger, MeasuresPulse) {
+	Echo_Ranger r(TIMEOUT_US);
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.pulse_us(), 0u);
+
+	echo(r, 1000, 1166); // ~20 cm
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.pulse_us(), 1166u);
+	EXPECT_EQ(r.measurements, 1u);
+	EXPECT_EQ(r.timeouts, 0u);
+}
+
+TEST(EchoRanger, KeepsLastWhileMeasuring) {
+	Echo_Ranger r(TIMEOUT_US);
+	echo(r, 0, 5000);
+
+	//send_pkg() za vreme novog merenja salje prethodno
+	r.start(60000);
+	EXPECT_EQ(r.get_state(), Echo_Ranger::WAIT_RISE);
+	EXPECT_EQ(r.pulse_us(), 5000u);
+	r.edge(true, 60400);
+	EXPECT_EQ(r.get_state(), Echo_Ranger::WAIT_FALL);
+	EXPECT_EQ(r.pulse_us(), 5000u);
+	r.edge(false, 60400 + 700);
+	EXPECT_EQ(r.pulse_us(), 700u);
+}
+
+TEST(EchoRanger, NoEchoTimesOut) {
+	Echo_Ranger r(TIMEOUT_US);
+	echo(r, 0, 1000);
+
+	r.start(100000);
+	r.poll(100000 + TIMEOUT_US);
+	EXPECT_FALSE(r.idle()); //granica je ukljucena
+	r.poll(100000 + TIMEOUT_US + 4);
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.pulse_us(), 0u);
+	EXPECT_EQ(r.timeouts, 1u);
+	EXPECT_EQ(r.measurements, 2u);
+}
+
+TEST(EchoRanger, EchoTooLongTimesOut) {
+	Echo_Ranger r(TIMEOUT_US);
+	r.start(0);
+	r.edge(true, 500);
+	r.poll(500 + TIMEOUT_US + 4); //bez prepreke echo traje ~38 ms
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.pulse_us(), 0u);
+
+	//kasna silazna ivica ne menja rezultat
+	r.edge(false, 500 + 38000);
+	EXPECT_EQ(r.pulse_us(), 0u);
+	EXPECT_EQ(r.measurements, 1u);
+}
+
+TEST(EchoRanger, IgnoresStrayEdges) {
+	Echo_Ranger r(TIMEOUT_US);
+
+	//ivice bez merenja
+	r.edge(true, 10);
+	r.edge(false, 20);
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.measurements, 0u);
+
+	r.start(1000);
+	r.edge(false, 1100); //kraj starog impulsa
+	EXPECT_EQ(r.get_state(), Echo_Ranger::WAIT_RISE);
+	r.edge(true, 1500);
+	r.edge(true, 1600); //isti nivo, drugi pin porta B
+	r.edge(false, 2500);
+	EXPECT_EQ(r.pulse_us(), 1000u);
+	EXPECT_EQ(r.measurements, 1u);
+}
+
+TEST(EchoRanger, MicrosWrap) {
+	Echo_Ranger r(TIMEOUT_US);
+	echo(r, 0xffffffffu - 700, 2000);
+	EXPECT_EQ(r.pulse_us(), 2000u);
+
+	r.start(0xffffffffu - 10);
+	r.poll(5);
+	EXPECT_FALSE(r.idle());
+	r.poll(TIMEOUT_US);
+	EXPECT_TRUE(r.idle());
+	EXPECT_EQ(r.pulse_us(), 0u);
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <vector>
+
+#include "fw_emulator.hpp"
+#include "pkg_framer.hpp"
+
+//FW_Emulator sa strane hosta: komande se pisu na slave kraj pseudo-terminala,
+//a telemetrija se cita istim Pkg_Framer-om kao u FW_Node.
+
+namespace {
+
+typedef FW_Emulator::Clock Clock;
+
+class Host {
+public:
+	explicit Host(const std::string& port) {
+		fd = open(port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+		termios t;
+		tcgetattr(fd, &t);
+		cfmakeraw(&t);
+		tcsetattr(fd, TCSANOW, &t);
+	}
+
+	~Host() {
+		close(fd);
+	}
+
+	void cmd(i16 speed, i16 steering_angle) {
+		pkg_m2s_t p;
+		p.magic = PKG_MAGIC;
+		p.payload.speed = speed;
+		p.payload.steering_angle = steering_angle;
+		p.crc = CRC16().add(p.payload).get_crc();
+		put(p);
+	}
+
+	void hello(u8 version) {
+		pkg_hello_t p;
+		p.magic = PKG_HELLO_MAGIC;
+		p.payload.version = version;
+		p.crc = CRC16().add(p.payload).get_crc();
+		put(p);
+	}
+
+	//sledeci paket, PKG_NONE ako ga nema do isteka timeout-a
+	pkg_kind_t next(pkg_s2m_any_t& p, Clock::duration timeout = std::chrono::milliseconds(500)) {
+		const Clock::time_point until = Clock::now() + timeout;
+		for(;;){
+			const pkg_kind_t kind = framer.next(p);
+			if(kind != PKG_NONE){
+				return kind;
+			}
+			const Clock::time_point now = Clock::now();
+			if(now >= until){
+				return PKG_NONE;
+			}
+			pollfd pfd = {fd, POLLIN, 0};
+			const int ms = int(std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count()) + 1;
+			if(poll(&pfd, 1, ms) > 0){
+				size_t len;
+				u8* dst = framer.write_ptr(len);
+				const ssize_t r = read(fd, dst, len);
+				if(r > 0){
+					framer.commit(r);
+				}
+			}
+		}
+	}
+
+	//prima pakete tokom d, vraca ih po vrstama
+	void drain(Clock::duration d, u32& v1, u32& v2) {
+		const Clock::time_point until = Clock::now() + d;
+		v1 = v2 = 0;
+		pkg_s2m_any_t p;
+		for(Clock::time_point now; (now = Clock::now()) < until;){
+			const pkg_kind_t kind = next(p, until - now);
+			v1 += kind == PKG_S2M_V1;
+			v2 += kind == PKG_S2M_V2;
+		}
+	}
+
+	Pkg_Framer<> framer;
+
+private:
+	template<typename T>
+	void put(const T& p) {
+		ASSERT_EQ(write(fd, &p, sizeof(p)), ssize_t(sizeof(p)));
+	}
+
+	int fd;
+};
+
+} // namespace
+
+TEST(FWEmulator, V1EchoesCommand) {
+	FW_Emulator emu;
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	host.cmd(1000, 45);
+	pkg_s2m_any_t p;
+	i32 enc = 0;
+	bool acked = false;
+	for(int i = 0; i < 10 && !acked; i++){
+		ASSERT_EQ(host.next(p), PKG_S2M_V1);
+		acked = p.v1.payload.speed_i == 1000;
+		enc = p.v1.payload.enc;
+	}
+	ASSERT_TRUE(acked);
+	EXPECT_EQ(p.v1.payload.steering_angle_i, 45);
+	EXPECT_EQ(p.v1.payload.ultrasound_pulse, u32(100.0f*2.0f/0.0343f));
+
+	//enkoder broji i izmedju dva paketa
+	FW_Emulator::Config cfg;
+	ASSERT_EQ(host.next(p), PKG_S2M_V1);
+	EXPECT_NEAR(
+		p.v1.payload.enc - enc,
+		1000.0/(MODULUS - 1)*cfg.enc_ticks_per_s/FW_Emulator::SENSOR_HZ,
+		2.0
+	);
+	EXPECT_EQ(emu.stats().cmds, 1u);
+}
+
+TEST(FWEmulator, HelloSwitchesToV2) {
+	FW_Emulator emu;
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	host.hello(2);
+	pkg_s2m_any_t p;
+	pkg_kind_t kind;
+	while((kind = host.next(p)) == PKG_S2M_V1){
+	}
+	ASSERT_EQ(kind, PKG_S2M_V2);
+	const u16 seq = p.v2.payload.seq;
+	const u32 t_us = p.v2.payload.t_us;
+	EXPECT_EQ(p.v2.payload.version, 2);
+	EXPECT_EQ(p.v2.payload.sample_period_us, FW_Emulator::SAMPLE_PERIOD_US);
+
+	ASSERT_EQ(host.next(p), PKG_S2M_V2);
+	EXPECT_EQ(p.v2.payload.seq, u16(seq + 1));
+	EXPECT_NEAR(
+		double(p.v2.payload.t_us - t_us),
+		double(ENC_SAMPLES*FW_Emulator::SAMPLE_PERIOD_US),
+		2.0
+	);
+	EXPECT_EQ(emu.stats().proto_version, 2);
+
+	//reset MCU-a vraca v1
+	emu.reset();
+	while((kind = host.next(p)) == PKG_S2M_V2){
+	}
+	EXPECT_EQ(kind, PKG_S2M_V1);
+}
+
+TEST(FWEmulator, OldFirmwareIgnoresHello) {
+	FW_Emulator::Config cfg;
+	cfg.max_version = 1;
+	FW_Emulator emu(cfg);
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	host.hello(2);
+	u32 v1, v2;
+	host.drain(std::chrono::milliseconds(300), v1, v2);
+	EXPECT_GT(v1, 5u);
+	EXPECT_EQ(v2, 0u);
+	EXPECT_EQ(emu.stats().hellos, 0u);
+}
+
+TEST(FWEmulator, CorruptedPackagesFailCrc) {
+	FW_Emulator::Config cfg;
+	cfg.pkg_corrupt = 1.0;
+	FW_Emulator emu(cfg);
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	u32 v1, v2;
+	host.drain(std::chrono::milliseconds(300), v1, v2);
+	EXPECT_EQ(v1 + v2, 0u);
+	EXPECT_GT(host.framer.crc_errors, 5u);
+	EXPECT_EQ(emu.stats().tx_corrupted, emu.stats().tx_pkgs);
+}
+
+TEST(FWEmulator, FramerRecoversFromByteDrops) {
+	FW_Emulator::Config cfg;
+	cfg.byte_drop = 0.01;
+	cfg.seed = 7;
+	FW_Emulator emu(cfg);
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	u32 v1, v2;
+	host.drain(std::chrono::milliseconds(1000), v1, v2);
+	const FW_Emulator::Stats s = emu.stats();
+	//paket od 20 bajtova prodje ceo sa verovatnocom 0.99^20 = 0.82
+	EXPECT_GT(s.dropped_bytes, 0u);
+	EXPECT_LT(v1, s.tx_pkgs);
+	EXPECT_GT(v1, s.tx_pkgs/2);
+}
+
+TEST(FWEmulator, LatencyAndBlackout) {
+	FW_Emulator::Config cfg;
+	cfg.latency_ms = 30.0;
+	FW_Emulator emu(cfg);
+	ASSERT_TRUE(emu.open());
+	Host host(emu.port());
+
+	//potvrda putuje 30 ms u oba smera i ceka sledeci paket (najvise 40 ms)
+	const Clock::time_point t0 = Clock::now();
+	host.cmd(500, 90);
+	pkg_s2m_any_t p;
+	do{
+		ASSERT_EQ(host.next(p), PKG_S2M_V1);
+	}while(p.v1.payload.speed_i != 500);
+	const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+	EXPECT_GE(ms, 60.0);
+	EXPECT_LT(ms, 150.0);
+
+	//u prekidu nista ne stize, posle prekida tok se nastavlja
+	emu.blackout(std::chrono::milliseconds(300));
+	u32 v1, v2;
+	host.drain(std::chrono::milliseconds(250), v1, v2);
+	const u32 in_flight = v1; // poslato pre prekida, jos na putu
+	EXPECT_LE(in_flight, 1u);
+	host.drain(std::chrono::milliseconds(300), v1, v2);
+	EXPECT_GT(v1, 3u);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <atomic>
+#include <thread>
+
+#include "seqlock.hpp"
+#include "spsc_ring.hpp"
+
+//SPSC_Ring i Seqlock izmedju dve niti, kao read__loop i executor u FW_Node.
+//Pod -fsanitize=thread ne sme biti prijavljenih data race-ova.
+
+namespace {
+
+struct sample_t {
+	i64 t_ns;
+	i32 enc;
+};
+
+//tri polja koja moraju da se slazu; pocepano citanje ih razdvaja
+struct range_t {
+	i64 t_ns;
+	float dist_cm;
+	u32 check;
+};
+
+range_t make_range(u32 i) {
+	return {i64(i)*40000000, float(i % 400), i*2654435761u};
+}
+
+} // namespace
+
+TEST(SPSCRing, FifoAndFull) {
+	SPSC_Ring<int, 4> r;
+	int v;
+	EXPECT_FALSE(r.pop(v));
+	for(int i = 0; i < 4; i++){
+		EXPECT_TRUE(r.push(i));
+	}
+	EXPECT_FALSE(r.push(4));
+	EXPECT_EQ(r.size(), 4u);
+	for(int i = 0; i < 4; i++){
+		ASSERT_TRUE(r.pop(v));
+		EXPECT_EQ(v, i);
+	}
+	EXPECT_FALSE(r.pop(v));
+	//indeksi prelaze preko kraja bafera
+	for(int i = 0; i < 10; i++){
+		EXPECT_TRUE(r.push(i));
+		ASSERT_TRUE(r.pop(v));
+		EXPECT_EQ(v, i);
+	}
+}
+
+TEST(SPSCRing, TwoThreadsInOrder) {
+	const i32 N = 1000000;
+	SPSC_Ring<sample_t, 256> r;
+	std::atomic<u32> dropped(0);
+
+	std::thread producer([&]() {
+		for(i32 i = 0; i < N; i++){
+			if(!r.push({i64(i)*10, i})){
+				dropped++;
+			}
+		}
+	});
+
+	i32 got = 0;
+	i32 last = -1;
+	bool ordered = true;
+	bool consistent = true;
+	while(got + i32(dropped.load()) < N){
+		sample_t s;
+		if(!r.pop(s)){
+			std::this_thread::yield();
+			continue;
+		}
+		ordered = ordered && s.enc > last;
+		consistent = consistent && s.t_ns == i64(s.enc)*10;
+		last = s.enc;
+		got++;
+	}
+	producer.join();
+
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(consistent);
+	EXPECT_EQ(got + i32(dropped.load()), N);
+}
+
+TEST(Seqlock, EmptyThenLatest) {
+	Seqlock<range_t> l;
+	range_t v;
+	EXPECT_EQ(l.load(v), 0u);
+	l.store(make_range(1));
+	l.store(make_range(2));
+	EXPECT_EQ(l.load(v), 2u);
+	EXPECT_EQ(v.check, make_range(2).check);
+	EXPECT_EQ(v.dist_cm, 2.0f);
+}
+
+TEST(Seqlock, NoTornReads) {
+	const u32 N = 2000000;
+	Seqlock<range_t> l;
+	std::atomic<bool> done(false);
+
+	std::thread writer([&]() {
+		for(u32 i = 1; i <= N; i++){
+			l.store(make_range(i));
+		}
+		done = true;
+	});
+
+	u32 reads = 0;
+	u32 torn = 0;
+	u32 prev = 0;
+	bool monotonic = true;
+	while(!done){
+		range_t v;
+		const u32 seq = l.load(v);
+		if(seq == 0){
+			continue;
+		}
+		const range_t e = make_range(seq);
+		if(v.t_ns != e.t_ns || v.dist_cm != e.dist_cm || v.check != e.check){
+			torn++;
+		}
+		monotonic = monotonic && seq >= prev;
+		prev = seq;
+		reads++;
+	}
+	writer.join();
+
+	EXPECT_GT(reads, 0u);
+	EXPECT_EQ(torn, 0u);
+	EXPECT_TRUE(monotonic);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include <cmath>
+
+#include "speed_controller.hpp"
+
+//Speed_Controller sa simuliranim pogonom: motor prvog reda, opterecenje
+//koje oduzima deo brzine, i enkoder sa celim tikovima na 100 Hz (v2).
+//Geometrija i enkoder su iz param/ackibot.yaml.
+
+namespace {
+
+const double RADIUS = 0.073;
+const double TICKS_PER_REV = 3415.92;
+const double M_PER_TICK = 2*M_PI/TICKS_PER_REV*RADIUS;
+const double MAX_SPEED = 0.9; // 118 o/min
+const i64 SAMPLE_NS = 10240000;
+
+const Speed_Controller::Params PARAMS = {2500.0, 15000.0, MAX_SPEED, 0.03};
+
+struct Plant {
+	//load: deo brzine koji opterecenje oduzima, 0 je prazan hod
+	explicit Plant(double load = 0.0)
+		: load(load), tau(0.15), v(0.0), x(0.0), t_ns(0) {}
+
+	void step(i16 u) {
+		const double dt = SAMPLE_NS*1e-9;
+		const double v_ss = u/Speed_Controller::U_MAX*MAX_SPEED*(1.0 - load);
+		v += (v_ss - v)*dt/tau;
+		x += v*dt;
+		t_ns += SAMPLE_NS;
+	}
+
+	i32 enc() const {
+		return i32(std::floor(x/M_PER_TICK));
+	}
+
+	double load;
+	double tau;
+	double v;	//m/s
+	double x;	//m
+	i64 t_ns;
+};
+
+//vozi s sekundi; vraca najvecu brzinu u tom periodu
+double drive(Speed_Controller& c, Plant& plant, double s) {
+	double v_max = 0.0;
+	for(int i = 0; i < int(s/(SAMPLE_NS*1e-9)); i++){
+		plant.step(c.update(plant.enc(), plant.t_ns));
+		v_max = std::max(v_max, plant.v);
+	}
+	return v_max;
+}
+
+} // namespace
+
+TEST(SpeedController, FeedForwardIsOpenLoop) {
+	Speed_Controller c({0.0, 0.0, MAX_SPEED, 0.03}, M_PER_TICK);
+	c.set_target(0.45);
+	EXPECT_EQ(c.update(0, 0), 1024);
+	c.set_target(-0.9);
+	EXPECT_EQ(c.update(0, SAMPLE_NS), -2047);
+}
+
+TEST(SpeedController, TracksUnderLoad) {
+	for(double load : {0.0, 0.3, 0.5}){
+		Speed_Controller c(PARAMS, M_PER_TICK);
+		Plant plant(load);
+		c.set_target(0.4);
+		drive(c, plant, 2.0);
+		EXPECT_NEAR(plant.v, 0.4, 0.01) << load;
+		EXPECT_NEAR(c.speed(), 0.4, 0.02) << load;
+
+		//unazad
+		c.set_target(-0.3);
+		drive(c, plant, 2.0);
+		EXPECT_NEAR(plant.v, -0.3, 0.01) << load;
+	}
+
+	//bez PI isti pogon pod opterecenjem ostaje daleko od cilja
+	Speed_Controller open({0.0, 0.0, MAX_SPEED, 0.03}, M_PER_TICK);
+	Plant plant(0.3);
+	open.set_target(0.4);
+	drive(open, plant, 2.0);
+	EXPECT_LT(plant.v, 0.3);
+}
+
+TEST(SpeedController, StepResponse) {
+	Speed_Controller c(PARAMS, M_PER_TICK);
+	Plant plant(0.3);
+	c.set_target(0.5);
+	const double v_max = drive(c, plant, 0.5);
+	//za pola sekunde blizu cilja, bez velikog prebacaja
+	EXPECT_NEAR(plant.v, 0.5, 0.03);
+	EXPECT_LT(v_max, 0.5*1.1);
+}
+
+TEST(SpeedController, AntiWindup) {
+	Speed_Controller c(PARAMS, M_PER_TICK);
+	Plant plant(0.5);
+	//nedostizno: pod opterecenjem najvise 0.45 m/s
+	c.set_target(0.8);
+	drive(c, plant, 3.0);
+	EXPECT_EQ(c.output(), 2047);
+
+	//integrator nije napunjen, pa izlaz odmah izlazi iz zasicenja
+	//i brzina pada ka novom cilju bez zadrzavanja na starom
+	const double v_sat = plant.v;
+	c.set_target(0.3);
+	plant.step(c.update(plant.enc(), plant.t_ns));
+	EXPECT_LT(c.output(), 2047);
+	const double v_max = drive(c, plant, 1.5);
+	EXPECT_LE(v_max, v_sat);
+	EXPECT_NEAR(plant.v, 0.3, 0.01);
+}
+
+TEST(SpeedController, StopAndHold) {
+	Speed_Controller c(PARAMS, M_PER_TICK);
+	Plant plant(0.3);
+	c.set_target(0.4);
+	drive(c, plant, 1.0);
+	c.set_target(0.0);
+	EXPECT_EQ(c.update(plant.enc(), plant.t_ns + SAMPLE_NS), 0);
+
+	//emergency stop: motor stoji, a integrator se ne puni
+	c.set_target(0.4);
+	for(int i = 0; i < 100; i++){
+		c.update(plant.enc(), plant.t_ns);
+		plant.step(0);
+		c.hold();
+	}
+	EXPECT_NEAR(c.output(), 0.4/MAX_SPEED*2047 + PARAMS.kp*0.4, 80.0);
+}
+
+TEST(SpeedController, IgnoresGapsAndJumps) {
+	Speed_Controller c(PARAMS, M_PER_TICK);
+	Plant plant;
+	c.set_target(0.3);
+	drive(c, plant, 1.0);
+	const i16 u = c.output();
+
+	//reset firmware-a: enkoder skoci na 0
+	c.update(0, plant.t_ns + SAMPLE_NS);
+	EXPECT_NEAR(c.output(), u, 50);
+	EXPECT_NEAR(c.speed(), 0.3, 0.02);
+
+	//rupa u toku: prvi uzorak posle nje samo pocinje merenje
+	c.update(1000000, plant.t_ns + 2000000000);
+	EXPECT_NEAR(c.speed(), 0.3, 0.02);
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "fw_pkgs.hpp"
+#include "pkg_framer.hpp"
+#include "enc_stream.hpp"
+
+//Protokol v2: Pkg_Framer sa mesanim v1/v2 paketima i Enc_Stream
+//(redni brojevi, vreme uzoraka).
+
+namespace {
+
+pkg_s2m_t make_v1(i32 enc) {
+	pkg_s2m_t p = {};
+	p.magic = PKG_MAGIC;
+	p.payload.enc = enc;
+	p.payload.ultrasound_pulse = 1000;
+	p.crc = CRC16().add(p.payload).get_crc();
+	return p;
+}
+
+pkg_s2m_v2_t make_v2(u16 seq, u32 t_us, i32 enc0, u16 period_us = 10240) {
+	pkg_s2m_v2_t p = {};
+	p.magic = PKG_V2_MAGIC;
+	p.payload.version = PKG_PROTOCOL_VERSION;
+	p.payload.seq = seq;
+	p.payload.t_us = t_us;
+	p.payload.sample_period_us = period_us;
+	for(int i = 0; i < ENC_SAMPLES; i++){
+		p.payload.enc[i] = enc0 + i;
+	}
+	p.payload.ultrasound_pulse = 2000;
+	p.crc = CRC16().add(p.payload).get_crc();
+	return p;
+}
+
+template<typename Pkg>
+void append(std::vector<u8>& v, const Pkg& p) {
+	const u8* b = reinterpret_cast<const u8*>(&p);
+	v.insert(v.end(), b, b + sizeof(p));
+}
+
+} // namespace
+
+TEST(Telemetry, PackageLayout) {
+	EXPECT_EQ(sizeof(pkg_hello_t), 5u);
+	EXPECT_EQ(sizeof(pkg_s2m_t), 20u);
+	EXPECT_EQ(sizeof(pkg_s2m_v2_t), 43u);
+	//prvi bajt magic-a razlikuje sve pakete, drugi je zajednicki
+	EXPECT_NE(PKG_MAGIC & 0xff, PKG_V2_MAGIC & 0xff);
+	EXPECT_NE(PKG_MAGIC & 0xff, PKG_HELLO_MAGIC & 0xff);
+	EXPECT_NE(PKG_V2_MAGIC & 0xff, PKG_HELLO_MAGIC & 0xff);
+}
+
+TEST(Telemetry, FramerMixedVersions) {
+	std::mt19937 rng(7);
+	std::vector<u8> stream;
+	std::vector<pkg_kind_t> kinds;
+	for(int i = 0; i < 200; i++){
+		//sum izmedju paketa
+		for(int n = rng() % 4; n; n--){
+			stream.push_back(rng());
+		}
+		if(rng() % 3 == 0){
+			append(stream, make_v1(i));
+			kinds.push_back(PKG_S2M_V1);
+		}else{
+			append(stream, make_v2(i, 1000*i, 4*i));
+			kinds.push_back(PKG_S2M_V2);
+		}
+	}
+
+	Pkg_Framer<> framer;
+	std::vector<pkg_kind_t> got;
+	std::vector<int> idx;
+	size_t pos = 0;
+	while(pos < stream.size()){
+		const size_t chunk = std::min<size_t>(1 + rng() % 64, stream.size() - pos);
+		ASSERT_EQ(framer.write(stream.data() + pos, chunk), chunk);
+		pos += chunk;
+
+		pkg_s2m_any_t p;
+		pkg_kind_t kind;
+		while((kind = framer.next(p)) != PKG_NONE){
+			got.push_back(kind);
+			idx.push_back(kind == PKG_S2M_V2 ? p.v2.payload.seq : p.v1.payload.enc);
+		}
+	}
+
+	ASSERT_EQ(got, kinds);
+	for(size_t i = 0; i < idx.size(); i++){
+		EXPECT_EQ(idx[i], int(i));
+	}
+	EXPECT_EQ(framer.pkgs, 200u);
+}
+
+TEST(Telemetry, FramerCorruptV2) {
+	std::vector<u8> stream;
+	pkg_s2m_v2_t bad = make_v2(1, 1000, 0);
+	bad.payload.enc[2] ^= 0x10;
+	append(stream, bad);
+	append(stream, make_v1(5));
+
+	Pkg_Framer<> framer;
+	framer.write(stream.data(), stream.size());
+	pkg_s2m_any_t p;
+	ASSERT_EQ(framer.next(p), PKG_S2M_V1);
+	EXPECT_EQ(p.v1.payload.enc, 5);
+	EXPECT_EQ(framer.next(p), PKG_NONE);
+	EXPECT_EQ(framer.crc_errors, 1u);
+}
+
+TEST(Telemetry, SampleTimestamps) {
+	Enc_Stream s;
+	enc_sample_t out[ENC_SAMPLES];
+	const i64 host0 = 5000000000;
+	const i64 latency_ns = 3000000;
+
+	//prvi paket kasni vise, drugi ima najmanje kasnjenje
+	ASSERT_EQ(s.push(make_v2(0, 100000, 0), host0 + 100000000 + 2*latency_ns, out), size_t(ENC_SAMPLES));
+	ASSERT_EQ(s.push(make_v2(1, 140960, 4), host0 + 140960000 + latency_ns, out), size_t(ENC_SAMPLES));
+
+	EXPECT_EQ(s.clock().to_host_ns(0), host0 + latency_ns);
+	for(int i = 0; i < ENC_SAMPLES; i++){
+		EXPECT_EQ(out[i].enc, 4 + i);
+		const i64 t_us = 140960 - (ENC_SAMPLES - 1 - i)*10240;
+		EXPECT_EQ(out[i].t_ns, t_us*1000 + host0 + latency_ns);
+	}
+	EXPECT_EQ(s.lost, 0u);
+}
+
+TEST(Telemetry, SeqGapsAndDuplicates) {
+	Enc_Stream s;
+	enc_sample_t out[ENC_SAMPLES];
+	i64 host = 1000000000;
+	u32 t = 0;
+	auto push = [&](u16 seq) {
+		t = 40960*(seq + 1);
+		host = 1000000000 + i64(t)*1000;
+		return s.push(make_v2(seq, t, seq*4), host, out);
+	};
+
+	EXPECT_EQ(push(0xfffe), size_t(ENC_SAMPLES));
+	EXPECT_EQ(push(0xffff), size_t(ENC_SAMPLES));
+	EXPECT_EQ(s.push(make_v2(0xffff, t, 0), host + 1000, out), 0u);
+	EXPECT_EQ(push(0x0000), size_t(ENC_SAMPLES)); // seq se preliva
+	EXPECT_EQ(push(0x0003), size_t(ENC_SAMPLES)); // izgubljene 1 i 2
+
+	EXPECT_EQ(s.pkgs, 4u);
+	EXPECT_EQ(s.duplicates, 1u);
+	EXPECT_EQ(s.lost, 2u);
+	EXPECT_EQ(s.restarts, 0u);
+}
+
+TEST(Telemetry, MicrosWrapAndRestart) {
+	Enc_Stream s;
+	enc_sample_t out[ENC_SAMPLES];
+	const i64 host0 = 7000000000;
+
+	//micros() se preliva izmedju dva paketa
+	const u32 t0 = 0xffffffffu - 20000;
+	s.push(make_v2(10, t0, 0), host0, out);
+	const i64 last0 = out[ENC_SAMPLES - 1].t_ns;
+	s.push(make_v2(11, t0 + 40960, 4), host0 + 40960000, out);
+	EXPECT_EQ(out[ENC_SAMPLES - 1].t_ns - last0, 40960000);
+	for(int i = 1; i < ENC_SAMPLES; i++){
+		EXPECT_EQ(out[i].t_ns - out[i - 1].t_ns, 10240000);
+	}
+
+	//reset firmware-a: seq i vreme krecu od nule, tok ostaje monoton
+	const i64 prev = out[ENC_SAMPLES - 1].t_ns;
+	ASSERT_EQ(s.push(make_v2(0, 40960, 0), host0 + 2000000000, out), size_t(ENC_SAMPLES));
+	EXPECT_EQ(s.restarts, 1u);
+	EXPECT_EQ(s.lost, 0u);
+	EXPECT_GT(out[0].t_ns, prev);
+	EXPECT_EQ(out[ENC_SAMPLES - 1].t_ns, host0 + 2000000000);
+}
@@ -0,0 +1,385 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef TWIST_MUX__ARBITER_HPP_
+#define TWIST_MUX__ARBITER_HPP_
+
+#include <twist_mux/timer_wheel.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace twist_mux
+{
+/**
+ * @brief Incremental priority arbitration between velocity inputs and locks.
+ *
+ * Keeps the same rules as the original scan in TwistMux::hasPriority:
+ *  - an input is active until its timeout expires (timeout 0 never expires),
+ *  - a lock is locked if its last value is true or its timeout expired,
+ *  - the lock priority is the highest priority of the locked locks (or 0),
+ *  - the winner is the active input with the highest priority that is not
+ *    below the lock priority; ties go to the input registered first and
+ *    priority 0 never wins.
+ *
+ * State changes only on message arrival and on expiry, which is driven by a
+ * TimerWheel, so the winner and the lock priority are cached instead of
+ * recomputed:
+ *  - active inputs are a bitset ordered by rank (priority descending, then
+ *    registration order); the winner is its first set bit,
+ *  - locked locks are counted per priority level with a bitset of non-empty
+ *    levels; the lock priority is its highest set bit.
+ *
+ * Every update is O(1) for up to a few hundred inputs (one machine word per
+ * 64 inputs). Handles are identified by the integer id returned on
+ * registration.
+ */
+class Arbiter
+{
+public:
+  typedef int priority_type;
+  typedef std::size_t id_type;
+  typedef TimerWheel::time_type time_type;
+
+  static constexpr id_type NONE = std::numeric_limits<id_type>::max();
+  static constexpr priority_type MAX_PRIORITY = 255;
+
+  /**
+   * @param tick Timer wheel slot width [ns]
+   * @param slots Timer wheel slot count
+   */
+  explicit Arbiter(time_type tick = 1000000, std::size_t slots = 256)
+  : wheel_(tick, slots),
+    lock_count_(MAX_PRIORITY + 1, 0),
+    lock_levels_{}
+  {
+  }
+
+  /**
+   * @brief addInput Register a velocity input. Inputs with a timeout start
+   * expired.
+   * @param priority Priority, clamped to [0, MAX_PRIORITY]
+   * @param timeout Timeout [ns]; 0 means the input never expires
+   * @return Input id
+   */
+  id_type addInput(priority_type priority, time_type timeout)
+  {
+    const id_type id = inputs_.size();
+    Input input;
+    input.priority = clampPriority(priority);
+    input.timeout = timeout;
+    input.rank = 0;
+    input.active = false;
+    inputs_.push_back(input);
+    wheel_.resize(2 * (std::max(inputs_.size(), locks_.size())));
+
+    rank();
+    if (timeout <= 0) {
+      setActive(id, true);
+    }
+    return id;
+  }
+
+  /**
+   * @brief addLock Register a lock. Locks with a timeout start expired, i.e.
+   * locked.
+   * @param priority Priority, clamped to [0, MAX_PRIORITY]
+   * @param timeout Timeout [ns]; 0 means the lock never expires
+   * @return Lock id
+   */
+  id_type addLock(priority_type priority, time_type timeout)
+  {
+    const id_type id = locks_.size();
+    Lock lock;
+    lock.priority = clampPriority(priority);
+    lock.timeout = timeout;
+    lock.expired = timeout > 0;
+    lock.data = false;
+    lock.transitions = 0;
+    locks_.push_back(lock);
+    wheel_.resize(2 * (std::max(inputs_.size(), locks_.size())));
+
+    if (lock.expired) {
+      countLock(lock.priority, +1);
+    }
+    return id;
+  }
+
+  /**
+   * @brief onInput Message arrival on an input.
+   * @param refresh false if the message must not renew the timeout
+   * (expire_on_idle with a zero command)
+   */
+  void onInput(id_type id, time_type now, bool refresh = true)
+  {
+    advance(now);
+
+    const Input & input = inputs_[id];
+    if (!refresh || input.timeout <= 0) {
+      return;
+    }
+    wheel_.schedule(inputKey(id), now + input.timeout);
+    setActive(id, true);
+  }
+
+  /**
+   * @brief onLock Message arrival on a lock.
+   */
+  void onLock(id_type id, time_type now, bool data)
+  {
+    advance(now);
+
+    Lock & lock = locks_[id];
+    const bool was_locked = isLocked(id);
+    lock.data = data;
+    if (lock.timeout > 0) {
+      wheel_.schedule(lockKey(id), now + lock.timeout);
+      lock.expired = false;
+    }
+    updateLock(lock, was_locked);
+  }
+
+  /**
+   * @brief advance Apply every expiry that happened before now.
+   */
+  void advance(time_type now)
+  {
+    wheel_.advance(
+      now, [this](TimerWheel::key_type key) {
+        if (isInputKey(key)) {
+          setActive(key / 2, false);
+        } else {
+          Lock & lock = locks_[key / 2];
+          const bool was_locked = isLocked(key / 2);
+          lock.expired = true;
+          updateLock(lock, was_locked);
+        }
+      });
+  }
+
+  /**
+   * @brief winner Id of the input that currently has priority, or NONE.
+   */
+  id_type winner() const
+  {
+    for (std::size_t w = 0; w < active_.size(); ++w) {
+      if (active_[w] != 0) {
+        const std::size_t rank = w * 64 + lowestBit(active_[w]);
+        const Input & input = inputs_[by_rank_[rank]];
+        if (input.priority == 0 || input.priority < lockPriority()) {
+          return NONE;
+        }
+        return by_rank_[rank];
+      }
+    }
+    return NONE;
+  }
+
+  bool hasPriority(id_type id) const
+  {
+    return winner() == id;
+  }
+
+  /**
+   * @brief lockPriority Highest priority of the locked locks, or 0.
+   */
+  priority_type lockPriority() const
+  {
+    for (std::size_t w = LOCK_WORDS; w-- > 0; ) {
+      if (lock_levels_[w] != 0) {
+        return static_cast<priority_type>(w * 64 + highestBit(lock_levels_[w]));
+      }
+    }
+    return 0;
+  }
+
+  bool isExpired(id_type input) const
+  {
+    return !inputs_[input].active;
+  }
+
+  bool isMasked(id_type input) const
+  {
+    return isExpired(input) || inputs_[input].priority < lockPriority();
+  }
+
+  bool isLocked(id_type lock) const
+  {
+    return locks_[lock].expired || locks_[lock].data;
+  }
+
+  /**
+   * @brief lockTransitions Number of locked <-> free changes of a lock.
+   */
+  std::uint64_t lockTransitions(id_type lock) const
+  {
+    return locks_[lock].transitions;
+  }
+
+  std::size_t inputCount() const
+  {
+    return inputs_.size();
+  }
+
+  std::size_t lockCount() const
+  {
+    return locks_.size();
+  }
+
+  /**
+   * @brief inputDeadline / lockDeadline Pending expiry of one handle.
+   * @return false if the handle cannot expire (no timeout, or already expired)
+   */
+  bool inputDeadline(id_type input, time_type & deadline) const
+  {
+    return pendingDeadline(inputKey(input), deadline);
+  }
+
+  bool lockDeadline(id_type lock, time_type & deadline) const
+  {
+    return pendingDeadline(lockKey(lock), deadline);
+  }
+
+  /**
+   * @brief nextDeadline Earliest pending expiry.
+   * @return false if nothing can expire
+   */
+  bool nextDeadline(time_type & deadline) const
+  {
+    return wheel_.earliest(deadline);
+  }
+
+private:
+  struct Input
+  {
+    priority_type priority;
+    time_type timeout;
+    std::size_t rank;
+    bool active;
+  };
+
+  struct Lock
+  {
+    priority_type priority;
+    time_type timeout;
+    bool expired;
+    bool data;
+    std::uint64_t transitions;
+  };
+
+  static constexpr std::size_t LOCK_WORDS = (MAX_PRIORITY + 1) / 64;
+
+  // Inputs and locks share the wheel: even keys are inputs, odd keys locks.
+  static TimerWheel::key_type inputKey(id_type id)
+  {
+    return 2 * id;
+  }
+
+  static TimerWheel::key_type lockKey(id_type id)
+  {
+    return 2 * id + 1;
+  }
+
+  static bool isInputKey(TimerWheel::key_type key)
+  {
+    return (key & 1) == 0;
+  }
+
+  bool pendingDeadline(TimerWheel::key_type key, time_type & deadline) const
+  {
+    if (!wheel_.pending(key)) {
+      return false;
+    }
+    deadline = wheel_.deadline(key);
+    return true;
+  }
+
+  static priority_type clampPriority(priority_type priority)
+  {
+    return std::min(std::max(priority, priority_type(0)), priority_type(MAX_PRIORITY));
+  }
+
+  static std::size_t lowestBit(std::uint64_t word)
+  {
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+  }
+
+  static std::size_t highestBit(std::uint64_t word)
+  {
+    return 63 - static_cast<std::size_t>(__builtin_clzll(word));
+  }
+
+  // Rank = position in (priority descending, registration order); only
+  // recomputed when an input is registered.
+  void rank()
+  {
+    by_rank_.resize(inputs_.size());
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+      by_rank_[i] = i;
+    }
+    std::stable_sort(
+      by_rank_.begin(), by_rank_.end(), [this](id_type a, id_type b) {
+        return inputs_[a].priority > inputs_[b].priority;
+      });
+
+    active_.assign((inputs_.size() + 63) / 64, 0);
+    for (std::size_t r = 0; r < by_rank_.size(); ++r) {
+      Input & input = inputs_[by_rank_[r]];
+      input.rank = r;
+      if (input.active) {
+        active_[r / 64] |= std::uint64_t(1) << (r % 64);
+      }
+    }
+  }
+
+  void setActive(id_type id, bool active)
+  {
+    Input & input = inputs_[id];
+    input.active = active;
+    const std::uint64_t bit = std::uint64_t(1) << (input.rank % 64);
+    if (active) {
+      active_[input.rank / 64] |= bit;
+    } else {
+      active_[input.rank / 64] &= ~bit;
+    }
+  }
+
+  void updateLock(Lock & lock, bool was_locked)
+  {
+    const bool locked = lock.expired || lock.data;
+    if (locked != was_locked) {
+      countLock(lock.priority, locked ? +1 : -1);
+      ++lock.transitions;
+    }
+  }
+
+  void countLock(priority_type priority, int delta)
+  {
+    const std::size_t level = static_cast<std::size_t>(priority);
+    lock_count_[level] += delta;
+    const std::uint64_t bit = std::uint64_t(1) << (level % 64);
+    if (lock_count_[level] > 0) {
+      lock_levels_[level / 64] |= bit;
+    } else {
+      lock_levels_[level / 64] &= ~bit;
+    }
+  }
+
+  TimerWheel wheel_;
+
+  std::vector<Input> inputs_;
+  std::vector<id_type> by_rank_;
+  std::vector<std::uint64_t> active_;
+
+  std::vector<Lock> locks_;
+  std::vector<int> lock_count_;
+  std::uint64_t lock_levels_[LOCK_WORDS];
+};
+
+}  // namespace twist_mux
+
+#endif  // TWIST_MUX__ARBITER_HPP_
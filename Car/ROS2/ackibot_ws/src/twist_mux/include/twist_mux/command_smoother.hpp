@@ -0,0 +1,151 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef TWIST_MUX__COMMAND_SMOOTHER_HPP_
+#define TWIST_MUX__COMMAND_SMOOTHER_HPP_
+
+#include <algorithm>
+#include <cmath>
+
+namespace twist_mux
+{
+/**
+ * @brief Acceleration and jerk limiter for one velocity component.
+ *
+ * Each step moves the output velocity towards the target with an
+ * acceleration bounded by max_acceleration, changing by at most
+ * max_jerk * dt per step. Near the target the acceleration is also bounded
+ * by sqrt(2 * max_jerk * |error|), so that it can ramp down to zero by the
+ * time the target is reached instead of overshooting.
+ *
+ * A limit of 0 disables it.
+ */
+class RateLimiter
+{
+public:
+  RateLimiter(double max_acceleration = 0.0, double max_jerk = 0.0)
+  : max_acceleration_(max_acceleration),
+    max_jerk_(max_jerk),
+    velocity_(0.0),
+    acceleration_(0.0)
+  {
+  }
+
+  /**
+   * @brief step Advance by dt towards target.
+   * @return Limited velocity
+   */
+  double step(double target, double dt)
+  {
+    if (dt <= 0.0) {
+      return velocity_;
+    }
+
+    const double error = target - velocity_;
+    double acceleration = error / dt;
+
+    if (max_jerk_ > 0.0) {
+      const double approach = std::sqrt(2.0 * max_jerk_ * std::abs(error));
+      acceleration = clampAbs(acceleration, approach);
+    }
+    if (max_acceleration_ > 0.0) {
+      acceleration = clampAbs(acceleration, max_acceleration_);
+    }
+    if (max_jerk_ > 0.0) {
+      const double max_change = max_jerk_ * dt;
+      acceleration = std::min(
+        std::max(acceleration, acceleration_ - max_change),
+        acceleration_ + max_change);
+    }
+
+    double velocity = velocity_ + acceleration * dt;
+    // Do not step past the target.
+    if ((error >= 0.0 && velocity > target) || (error <= 0.0 && velocity < target)) {
+      velocity = target;
+      acceleration = error / dt;
+    }
+
+    acceleration_ = acceleration;
+    velocity_ = velocity;
+    return velocity_;
+  }
+
+  /**
+   * @brief reset Jump to a velocity at rest (zero acceleration).
+   */
+  void reset(double velocity = 0.0)
+  {
+    velocity_ = velocity;
+    acceleration_ = 0.0;
+  }
+
+  double velocity() const
+  {
+    return velocity_;
+  }
+
+  double acceleration() const
+  {
+    return acceleration_;
+  }
+
+private:
+  static double clampAbs(double x, double limit)
+  {
+    return std::min(std::max(x, -limit), limit);
+  }
+
+  double max_acceleration_;
+  double max_jerk_;
+  double velocity_;
+  double acceleration_;
+};
+
+/**
+ * @brief Limits linear.x and angular.z of the output command; the other
+ * components are passed through unchanged.
+ */
+class CommandSmoother
+{
+public:
+  CommandSmoother(
+    double max_linear_acceleration = 0.0, double max_linear_jerk = 0.0,
+    double max_angular_acceleration = 0.0, double max_angular_jerk = 0.0)
+  : linear_(max_linear_acceleration, max_linear_jerk),
+    angular_(max_angular_acceleration, max_angular_jerk)
+  {
+  }
+
+  template<typename Twist>
+  void step(const Twist & target, double dt, Twist & out)
+  {
+    out = target;
+    out.linear.x = linear_.step(target.linear.x, dt);
+    out.angular.z = angular_.step(target.angular.z, dt);
+  }
+
+  void reset()
+  {
+    linear_.reset();
+    angular_.reset();
+  }
+
+  const RateLimiter & linear() const
+  {
+    return linear_;
+  }
+
+  const RateLimiter & angular() const
+  {
+    return angular_;
+  }
+
+private:
+  RateLimiter linear_;
+  RateLimiter angular_;
+};
+
+}  // namespace twist_mux
+
+#endif  // TWIST_MUX__COMMAND_SMOOTHER_HPP_
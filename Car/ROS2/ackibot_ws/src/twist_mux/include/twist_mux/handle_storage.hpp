@@ -0,0 +1,188 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef TWIST_MUX__HANDLE_STORAGE_HPP_
+#define TWIST_MUX__HANDLE_STORAGE_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace twist_mux
+{
+/**
+ * @brief Contiguous array of handles that are constructed in place and never
+ * move.
+ *
+ * Topic handles bind their subscription callbacks to `this`, so they cannot
+ * be relocated once built (and are neither copyable nor movable). The
+ * capacity is fixed by reserve() before the first emplace_back(); after that
+ * the elements stay where they were built, like in a reserved std::vector,
+ * without requiring T to be movable.
+ */
+template<typename T>
+class HandleArray
+{
+public:
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  HandleArray() = default;
+
+  HandleArray(const HandleArray &) = delete;
+  HandleArray & operator=(const HandleArray &) = delete;
+
+  ~HandleArray()
+  {
+    clear();
+  }
+
+  /**
+   * @brief reserve Allocate room for capacity handles; only allowed while empty.
+   */
+  void reserve(std::size_t capacity)
+  {
+    assert(size_ == 0);
+    storage_.reset(capacity > 0 ? new Slot[capacity] : nullptr);
+    capacity_ = capacity;
+  }
+
+  template<typename ... Args>
+  T & emplace_back(Args && ... args)
+  {
+    assert(size_ < capacity_);
+    T * handle = new (&storage_[size_]) T(std::forward<Args>(args)...);
+    ++size_;
+    return *handle;
+  }
+
+  void clear()
+  {
+    while (size_ > 0) {
+      data()[--size_].~T();
+    }
+  }
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  std::size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  T * data()
+  {
+    return reinterpret_cast<T *>(storage_.get());
+  }
+
+  const T * data() const
+  {
+    return reinterpret_cast<const T *>(storage_.get());
+  }
+
+  T & operator[](std::size_t i)
+  {
+    return data()[i];
+  }
+
+  const T & operator[](std::size_t i) const
+  {
+    return data()[i];
+  }
+
+  T & front()
+  {
+    return data()[0];
+  }
+
+  const T & front() const
+  {
+    return data()[0];
+  }
+
+  iterator begin()
+  {
+    return data();
+  }
+
+  iterator end()
+  {
+    return data() + size_;
+  }
+
+  const_iterator begin() const
+  {
+    return data();
+  }
+
+  const_iterator end() const
+  {
+    return data() + size_;
+  }
+
+private:
+  using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+  std::unique_ptr<Slot[]> storage_;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+};
+
+/**
+ * @brief Interned strings, looked up by a small integer id.
+ *
+ * Handle names and topics are interned once while the configuration is
+ * loaded; the handles only keep the ids, so nothing on the message path
+ * builds or compares strings.
+ */
+class NameTable
+{
+public:
+  using id_type = std::size_t;
+
+  /**
+   * @brief intern Id of name, adding it if it is not in the table yet.
+   */
+  id_type intern(const std::string & name)
+  {
+    for (id_type id = 0; id < names_.size(); ++id) {
+      if (names_[id] == name) {
+        return id;
+      }
+    }
+    names_.push_back(name);
+    return names_.size() - 1;
+  }
+
+  const std::string & operator[](id_type id) const
+  {
+    return names_[id];
+  }
+
+  std::size_t size() const
+  {
+    return names_.size();
+  }
+
+private:
+  std::vector<std::string> names_;
+};
+
+}  // namespace twist_mux
+
+#endif  // TWIST_MUX__HANDLE_STORAGE_HPP_
@@ -0,0 +1,238 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef TWIST_MUX__METRICS_HPP_
+#define TWIST_MUX__METRICS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace twist_mux
+{
+/**
+ * @brief Lock-free histogram of durations in power-of-two microsecond
+ * buckets: bucket 0 holds [0, 2) us, bucket k holds [2^k, 2^(k+1)) us, the
+ * last bucket everything above.
+ */
+class Histogram
+{
+public:
+  static constexpr std::size_t BUCKETS = 20;
+
+  Histogram()
+  {
+    for (auto & bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void record(std::int64_t ns)
+  {
+    buckets_[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t count(std::size_t bucket) const
+  {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief percentile Upper edge [ns] of the bucket holding quantile q.
+   * @return 0 if nothing was recorded
+   */
+  std::int64_t percentile(double q) const
+  {
+    std::uint64_t total = 0;
+    for (std::size_t b = 0; b < BUCKETS; ++b) {
+      total += count(b);
+    }
+    if (total == 0) {
+      return 0;
+    }
+    const double rank = q * static_cast<double>(total);
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < BUCKETS; ++b) {
+      seen += count(b);
+      if (static_cast<double>(seen) >= rank) {
+        return upperEdge(b);
+      }
+    }
+    return upperEdge(BUCKETS - 1);
+  }
+
+  static std::int64_t upperEdge(std::size_t bucket)
+  {
+    return (std::int64_t(2) << bucket) * 1000;
+  }
+
+private:
+  static std::size_t bucket(std::int64_t ns)
+  {
+    const std::int64_t us = ns / 1000;
+    std::size_t b = 0;
+    while (b + 1 < BUCKETS && (std::int64_t(2) << b) <= us) {
+      ++b;
+    }
+    return b;
+  }
+
+  std::atomic<std::uint64_t> buckets_[BUCKETS];
+};
+
+/**
+ * @brief Lock-free count / mean / max of a duration.
+ */
+class LatencyStats
+{
+public:
+  void record(std::int64_t ns)
+  {
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    std::int64_t max = max_.load(std::memory_order_relaxed);
+    while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  std::uint64_t count() const
+  {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  double mean() const
+  {
+    const auto n = count();
+    return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+  }
+
+  std::int64_t max() const
+  {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> count_{0};
+  std::atomic<std::int64_t> sum_{0};
+  std::atomic<std::int64_t> max_{0};
+};
+
+/**
+ * @brief Per-handle traffic counters.
+ *
+ * Written only from the handle's subscription callback and read by the
+ * metrics export, possibly from another executor thread; every field is a
+ * relaxed atomic, so neither side ever blocks.
+ */
+class HandleMetrics
+{
+public:
+  /**
+   * @brief onArrival Count a message and record the inter-arrival jitter,
+   * i.e. the change of the inter-arrival time from the previous one.
+   */
+  void onArrival(std::int64_t now_ns)
+  {
+    received_.fetch_add(1, std::memory_order_relaxed);
+
+    const std::int64_t last = last_arrival_.exchange(now_ns, std::memory_order_relaxed);
+    if (last == 0) {
+      return;
+    }
+    const std::int64_t interval = now_ns - last;
+    const std::int64_t last_interval = last_interval_.exchange(interval, std::memory_order_relaxed);
+    if (last_interval != 0) {
+      jitter_.record(interval > last_interval ? interval - last_interval : last_interval - interval);
+    }
+  }
+
+  void onForwarded()
+  {
+    forwarded_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void onSuppressed()
+  {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void recordStampLatency(std::int64_t ns)
+  {
+    stamp_latency_.record(ns);
+  }
+
+  void recordArbitration(std::int64_t ns)
+  {
+    arbitration_.record(ns);
+  }
+
+  std::uint64_t received() const
+  {
+    return received_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t forwarded() const
+  {
+    return forwarded_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t suppressed() const
+  {
+    return suppressed_.load(std::memory_order_relaxed);
+  }
+
+  const Histogram & jitter() const
+  {
+    return jitter_;
+  }
+
+  const LatencyStats & stampLatency() const
+  {
+    return stamp_latency_;
+  }
+
+  const LatencyStats & arbitration() const
+  {
+    return arbitration_;
+  }
+
+  /**
+   * @brief updateRate Message rate since the previous call [Hz]. Only the
+   * exporter calls this; the result is kept for rate().
+   */
+  double updateRate(std::int64_t now_ns)
+  {
+    const std::uint64_t received = this->received();
+    if (rate_time_ != 0 && now_ns > rate_time_) {
+      rate_ = static_cast<double>(received - rate_count_) * 1e9 / (now_ns - rate_time_);
+    }
+    rate_count_ = received;
+    rate_time_ = now_ns;
+    return rate_;
+  }
+
+  double rate() const
+  {
+    return rate_;
+  }
+
+private:
+  std::atomic<std::uint64_t> received_{0};
+  std::atomic<std::uint64_t> forwarded_{0};
+  std::atomic<std::uint64_t> suppressed_{0};
+  std::atomic<std::int64_t> last_arrival_{0};
+  std::atomic<std::int64_t> last_interval_{0};
+  Histogram jitter_;
+  LatencyStats stamp_latency_;
+  LatencyStats arbitration_;
+
+  // Exporter side.
+  std::uint64_t rate_count_ = 0;
+  std::int64_t rate_time_ = 0;
+  double rate_ = 0.0;
+};
+
+}  // namespace twist_mux
+
+#endif  // TWIST_MUX__METRICS_HPP_
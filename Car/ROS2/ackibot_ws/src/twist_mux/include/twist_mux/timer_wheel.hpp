@@ -0,0 +1,181 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef TWIST_MUX__TIMER_WHEEL_HPP_
+#define TWIST_MUX__TIMER_WHEEL_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace twist_mux
+{
+/**
+ * @brief Hashed timer wheel holding at most one deadline per key.
+ *
+ * Keys are small integers (handle ids). A deadline is hashed into the slot
+ * of its tick; slots are intrusive doubly linked lists, so (re)scheduling
+ * and cancelling are O(1). advance() visits only the slots between the last
+ * and the current tick and fires every entry whose deadline has passed;
+ * entries that belong to a later revolution stay in their slot.
+ *
+ * Time is an integer in nanoseconds and must not go backwards.
+ */
+class TimerWheel
+{
+public:
+  typedef std::int64_t time_type;
+  typedef std::size_t key_type;
+
+  /**
+   * @param tick Slot width [ns]
+   * @param slots Number of slots (rounded up to a power of two)
+   */
+  explicit TimerWheel(time_type tick = 1000000, std::size_t slots = 256)
+  : tick_(tick > 0 ? tick : 1),
+    mask_(roundUp(slots) - 1),
+    heads_(mask_ + 1, std::size_t(NIL)),
+    current_(0)
+  {
+  }
+
+  /**
+   * @brief resize Make room for keys [0, keys).
+   */
+  void resize(std::size_t keys)
+  {
+    next_.resize(keys, std::size_t(NIL));
+    prev_.resize(keys, std::size_t(NIL));
+    slot_.resize(keys, std::size_t(NIL));
+    deadline_.resize(keys, 0);
+  }
+
+  std::size_t size() const
+  {
+    return slot_.size();
+  }
+
+  /**
+   * @brief schedule Set (or move) the deadline of a key.
+   */
+  void schedule(key_type key, time_type deadline)
+  {
+    cancel(key);
+
+    time_type tick = deadline / tick_;
+    if (tick < current_) {
+      tick = current_;
+    }
+    const std::size_t slot = static_cast<std::size_t>(tick) & mask_;
+
+    deadline_[key] = deadline;
+    slot_[key] = slot;
+    prev_[key] = NIL;
+    next_[key] = heads_[slot];
+    if (heads_[slot] != NIL) {
+      prev_[heads_[slot]] = key;
+    }
+    heads_[slot] = key;
+  }
+
+  void cancel(key_type key)
+  {
+    const std::size_t slot = slot_[key];
+    if (slot == NIL) {
+      return;
+    }
+    if (prev_[key] != NIL) {
+      next_[prev_[key]] = next_[key];
+    } else {
+      heads_[slot] = next_[key];
+    }
+    if (next_[key] != NIL) {
+      prev_[next_[key]] = prev_[key];
+    }
+    slot_[key] = NIL;
+  }
+
+  bool pending(key_type key) const
+  {
+    return slot_[key] != NIL;
+  }
+
+  time_type deadline(key_type key) const
+  {
+    return deadline_[key];
+  }
+
+  /**
+   * @brief advance Fire every pending key whose deadline is before now.
+   * @param on_expire Called as on_expire(key); the key is no longer pending
+   * and may be rescheduled from the callback.
+   */
+  template<typename F>
+  void advance(time_type now, F && on_expire)
+  {
+    const time_type target = now / tick_;
+    if (target < current_) {
+      return;
+    }
+
+    // A full revolution visits every slot once.
+    const time_type last = std::min<time_type>(target, current_ + static_cast<time_type>(mask_));
+    for (time_type tick = current_; tick <= last; ++tick) {
+      std::size_t key = heads_[static_cast<std::size_t>(tick) & mask_];
+      while (key != NIL) {
+        const std::size_t next = next_[key];
+        if (deadline_[key] < now) {
+          cancel(key);
+          on_expire(key);
+        }
+        key = next;
+      }
+    }
+    current_ = target;
+  }
+
+  /**
+   * @brief earliest Earliest pending deadline.
+   * @return false if nothing is pending
+   */
+  bool earliest(time_type & deadline) const
+  {
+    bool found = false;
+    deadline = std::numeric_limits<time_type>::max();
+    for (std::size_t key = 0; key < slot_.size(); ++key) {
+      if (slot_[key] != NIL && deadline_[key] < deadline) {
+        deadline = deadline_[key];
+        found = true;
+      }
+    }
+    return found;
+  }
+
+private:
+  static constexpr std::size_t NIL = std::numeric_limits<std::size_t>::max();
+
+  static std::size_t roundUp(std::size_t n)
+  {
+    std::size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  time_type tick_;
+  std::size_t mask_;
+  std::vector<std::size_t> heads_;
+  std::vector<std::size_t> next_;
+  std::vector<std::size_t> prev_;
+  std::vector<std::size_t> slot_;
+  std::vector<time_type> deadline_;
+  time_type current_;
+};
+
+}  // namespace twist_mux
+
+#endif  // TWIST_MUX__TIMER_WHEEL_HPP_
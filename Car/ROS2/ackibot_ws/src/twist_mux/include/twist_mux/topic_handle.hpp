@@ -41,9 +41,11 @@
 #include <geometry_msgs/msg/twist.hpp>
 #include <geometry_msgs/msg/twist_stamped.hpp>
 
+#include <twist_mux/metrics.hpp>
 #include <twist_mux/utils.hpp>
 #include <twist_mux/twist_mux.hpp>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -62,7 +64,10 @@ public:
   TopicHandle_ & operator=(TopicHandle_ &) = delete;
   TopicHandle_ & operator=(const TopicHandle_ &) = delete;
 
+  typedef T message_type;
   typedef int priority_type;
+  typedef Arbiter::id_type id_type;
+  typedef NameTable::id_type name_type;
 
   /**
    * @brief TopicHandle_
@@ -78,18 +83,20 @@ public:
   TopicHandle_(
     const std::string & name, const std::string & topic, const rclcpp::Duration & timeout,
     priority_type priority, bool expire_on_idle, TwistMux * mux)
-  : name_(name),
-    topic_(topic),
+  : name_(mux->internName(name)),
+    topic_(mux->internName(topic)),
     timeout_(timeout),
     priority_(clamp(priority, priority_type(0), priority_type(255))),
     expire_on_idle_(expire_on_idle),
+    id_(Arbiter::NONE),
     mux_(mux),
-    stamp_(0)
+    stamp_(0),
+    metrics_(std::make_shared<HandleMetrics>())
   {
     RCLCPP_INFO(
       mux_->get_logger(),
-      "Topic handler '%s' subscribed to topic '%s': timeout = %s , priority = %d.",
-      name_.c_str(), topic_.c_str(),
+      "Topic handler '%s' listening to topic '%s': timeout = %s , priority = %d.",
+      name.c_str(), topic.c_str(),
       ((timeout_.seconds() > 0) ? std::to_string(timeout_.seconds()) + "s" : "None").c_str(),
       static_cast<int>(priority_));
   }
@@ -109,15 +116,49 @@ public:
   }
 
   const std::string & getName() const
+  {
+    return mux_->getInternedName(name_);
+  }
+
+  /**
+   * @brief getId Integer id assigned by the arbiter; also the position of
+   * the handle in its container.
+   */
+  id_type getId() const
+  {
+    return id_;
+  }
+
+  /**
+   * @brief getNameId / getTopicId Interned name and topic (see TwistMux::internName)
+   */
+  name_type getNameId() const
   {
     return name_;
   }
 
-  const std::string & getTopic() const
+  name_type getTopicId() const
   {
     return topic_;
   }
 
+  /**
+   * @brief adopt Take over the state of the handle with the same name from
+   * the previous configuration: last stamp, last message and metrics.
+   */
+  void adopt(const TopicHandle_ & previous)
+  {
+    stamp_ = previous.stamp_;
+    msg_ = previous.msg_;
+    msg_ptr_ = previous.msg_ptr_;
+    metrics_ = previous.metrics_;
+  }
+
+  const std::string & getTopic() const
+  {
+    return mux_->getInternedName(topic_);
+  }
+
   const rclcpp::Duration & getTimeout() const
   {
     return timeout_;
@@ -132,29 +173,62 @@ public:
     return priority_;
   }
 
+  /**
+   * @brief getMetrics Traffic counters of this handle
+   */
+  const HandleMetrics & getMetrics() const
+  {
+    return *metrics_;
+  }
+
+  HandleMetrics & getMetrics()
+  {
+    return *metrics_;
+  }
+
   const T & getStamp() const
   {
     return stamp_;
   }
 
+  /**
+   * @brief getMessage Last message received; in zero-copy mode this is the
+   * message the handle still holds a pointer to.
+   */
   const T & getMessage() const
   {
-    return msg_;
+    return msg_ptr_ ? *msg_ptr_ : msg_;
   }
 
 protected:
-  std::string name_;
-  std::string topic_;
-  typename rclcpp::Subscription<T>::SharedPtr subscriber_;
+  name_type name_;
+  name_type topic_;
   rclcpp::Duration timeout_;
   priority_type priority_;
   bool expire_on_idle_;
+  id_type id_;
 
 protected:
   TwistMux * mux_;
 
   rclcpp::Time stamp_;
   T msg_;
+  typename T::ConstSharedPtr msg_ptr_;
+  // Deljeno sa handle-om istog imena iz naredne konfiguracije (vidi adopt()).
+  std::shared_ptr<HandleMetrics> metrics_;
+
+  /**
+   * @brief store Keep the last message for status: a copy, or only the
+   * shared pointer in zero-copy mode.
+   */
+  void store(const typename T::ConstSharedPtr & msg)
+  {
+    if (mux_->isZeroCopy()) {
+      msg_ptr_ = msg;
+    } else {
+      msg_ = *msg;
+    }
+  }
 };
 
 static bool is_zero(const geometry_msgs::msg::Twist& t) {
@@ -182,9 +256,18 @@ public:
     priority_type priority, bool expire_on_idle, TwistMux * mux)
   : base_type(name, topic, timeout, priority, expire_on_idle, mux)
   {
-    subscriber_ = mux_->create_subscription<geometry_msgs::msg::Twist>(
-      topic_, rclcpp::SystemDefaultsQoS(),
-      std::bind(&VelocityTopicHandle::callback, this, std::placeholders::_1));
+  }
+
+  /**
+   * @brief registerWith Add this input to the arbiter, replaying the last
+   * refreshing message if the handle adopted one.
+   */
+  void registerWith(Arbiter & arbiter)
+  {
+    id_ = arbiter.addInput(priority_, timeout_.nanoseconds());
+    if (stamp_.nanoseconds() > 0) {
+      arbiter.onInput(id_, stamp_.nanoseconds());
+    }
   }
 
   bool isMasked(priority_type lock_priority) const
@@ -193,20 +276,35 @@ public:
     return hasExpired() || (getPriority() < lock_priority);
   }
 
-  void callback(const geometry_msgs::msg::Twist::ConstSharedPtr msg)
+  /**
+   * @brief callback Handle a message; set is the handle set this handle
+   * belongs to, loaded by the subscription under TwistMux::mutex().
+   */
+  void callback(const geometry_msgs::msg::Twist::ConstSharedPtr msg, TwistMux::HandleSet & set)
   {
-    if(!expire_on_idle_ || !is_zero(*msg)){
-      stamp_ = mux_->now();
+    const rclcpp::Time now = mux_->now();
+    metrics_->onArrival(now.nanoseconds());
+    const bool refresh = !expire_on_idle_ || !is_zero(*msg);
+    if (refresh) {
+      stamp_ = now;
     }
-    stamp_ = mux_->now();
-    msg_ = *msg;
+    store(msg);
 
     // Check if this twist has priority.
-    // Note that we have to check all the locks because they might time out
-    // and since we have several topics we must look for the highest one in
-    // all the topic list; so far there's no O(1) solution.
-    if (mux_->hasPriority(*this)) {
+    // The arbiter keeps the winner and the lock priority up to date on every
+    // message and expiry, so this is a cached lookup and an id compare.
+    const auto start = std::chrono::steady_clock::now();
+    mux_->updateInput(set, id_, now, refresh);
+    const bool has_priority = mux_->hasPriority(set, *this);
+    metrics_->recordArbitration(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    if (has_priority) {
+      metrics_->onForwarded();
       mux_->publishTwist(msg);
+    } else {
+      metrics_->onSuppressed();
     }
   }
 };
@@ -224,9 +322,14 @@ public:
     priority_type priority, bool expire_on_idle, TwistMux * mux)
   : base_type(name, topic, timeout, priority, expire_on_idle, mux)
   {
-    subscriber_ = mux_->create_subscription<geometry_msgs::msg::TwistStamped>(
-      topic_, rclcpp::SystemDefaultsQoS(),
-      std::bind(&VelocityStampedTopicHandle::callback, this, std::placeholders::_1));
+  }
+
+  void registerWith(Arbiter & arbiter)
+  {
+    id_ = arbiter.addInput(priority_, timeout_.nanoseconds());
+    if (stamp_.nanoseconds() > 0) {
+      arbiter.onInput(id_, stamp_.nanoseconds());
+    }
   }
 
   bool isMasked(priority_type lock_priority) const
@@ -234,19 +337,34 @@ public:
     return hasExpired() || (getPriority() < lock_priority);
   }
 
-  void callback(const geometry_msgs::msg::TwistStamped::ConstSharedPtr msg)
+  void callback(
+    const geometry_msgs::msg::TwistStamped::ConstSharedPtr msg, TwistMux::HandleSet & set)
   {
-    if(!expire_on_idle_ || !is_zero(msg->twist)){
-      stamp_ = mux_->now();
+    const rclcpp::Time now = mux_->now();
+    metrics_->onArrival(now.nanoseconds());
+    const rclcpp::Time sent(msg->header.stamp);
+    if (sent.nanoseconds() > 0) {
+      metrics_->recordStampLatency((now - sent).nanoseconds());
     }
-    msg_ = *msg;
-
-    // Check if this twist has priority.
-    // Note that we have to check all the locks because they might time out
-    // and since we have several topics we must look for the highest one in
-    // all the topic list; so far there's no O(1) solution.
-    if (mux_->hasPriorityStamped(*this)) {
+    const bool refresh = !expire_on_idle_ || !is_zero(msg->twist);
+    if (refresh) {
+      stamp_ = now;
+    }
+    store(msg);
+
+    // Check if this twist has priority (cached by the arbiter, see above).
+    const auto start = std::chrono::steady_clock::now();
+    mux_->updateInput(set, id_, now, refresh);
+    const bool has_priority = mux_->hasPriorityStamped(set, *this);
+    metrics_->recordArbitration(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    if (has_priority) {
+      metrics_->onForwarded();
       mux_->publishTwistStamped(msg);
+    } else {
+      metrics_->onSuppressed();
     }
   }
 };
@@ -264,9 +382,14 @@ public:
     priority_type priority, bool expire_on_idle, TwistMux * mux)
   : base_type(name, topic, timeout, priority, expire_on_idle, mux)
   {
-    subscriber_ = mux_->create_subscription<std_msgs::msg::Bool>(
-      topic_, rclcpp::SystemDefaultsQoS(),
-      std::bind(&LockTopicHandle::callback, this, std::placeholders::_1));
+  }
+
+  void registerWith(Arbiter & arbiter)
+  {
+    id_ = arbiter.addLock(priority_, timeout_.nanoseconds());
+    if (stamp_.nanoseconds() > 0) {
+      arbiter.onLock(id_, stamp_.nanoseconds(), getMessage().data);
+    }
   }
 
   /**
@@ -278,10 +401,13 @@ public:
     return hasExpired() || getMessage().data;
   }
 
-  void callback(const std_msgs::msg::Bool::ConstSharedPtr msg)
+  void callback(const std_msgs::msg::Bool::ConstSharedPtr msg, TwistMux::HandleSet & set)
   {
     stamp_ = mux_->now();
+    metrics_->onArrival(stamp_.nanoseconds());
     msg_ = *msg;
+
+    mux_->updateLock(set, id_, stamp_, msg_.data);
   }
 };
 
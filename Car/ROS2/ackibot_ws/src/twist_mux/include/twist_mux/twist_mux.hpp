@@ -36,13 +36,21 @@
 #define TWIST_MUX__TWIST_MUX_HPP_
 
 #include <rclcpp/rclcpp.hpp>
+#include <rcl_interfaces/msg/set_parameters_result.hpp>
 #include <std_msgs/msg/bool.hpp>
+#include <std_msgs/msg/float64_multi_array.hpp>
 #include <geometry_msgs/msg/twist.hpp>
 #include <geometry_msgs/msg/twist_stamped.hpp>
 
-#include <list>
+#include <twist_mux/arbiter.hpp>
+#include <twist_mux/command_smoother.hpp>
+#include <twist_mux/handle_storage.hpp>
+
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 using std::chrono_literals::operator""s;
 
@@ -62,28 +70,129 @@ class LockTopicHandle;
 class TwistMux : public rclcpp::Node
 {
 public:
+  /**
+   * Handles are stored contiguously, sorted by priority (highest first, ties
+   * in configuration order), and keep their address for their lifetime.
+   */
   template<typename T>
-  using handle_container = std::list<T>;
+  using handle_container = HandleArray<T>;
 
   using velocity_topic_container = handle_container<VelocityTopicHandle>;
   using velocity_stamped_topic_container = handle_container<VelocityStampedTopicHandle>;
   using lock_topic_container = handle_container<LockTopicHandle>;
 
-  TwistMux();
+  /**
+   * @brief TwistMux Reads the topics and locks and starts multiplexing.
+   * Doubles as the rclcpp component constructor, so the node can be loaded
+   * into a container next to its consumer and share intra-process messages.
+   */
+  explicit TwistMux(const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
   ~TwistMux() = default;
 
   void init();
 
-  bool hasPriority(const VelocityTopicHandle & twist);
+  /**
+   * @brief HandleSet One configuration of inputs and locks together with its
+   * arbitration state. Handles are at the position of their arbiter id.
+   *
+   * A set is never changed in structure once it is active: reconfigure()
+   * builds a complete new set and swaps it in under mutex(). Callbacks load
+   * the active set under the same mutex and hold it by shared_ptr until they
+   * return, so a handle id is only ever applied to the arbiter of its own set.
+   */
+  struct HandleSet
+  {
+    std::shared_ptr<velocity_topic_container> velocity_hs;
+    std::shared_ptr<velocity_stamped_topic_container> velocity_stamped_hs;
+    std::shared_ptr<lock_topic_container> lock_hs;
+
+    // Position of each handle by its interned name (Arbiter::NONE if absent).
+    std::vector<Arbiter::id_type> slot;
+
+    // Cached winner and lock priority, so priority checks are O(1).
+    Arbiter arbiter;
+  };
+
+  /**
+   * @brief reconfigure Rebuild the inputs and locks from the current topics
+   * and locks parameters and swap them in. Handles that keep their name carry
+   * over their last message, stamp and metrics, and subscriptions whose topic
+   * did not change are kept, so command flow is not interrupted.
+   * @throw ParamsHelperException if the configuration is incomplete
+   */
+  void reconfigure();
+
+  /**
+   * @brief current The active handle set (valid until the next reconfigure()).
+   * Without mutex() held this is only safe from the thread that reconfigures.
+   */
+  HandleSet & current() const
+  {
+    return *std::atomic_load(&handles_);
+  }
+
+  /**
+   * @brief mutex Serializes the message callbacks, the timers and reconfigure():
+   * the arbiters, handle state, last winner, expiry timer and status are all
+   * guarded by it, so the node is safe under a multi-threaded executor.
+   */
+  std::mutex & mutex() const
+  {
+    return mutex_;
+  }
+
+  /**
+   * @brief updateInput / updateLock Report a message arrival to the arbiter
+   * of set, the set the callback's handle belongs to. Called with mutex() held.
+   */
+  void updateInput(HandleSet & set, Arbiter::id_type id, const rclcpp::Time & now, bool refresh);
+
+  void updateLock(HandleSet & set, Arbiter::id_type id, const rclcpp::Time & now, bool locked);
+
+  /**
+   * @brief internName / getInternedName Handle names and topics are interned
+   * while loading the configuration; handles keep only the id.
+   */
+  NameTable::id_type internName(const std::string & name)
+  {
+    return names_.intern(name);
+  }
+
+  const std::string & getInternedName(NameTable::id_type id) const
+  {
+    return names_[id];
+  }
 
-  bool hasPriorityStamped(const VelocityStampedTopicHandle & twist);
+  bool hasPriority(const HandleSet & set, const VelocityTopicHandle & twist);
+
+  bool hasPriorityStamped(const HandleSet & set, const VelocityStampedTopicHandle & twist);
 
   void publishTwist(const geometry_msgs::msg::Twist::ConstSharedPtr & msg);
 
   void publishTwistStamped(const geometry_msgs::msg::TwistStamped::ConstSharedPtr & msg);
 
+  void updateStatus();
+
   void updateDiagnostics();
 
+  /**
+   * @brief isZeroCopy True if handles keep only the message pointer and the
+   * output is forwarded through loaned messages when the middleware can loan.
+   */
+  bool isZeroCopy() const
+  {
+    return zero_copy_;
+  }
+
+  /**
+   * @brief isFixedRate True if the output is published by the output
+   * scheduler at output_rate instead of on every winning message.
+   */
+  bool isFixedRate() const
+  {
+    return output_timer_ != nullptr;
+  }
+
 protected:
   typedef TwistMuxDiagnostics diagnostics_type; // Tip koji rukuje ROS2 dijagnostikom za twist_mux
   typedef TwistMuxDiagnosticsStatus status_type;  // Struktura u kojoj se čuva trenutno stanje (izvori, lockovi, prioriteti…)
@@ -93,27 +202,50 @@ protected:
   static constexpr std::chrono::duration<int64_t> DIAGNOSTICS_PERIOD = 1s;  // Konstanta → koliko često se pokreće dijagnostika (ovde svake 1 sekunde)
 
   /**
-   * @brief velocity_hs_ Velocity topics' handles.
-   * Note that if we use a vector, as a consequence of the re-allocation and
-   * the fact that we have a subscriber inside with a pointer to 'this', we
-   * must reserve the number of handles initially.
+   * @brief handles_ Aktivni skup handle-ova (HandleSet):
+   * velocity_hs – izvori cmd_vel poruka (joystick, nav2, keyboard...),
+   * velocity_stamped_hs – izvori tipa geometry_msgs::TwistStamped (use_stamped = true),
+   * lock_hs – lock topici (emergency stop, loop closure...).
+   * Svaki handle sadrži topic, timeout i prioritet; subscription je u feeds_.
+   *
+   * Čita se i menja samo preko std::atomic_load / std::atomic_store. Callback drži svoj
+   * shared_ptr do kraja, pa skup koji je zamenjen živi dok ga poslednji korisnik ne pusti.
    */
+  std::shared_ptr<HandleSet> handles_;
 
   /**
-   * @brief velocity_hs_ Lista handle-ova za sve izvore cmd_vel poruka (joystick, nav2, keyboard...)
-   * Svaki handle sadrži topic, timeout, prioritet i subscriber.
+   * @brief mutex_ Štiti arbitre, stanje handle-ova, last_winner_, expiry tajmer, izlaz i status_
+   * (vidi mutex()). Drže ga callback-ovi subscription-a, tajmeri i reconfigure().
    */
+  mutable std::mutex mutex_;
+
   /**
-   * @brief velocity_stamped_hs_ Lista handle-ova za izvore tipa geometry_msgs::TwistStamped.
-   * Koristi se kada je parametar use_stamped = true.
+   * @brief feeds_ Subscription po internovanom imenu handle-a. Preživljava rekonfiguraciju
+   * dok se topic ne promeni; callback preko slot-a aktivnog skupa nalazi handle.
    */
+  struct Feed
+  {
+    NameTable::id_type topic = 0;
+    rclcpp::SubscriptionBase::SharedPtr subscription;
+  };
+  std::vector<Feed> feeds_;
+
+  bool use_stamped_ = true;
+
   /**
-   * @brief lock_hs_ Lista handle-ova za sve lock topike (emergency stop, loop closure...).
-   * Ako je neki lock aktivan → blokira određene izvore prema prioritetu.
+   * @brief param_callback_ Prihvata promene topics.* / locks.* parametara u toku rada;
+   * sama rekonfiguracija se izvrši iz reconfigure_timer_-a, kada su nove vrednosti upisane.
    */
-  std::shared_ptr<velocity_topic_container> velocity_hs_;
-  std::shared_ptr<velocity_stamped_topic_container> velocity_stamped_hs_;
-  std::shared_ptr<lock_topic_container> lock_hs_;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr param_callback_;
+  rclcpp::TimerBase::SharedPtr reconfigure_timer_;
+
+  rcl_interfaces::msg::SetParametersResult onSetParameters(
+    const std::vector<rclcpp::Parameter> & parameters);
+
+  void scheduleReconfigure();
+
+  template<typename H>
+  void subscribe(const H & handle, std::shared_ptr<handle_container<H>> HandleSet::* handles);
 
   /**
    * @brief cmd_pub_ Publisher za izlazni topic /cmd_vel_out tipa Twist.
@@ -133,12 +265,73 @@ protected:
   geometry_msgs::msg::Twist last_cmd_;
   geometry_msgs::msg::TwistStamped last_cmd_stamped_;
 
+  /**
+   * @brief zero_copy_ Parametar zero_copy: bez kopiranja ulaznih poruka (vidi isZeroCopy()).
+   */
+  bool zero_copy_ = false;
+
+  /**
+   * @brief output_timer_ Izlazni raspoređivač: na output_rate_ [Hz] šalje komandu trenutnog
+   * pobednika, ograničenu po ubrzanju i trzaju (smoother_), ili nultu komandu ako pobednika nema.
+   * Ne postoji ako je output_rate = 0 (izlaz ide odmah sa svakom porukom pobednika).
+   */
+  rclcpp::TimerBase::SharedPtr output_timer_;
+  double output_rate_ = 0.0;
+  CommandSmoother smoother_;
+  rclcpp::Time last_output_;
+
+  void publishOutput();
+
+  void sendTwist(const geometry_msgs::msg::Twist & msg);
+
+  void sendTwistStamped(const geometry_msgs::msg::TwistStamped & msg);
 
   template<typename T>
-  void getTopicHandles(const std::string & param_name, handle_container<T> & topic_hs);
+  void getParam(const std::string & name, T & value);
+
+  /**
+   * @brief expiry_timer_ Budi se tačno na najraniji rok isteka nekog handle-a (vidi armExpiry()),
+   * tako da istekli ulazi i lock-ovi odmah menjaju arbitražu, bez čekanja na sledeću poruku.
+   * Jednokratan, na satu node-a; expiry_pending_ je true dok je naoružan.
+   */
+  rclcpp::TimerBase::SharedPtr expiry_timer_;
+  Arbiter::time_type expiry_armed_ = 0;
+  bool expiry_pending_ = false;
+  Arbiter::id_type last_winner_ = Arbiter::NONE;
+
+  /**
+   * @brief publish_stop_on_expiry_ Parametar: pošalji nultu komandu kada pobednik istekne
+   * (ili ga lock maskira), a niko drugi ne preuzme.
+   */
+  bool publish_stop_on_expiry_ = false;
+
+  void armExpiry(Arbiter::time_type deadline, Arbiter::time_type now);
+
+  void onExpiry();
+
+  void rearbitrate(HandleSet & set, const rclcpp::Time & now);
+
+  /**
+   * @brief metrics_pub_ Kompaktni topic ~/metrics sa brojačima svih handle-ova (vidi publishMetrics()).
+   */
+  rclcpp::Publisher<std_msgs::msg::Float64MultiArray>::SharedPtr metrics_pub_;
+  std_msgs::msg::Float64MultiArray metrics_msg_;
+
+  void publishMetrics();
+
+
+  template<typename T>
+  void getTopicHandles(
+    const std::string & param_name, handle_container<T> & topic_hs,
+    const HandleSet * previous, std::shared_ptr<handle_container<T>> HandleSet::* handles);
 
   int getLockPriority();
 
+  /**
+   * @brief names_ Internovana imena i topici handle-ova.
+   */
+  NameTable names_;
+
   /**
    * @brief diagnostics_ Objekat koji obavlja integraciju sa ROS2 diagnostic_updater.
    * Publikuje info o izvorima, lockovima, starosti podataka itd.
@@ -152,7 +345,7 @@ protected:
 
   /*
   * UKRATKO:
-  * velocity_hs_, velocity_stamped_hs_, lock_hs_ → ulazi i blokade.
+  * handles_ (velocity_hs, velocity_stamped_hs, lock_hs, arbiter) → ulazi i blokade.
   * cmd_pub_, cmd_pub_stamped_ → izlazi (/cmd_vel_out).
   * last_cmd_, last_cmd_stamped_ → pamćenje poslednje poruke.
   * diagnostics_, status_, diagnostics_timer_ → periodično ažuriranje i objavljivanje zdravstvenog stanja.
@@ -40,6 +40,7 @@
 #include <diagnostic_updater/diagnostic_updater.hpp>
 
 #include <memory>
+#include <mutex>
 
 namespace twist_mux
 {
@@ -71,6 +72,9 @@ public:
 
   void update();
 
+  /**
+   * @brief updateStatus Kopira status; poziva se sa TwistMux::mutex(), a update() posle, bez njega.
+   */
   void updateStatus(const status_type::ConstPtr & status);
 
 private:
@@ -85,6 +89,7 @@ private:
   };
 
   std::shared_ptr<diagnostic_updater::Updater> diagnostic_; // Glavni objekat iz `diagnostic_updater` biblioteke koji vodi računa o registraciji i objavljivanju dijagnostike.
+  std::mutex * mutex_; // TwistMux::mutex(): čuva status_ i handle-ove dok se pravi izveštaj.
   std::shared_ptr<status_type> status_; // Kopija trenutnog statusa sistema (velocity izvori, lockovi, prioriteti…), koja se koristi da bi se popunio dijagnostički izveštaj.
 };
 }  // namespace twist_mux
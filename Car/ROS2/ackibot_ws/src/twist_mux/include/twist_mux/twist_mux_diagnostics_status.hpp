@@ -40,7 +40,9 @@
 
 #include <rclcpp/rclcpp.hpp>
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace twist_mux
 {
@@ -61,6 +63,9 @@ struct TwistMuxDiagnosticsStatus
   std::shared_ptr<TwistMux::velocity_stamped_topic_container> velocity_stamped_hs;
   std::shared_ptr<TwistMux::lock_topic_container> lock_hs;
 
+  // Broj promena locked <-> free po lock-u, redom kao u lock_hs.
+  std::vector<std::uint64_t> lock_transitions;
+
   TwistMuxDiagnosticsStatus()
   : reading_age(0),
     last_loop_update(rclcpp::Clock().now()),
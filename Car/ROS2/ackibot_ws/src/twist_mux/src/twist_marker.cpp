@@ -38,8 +38,10 @@
 #include <visualization_msgs/msg/marker.hpp>
 #include <visualization_msgs/msg/marker_array.hpp>
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
 
 /**
  * Ovo je ROS2 C++ čvor (node) koji:
@@ -48,17 +50,22 @@
  *  - i šalje ih na ROS topic da bi se mogle prikazati npr. u RViz-u.
 */
 
-// Ova klasa enkapsulira jedan Marker (strelicu u RViz-u)
+// Ova klasa popunjava jedan Marker (strelicu u RViz-u).
+// Marker nije njen: pripada poruci koju čvor objavljuje (Marker ili element MarkerArray-a),
+// pa se pri svakom twist-u menjaju samo tačke strelice, bez pravljenja nove poruke.
 class TwistMarker
 {
 public:
   /**
+   * marker - poruka koju ova klasa popunjava (mora živeti duže od TwistMarker-a).
    * frame_id - koordinatni sistem u kojem će se marker crtati (npr. base_footprint).
    * scale - skala (veličina) markera.
    * z - vertikalna pozicija.
    */
-  TwistMarker(std::string & frame_id, double scale, double z)
-  : frame_id_(frame_id), scale_(scale), z_(z)
+  TwistMarker(
+    visualization_msgs::msg::Marker & marker, const std::string & frame_id, double scale,
+    double z)
+  : marker_(marker), frame_id_(frame_id), scale_(scale), z_(z)
   {
     // ID and type:
     marker_.id = 0;
@@ -78,15 +85,27 @@ public:
     marker_.scale.y = 2 * marker_.scale.x;
 
     // Color:
-    marker_.color.a = 1.0; // Predstavlja providnost (1.0 znaci potpuno vidljivo)
-    marker_.color.r = 0.0;
-    marker_.color.g = 1.0;
-    marker_.color.b = 0.0;
+    setColor(0.0, 1.0, 0.0);
 
     // Error when all points are zero:
     marker_.points[1].z = 0.01;
   }
 
+  // Namespace i id razlikuju markere u MarkerArray-u (RViz ih prikazuje po namespace-u).
+  void setId(const std::string & ns, int id)
+  {
+    marker_.ns = ns;
+    marker_.id = id;
+  }
+
+  void setColor(double r, double g, double b)
+  {
+    marker_.color.a = 1.0; // Predstavlja providnost (1.0 znaci potpuno vidljivo)
+    marker_.color.r = r;
+    marker_.color.g = g;
+    marker_.color.b = b;
+  }
+
   // Ažurira se dužina i orijentacija strelice na osnovu ulaznog twist
   void update(const geometry_msgs::msg::Twist & twist)
   {
@@ -105,13 +124,13 @@ public:
   }
 
   // Getter za marker (koristi publisher kasnije)
-  const visualization_msgs::msg::Marker & getMarker()
+  const visualization_msgs::msg::Marker & getMarker() const
   {
     return marker_;
   }
 
 private:
-  visualization_msgs::msg::Marker marker_; // Objekt koji šaljemo u RViz
+  visualization_msgs::msg::Marker & marker_; // Objekt koji šaljemo u RViz
 
   std::string frame_id_;
   double scale_;
@@ -120,12 +139,17 @@ private:
 
 /**
  * Ovo je ROS2 čvor koji:
- *  - Čita parametre (frame_id, scale, use_stamped, vertical_position).
- *  - Kreira instancu TwistMarker.
+ *  - Čita parametre (frame_id, scale, use_stamped, vertical_position, max_rate, marker_array, inputs).
+ *  - Kreira instancu TwistMarker za izlaz (i za svaki ulaz u MarkerArray modu).
  *  - Postavlja subscriber na twist topic:
  *      - Ako je use_stamped = true → koristi geometry_msgs::msg::TwistStamped.
  *      - Inače koristi obični geometry_msgs::msg::Twist.
- *  - Kreira publisher za visualization_msgs::msg::Marker na topicu marker.
+ *  - Kreira publisher za visualization_msgs::msg::Marker na topicu marker, ili
+ *    visualization_msgs::msg::MarkerArray na topicu markers (marker_array = true).
+ *
+ * Poruke se ne objavljuju na svaki twist: callback samo ažurira unapred alociran marker,
+ * a tajmer na max_rate objavi poslednje stanje ako se nešto promenilo. Tako 1 kHz
+ * komandi postaje najviše max_rate poruka u sekundi ka RViz-u.
  */
 class TwistMarkerPublisher : public rclcpp::Node
 {
@@ -137,65 +161,130 @@ public:
     double scale;
     bool use_stamped = true;
     double z;
+    bool marker_array = false;
+    std::vector<std::string> inputs;
 
     // Deklaracija ROS parametara (sa default vrijednostima)
     this->declare_parameter("frame_id", "base_footprint");
     this->declare_parameter("scale", 1.0);
     this->declare_parameter("use_stamped", true);
     this->declare_parameter("vertical_position", 2.0);
+    this->declare_parameter("max_rate", 10.0); // [Hz], 0 = objavi svaki twist
+    this->declare_parameter("marker_array", false);
+    this->declare_parameter("inputs", std::vector<std::string>());
 
     // Čitanje parametara u varijable
     this->get_parameter<std::string>("frame_id", frame_id);
     this->get_parameter<double>("scale", scale);
     this->get_parameter<bool>("use_stamped", use_stamped);
     this->get_parameter<double>("vertical_position", z);
-
-    // Inicijalizacija markera
-    marker_ = std::make_shared<TwistMarker>(frame_id, scale, z);
-
-    // Subscriber na topic "twist"
-    if (use_stamped)
-    {
-      sub_stamped_ = this->create_subscription<geometry_msgs::msg::TwistStamped>(
-        "twist", rclcpp::SystemDefaultsQoS(),
-        std::bind(&TwistMarkerPublisher::callback_stamped, this, std::placeholders::_1));
+    this->get_parameter<double>("max_rate", max_rate_);
+    this->get_parameter<bool>("marker_array", marker_array);
+    this->get_parameter<std::vector<std::string>>("inputs", inputs);
+
+    // Inicijalizacija markera. Poruka se alocira jednom; TwistMarker-i drže reference
+    // na njene elemente, pa se markers.size() posle ovoga ne sme menjati.
+    if (marker_array) {
+      array_msg_.markers.resize(1 + inputs.size());
+      markers_.reserve(array_msg_.markers.size());
+
+      // Izlaz je zelen, ulazi su narandžasti i naslagani iznad njega.
+      markers_.emplace_back(array_msg_.markers[0], frame_id, scale, z);
+      markers_[0].setId("output", 0);
+      for (std::size_t i = 0; i < inputs.size(); ++i) {
+        markers_.emplace_back(
+          array_msg_.markers[1 + i], frame_id, scale, z + 0.25 * scale * (1 + i));
+        markers_.back().setId(inputs[i], static_cast<int>(1 + i));
+        markers_.back().setColor(1.0, 0.5, 0.0);
+      }
+    } else {
+      markers_.emplace_back(marker_msg_, frame_id, scale, z);
     }
-    else
-    {
-      sub_ = this->create_subscription<geometry_msgs::msg::Twist>(
-        "twist", rclcpp::SystemDefaultsQoS(),
-        std::bind(&TwistMarkerPublisher::callback, this, std::placeholders::_1));
+
+    // Subscriber na topic "twist" (izlaz mux-a) i na svaki ulaz
+    subscribe("twist", 0, use_stamped);
+    for (std::size_t i = 0; marker_array && i < inputs.size(); ++i) {
+      subscribe(inputs[i], 1 + i, use_stamped);
     }
 
     // Publisher za marker
-    pub_ =
-      this->create_publisher<visualization_msgs::msg::Marker>(
-      "marker",
-      rclcpp::QoS(rclcpp::KeepLast(1)));
+    if (marker_array) {
+      array_pub_ = this->create_publisher<visualization_msgs::msg::MarkerArray>(
+        "markers",
+        rclcpp::QoS(rclcpp::KeepLast(1)));
+    } else {
+      pub_ =
+        this->create_publisher<visualization_msgs::msg::Marker>(
+        "marker",
+        rclcpp::QoS(rclcpp::KeepLast(1)));
+    }
+
+    // Tajmer objavljuje najviše max_rate puta u sekundi, i samo ako je stiglo nešto novo
+    if (max_rate_ > 0.0) {
+      publish_timer_ = this->create_wall_timer(
+        std::chrono::nanoseconds(static_cast<int64_t>(1e9 / max_rate_)),
+        [this]() -> void {
+          if (dirty_) {
+            publish();
+          }
+        });
+    }
   }
 
   // Callback kada stigne obični Twist
-  void callback(const geometry_msgs::msg::Twist::ConstSharedPtr twist)
+  void callback(std::size_t index, const geometry_msgs::msg::Twist & twist)
   {
-    marker_->update(*twist);
+    markers_[index].update(twist);
 
-    pub_->publish(marker_->getMarker());
+    dirty_ = true;
+    if (!publish_timer_) {
+      publish();
+    }
   }
 
-  // Callback kada stigne TwistStamped
-  void callback_stamped(const geometry_msgs::msg::TwistStamped::ConstSharedPtr twist)
+private:
+  void subscribe(const std::string & topic, std::size_t index, bool use_stamped)
   {
-    marker_->update(twist->twist);
+    if (use_stamped) {
+      subs_stamped_.push_back(
+        this->create_subscription<geometry_msgs::msg::TwistStamped>(
+          topic, rclcpp::SystemDefaultsQoS(),
+          [this, index](const geometry_msgs::msg::TwistStamped::ConstSharedPtr twist) {
+            callback(index, twist->twist);
+          }));
+    } else {
+      subs_.push_back(
+        this->create_subscription<geometry_msgs::msg::Twist>(
+          topic, rclcpp::SystemDefaultsQoS(),
+          [this, index](const geometry_msgs::msg::Twist::ConstSharedPtr twist) {
+            callback(index, *twist);
+          }));
+    }
+  }
 
-    pub_->publish(marker_->getMarker());
+  // Objavljuje unapred alociranu poruku; svi twist-ovi od prethodnog objavljivanja su spojeni u nju
+  void publish()
+  {
+    dirty_ = false;
+    if (array_pub_) {
+      array_pub_->publish(array_msg_);
+    } else {
+      pub_->publish(marker_msg_);
+    }
   }
 
-private:
-  rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr sub_; // subscriber za Twist
-  rclcpp::Subscription<geometry_msgs::msg::TwistStamped>::SharedPtr sub_stamped_; // subscriber za TwistStamped
+  std::vector<rclcpp::Subscription<geometry_msgs::msg::Twist>::SharedPtr> subs_; // subscriber-i za Twist
+  std::vector<rclcpp::Subscription<geometry_msgs::msg::TwistStamped>::SharedPtr> subs_stamped_; // subscriber-i za TwistStamped
   rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr pub_; // publisher markera
+  rclcpp::Publisher<visualization_msgs::msg::MarkerArray>::SharedPtr array_pub_; // publisher niza markera
+  rclcpp::TimerBase::SharedPtr publish_timer_; // ogranicava broj objavljenih poruka na max_rate
+
+  visualization_msgs::msg::Marker marker_msg_; // poruka u Marker modu
+  visualization_msgs::msg::MarkerArray array_msg_; // poruka u MarkerArray modu: [0] izlaz, [1..] ulazi
+  std::vector<TwistMarker> markers_; // [0] izlaz, [1..] ulazi
 
-  std::shared_ptr<TwistMarker> marker_ = nullptr;
+  double max_rate_ = 10.0;
+  bool dirty_ = false; // ima neobjavljenih promena
 };
 
 int main(int argc, char * argv[])
@@ -39,9 +39,16 @@
 #include <twist_mux/utils.hpp>
 #include <twist_mux/params_helpers.hpp>
 
-#include <list>
+#include <rcl/error_handling.h>
+#include <rcl/timer.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 /**
  * @brief hasIncreasedAbsVelocity Check if the absolute velocity has increased
@@ -63,16 +70,37 @@ bool hasIncreasedAbsVelocity(
   return (old_linear_x < new_linear_x) || (old_angular_z < new_angular_z);
 }
 
+/**
+ * @brief publishLoaned Publish msg from a middleware-loaned buffer if the
+ * middleware supports loaning (shared memory, no serialization); otherwise
+ * publish by reference, which does not allocate for inter-process
+ * subscribers. Intra-process subscribers still get a copy in a new
+ * unique_ptr, since msg belongs to the input's shared message.
+ */
+template<typename T>
+void publishLoaned(rclcpp::Publisher<T> & pub, const T & msg)
+{
+  if (pub.can_loan_messages()) {
+    auto loaned = pub.borrow_loaned_message();
+    loaned.get() = msg;
+    pub.publish(std::move(loaned));
+  } else {
+    pub.publish(msg);
+  }
+}
+
 namespace twist_mux
 {
 // see e.g. https://stackoverflow.com/a/40691657
 constexpr std::chrono::duration<int64_t> TwistMux::DIAGNOSTICS_PERIOD;
 
-TwistMux::TwistMux()
+TwistMux::TwistMux(const rclcpp::NodeOptions & options)
 : Node("twist_mux", "",
-    rclcpp::NodeOptions().allow_undeclared_parameters(
+    rclcpp::NodeOptions(options).allow_undeclared_parameters(
       true).automatically_declare_parameters_from_overrides(true))
 {
+  // Komponenta se kreira samo konstruktorom, pa se init() poziva ovde.
+  init();
 }
 
 /*
@@ -96,20 +124,11 @@ void TwistMux::init()
 
   auto nh = std::shared_ptr<rclcpp::Node>(this, [](rclcpp::Node *) {});
   fetch_param(nh, "use_stamped", use_stamped); // Pomocna wrap metoda za pronalazanje parametara
+  use_stamped_ = use_stamped;
 
-  /// Get topics and locks:
-  if(use_stamped)
-  {
-    velocity_stamped_hs_ = std::make_shared<velocity_stamped_topic_container>();
-    getTopicHandles("topics", *velocity_stamped_hs_);
-  }
-  else
-  {
-    velocity_hs_ = std::make_shared<velocity_topic_container>();
-    getTopicHandles("topics", *velocity_hs_);
-  }
-  lock_hs_ = std::make_shared<lock_topic_container>();
-  getTopicHandles("locks", *lock_hs_);
+  // Zero-copy: handle-ovi cuvaju samo pokazivac na poslednju poruku, izlaz ide preko loaned poruka.
+  getParam("zero_copy", zero_copy_);
+  getParam("publish_stop_on_expiry", publish_stop_on_expiry_);
 
   /// Publisher for output topic:
   if(use_stamped)
@@ -127,6 +146,32 @@ void TwistMux::init()
       rclcpp::QoS(rclcpp::KeepLast(1)));
   }
 
+  /// Fixed-rate output:
+  // Ako je output_rate > 0, izlaz se salje periodicno (vidi publishOutput()).
+  getParam("output_rate", output_rate_);
+  if (output_rate_ > 0.0) {
+    double linear_acceleration = 0.0;
+    double linear_jerk = 0.0;
+    double angular_acceleration = 0.0;
+    double angular_jerk = 0.0;
+    getParam("limits.linear.max_acceleration", linear_acceleration);
+    getParam("limits.linear.max_jerk", linear_jerk);
+    getParam("limits.angular.max_acceleration", angular_acceleration);
+    getParam("limits.angular.max_jerk", angular_jerk);
+    smoother_ = CommandSmoother(
+      linear_acceleration, linear_jerk, angular_acceleration, angular_jerk);
+
+    output_timer_ = this->create_wall_timer(
+      std::chrono::nanoseconds(static_cast<int64_t>(1e9 / output_rate_)),
+      [this]() -> void {
+        publishOutput();
+      });
+  }
+
+  /// Metrics:
+  metrics_pub_ = this->create_publisher<std_msgs::msg::Float64MultiArray>(
+    "~/metrics", rclcpp::QoS(rclcpp::KeepLast(1)));
+
   /// Diagnostics:
   // Kreiramo objekat klase TwistMuxDiagnostics koji je vezan na ovaj node
   // On će pratiti status i slati podatke u ROS2 diagnostics sistem (/diagnostics topic)
@@ -135,40 +180,243 @@ void TwistMux::init()
   // status_ je struktura u kojoj se čuvaju pokazivači na sve izvore i lockove
   // Popunjavamo koje liste treba pratiti
   status_ = std::make_shared<status_type>();
-  status_->velocity_hs = velocity_hs_;
-  status_->velocity_stamped_hs = velocity_stamped_hs_;
-  status_->lock_hs = lock_hs_;
   status_->use_stamped = use_stamped;
+
+  /// Get topics and locks:
+  // Isti put kao kasnija rekonfiguracija; ovde greska u konfiguraciji prekida pokretanje.
+  reconfigure();
+
+  // Promene topics.* / locks.* parametara u toku rada dodaju, uklanjaju ili menjaju ulaze.
+  param_callback_ = this->add_on_set_parameters_callback(
+    [this](const std::vector<rclcpp::Parameter> & parameters) {
+      return onSetParameters(parameters);
+    });
   
   // Tajmer koji se pokreće svakih DIAGNOSTICS_PERIOD sekundi (~1 sekund)
-  // Svaki put kad otkuca, poziva se metoda updateDiagnostics()
+  // Svaki put kad otkuca, poziva se metoda updateDiagnostics() i objavljuju se metrike
   // Ta metoda ažurira status i prosleđuje ga TwistMuxDiagnostics objektu
   // Ova linija koda postavlja periodičnu proveru zdravlja sistema.
   diagnostics_timer_ = this->create_wall_timer(
     DIAGNOSTICS_PERIOD, [this]() -> void {
       updateDiagnostics();
+      publishMetrics();
     });
 }
 
-void TwistMux::updateDiagnostics()
+/**
+ * @brief Upisuje stanje arbitraže u status_; ništa ne objavljuje.
+ *
+ * Zove se i iz komandnog puta (rearbitrate()), a objavljuje samo tajmer dijagnostike.
+ * Pozivalac drži mutex_.
+ */
+void TwistMux::updateStatus()
 {
   // status_->priority je vrednost koju dijagnostika kasnije koristi da odredi: koji izvori brzine su trenutno maskirani, ko ima prednost u odnosu na druge, i koje lock-ove treba prikazati kao aktivne.
+  const Arbiter & arbiter = current().arbiter;
   status_->priority = getLockPriority();
-  RCLCPP_DEBUG(get_logger(), "updateDiagnostics: lol");
-  diagnostics_->updateStatus(status_);
-  RCLCPP_DEBUG(get_logger(), "returned from updateStatus");
+  status_->lock_transitions.resize(arbiter.lockCount());
+  for (Arbiter::id_type id = 0; id < arbiter.lockCount(); ++id) {
+    status_->lock_transitions[id] = arbiter.lockTransitions(id);
+  }
+}
+
+void TwistMux::updateDiagnostics()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    updateStatus();
+    diagnostics_->updateStatus(status_);
+  }
+  // Izveštaj sam uzima mutex_ (vidi TwistMuxDiagnostics::diagnostics()).
+  diagnostics_->update();
 }
 
 void TwistMux::publishTwist(const geometry_msgs::msg::Twist::ConstSharedPtr & msg)
 {
-  // cmd_pub_ je publisher za izlazni topic cmd_vel_out
-  cmd_pub_->publish(*msg);
+  // U fixed-rate modu izlaz salje publishOutput().
+  if (isFixedRate()) {
+    return;
+  }
+  sendTwist(*msg);
 }
 
 void TwistMux::publishTwistStamped(const geometry_msgs::msg::TwistStamped::ConstSharedPtr & msg)
+{
+  if (isFixedRate()) {
+    return;
+  }
+  sendTwistStamped(*msg);
+}
+
+void TwistMux::sendTwist(const geometry_msgs::msg::Twist & msg)
+{
+  // cmd_pub_ je publisher za izlazni topic cmd_vel_out
+  if (zero_copy_) {
+    publishLoaned(*cmd_pub_, msg);
+  } else {
+    cmd_pub_->publish(msg);
+  }
+}
+
+void TwistMux::sendTwistStamped(const geometry_msgs::msg::TwistStamped & msg)
 {
   // cmd_pub_stamped_ je publisher za izlazni topic cmd_vel_out
-  cmd_pub_stamped_->publish(*msg);
+  if (zero_copy_) {
+    publishLoaned(*cmd_pub_stamped_, msg);
+  } else {
+    cmd_pub_stamped_->publish(msg);
+  }
+}
+
+/**
+ * @brief Izlazni raspoređivač (fixed-rate mod), poziva ga output_timer_.
+ *
+ * Šalje poslednju komandu trenutnog pobednika sa ograničenim ubrzanjem i trzajem
+ * na linear.x i angular.z. Ako pobednika nema (svi ulazi su istekli ili su
+ * maskirani lock-om) odmah šalje nultu komandu.
+ */
+void TwistMux::publishOutput()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const rclcpp::Time now = this->now();
+  const std::shared_ptr<HandleSet> active = std::atomic_load(&handles_);
+  HandleSet & set = *active;
+  set.arbiter.advance(now.nanoseconds());
+  const auto winner = set.arbiter.winner();
+
+  double dt = 1.0 / output_rate_;
+  if (last_output_.nanoseconds() > 0) {
+    dt = (now - last_output_).seconds();
+  }
+  last_output_ = now;
+
+  if (winner == Arbiter::NONE) {
+    smoother_.reset();
+  }
+
+  if (cmd_pub_) {
+    geometry_msgs::msg::Twist out;
+    if (winner != Arbiter::NONE) {
+      smoother_.step((*set.velocity_hs)[winner].getMessage(), dt, out);
+    }
+    sendTwist(out);
+  } else {
+    geometry_msgs::msg::TwistStamped out;
+    if (winner != Arbiter::NONE) {
+      const auto & in = (*set.velocity_stamped_hs)[winner].getMessage();
+      out.header.frame_id = in.header.frame_id;
+      smoother_.step(in.twist, dt, out.twist);
+    }
+    out.header.stamp = now;
+    sendTwistStamped(out);
+  }
+}
+
+namespace
+{
+// Kolone ~/metrics poruke, redom.
+const char * const METRICS_COLUMNS =
+  "rate_hz,received,forwarded,suppressed,lock_transitions,jitter_p50_us,jitter_p99_us,"
+  "stamp_latency_mean_us,stamp_latency_max_us,arbitration_mean_ns,arbitration_max_ns";
+constexpr std::size_t METRICS_COLUMN_COUNT = 11;
+
+void fillMetricsRow(
+  double * row, double rate, const HandleMetrics & m, std::uint64_t lock_transitions)
+{
+  row[0] = rate;
+  row[1] = static_cast<double>(m.received());
+  row[2] = static_cast<double>(m.forwarded());
+  row[3] = static_cast<double>(m.suppressed());
+  row[4] = static_cast<double>(lock_transitions);
+  row[5] = m.jitter().percentile(0.5) * 1e-3;
+  row[6] = m.jitter().percentile(0.99) * 1e-3;
+  row[7] = m.stampLatency().mean() * 1e-3;
+  row[8] = m.stampLatency().max() * 1e-3;
+  row[9] = m.arbitration().mean();
+  row[10] = static_cast<double>(m.arbitration().max());
+}
+}  // namespace
+
+/**
+ * @brief Objavljuje brojače svih handle-ova na ~/metrics (std_msgs/Float64MultiArray).
+ *
+ * Jedan red po handle-u (prvo ulazi, pa lock-ovi), kolone su u METRICS_COLUMNS;
+ * imena redova su u layout.dim[0].label. Zove se samo iz tajmera dijagnostike:
+ * updateRate() računa protok od prethodnog poziva, pa prozor mora biti stalan.
+ */
+void TwistMux::publishMetrics()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::int64_t now_ns = this->now().nanoseconds();
+  const std::shared_ptr<HandleSet> active = std::atomic_load(&handles_);
+  const HandleSet & set = *active;
+
+  const std::size_t velocity_rows = set.velocity_hs ? set.velocity_hs->size() : 0;
+  const std::size_t stamped_rows =
+    set.velocity_stamped_hs ? set.velocity_stamped_hs->size() : 0;
+  const std::size_t rows = velocity_rows + stamped_rows + set.lock_hs->size();
+
+  // Layout (i string sa imenima) se pravi samo kad se skup handle-ova promeni.
+  auto & layout = metrics_msg_.layout;
+  if (layout.dim.size() != 2 || layout.dim[0].size != rows) {
+    std::string names;
+    const auto add_names = [&names](const auto & handles) {
+        for (const auto & h : handles) {
+          names += (names.empty() ? "" : ",") + h.getName();
+        }
+      };
+    if (set.velocity_hs) {
+      add_names(*set.velocity_hs);
+    }
+    if (set.velocity_stamped_hs) {
+      add_names(*set.velocity_stamped_hs);
+    }
+    add_names(*set.lock_hs);
+    layout.dim.resize(2);
+    layout.dim[0].label = names;
+    layout.dim[0].size = rows;
+    layout.dim[0].stride = rows * METRICS_COLUMN_COUNT;
+    layout.dim[1].label = METRICS_COLUMNS;
+    layout.dim[1].size = METRICS_COLUMN_COUNT;
+    layout.dim[1].stride = METRICS_COLUMN_COUNT;
+    metrics_msg_.data.assign(rows * METRICS_COLUMN_COUNT, 0.0);
+  }
+
+  double * row = metrics_msg_.data.data();
+  const auto fill_inputs = [&row, now_ns](auto & handles) {
+      for (auto & h : handles) {
+        HandleMetrics & m = h.getMetrics();
+        fillMetricsRow(row, m.updateRate(now_ns), m, 0);
+        row += METRICS_COLUMN_COUNT;
+      }
+    };
+  if (set.velocity_hs) {
+    fill_inputs(*set.velocity_hs);
+  }
+  if (set.velocity_stamped_hs) {
+    fill_inputs(*set.velocity_stamped_hs);
+  }
+  Arbiter::id_type lock_id = 0;
+  for (auto & lock_h : *set.lock_hs) {
+    const double rate = lock_h.getMetrics().updateRate(now_ns);
+    fillMetricsRow(row, rate, lock_h.getMetrics(), set.arbiter.lockTransitions(lock_id++));
+    row += METRICS_COLUMN_COUNT;
+  }
+
+  metrics_pub_->publish(metrics_msg_);
+}
+
+/**
+ * @brief Deklarise (ako vec nije deklarisan) i ucitava parametar noda; value je podrazumevana vrednost.
+ */
+template<typename T>
+void TwistMux::getParam(const std::string & name, T & value)
+{
+  if (!this->has_parameter(name)) {
+    this->declare_parameter(name, value);
+  }
+  auto nh = std::shared_ptr<rclcpp::Node>(this, [](rclcpp::Node *) {});
+  fetch_param(nh, name, value);
 }
 
 /**
@@ -177,6 +425,8 @@ void TwistMux::publishTwistStamped(const geometry_msgs::msg::TwistStamped::Const
  * @tparam T – tip handle-a (VelocityTopicHandle, VelocityStampedTopicHandle ili LockTopicHandle).
  * @param param_name – prefiks u parametru (npr. "topics" ili "locks").
  * @param topic_hs – lista u koju se dodaju kreirani handle-ovi.
+ * @param previous – prethodni skup handle-ova (nullptr pri pokretanju); handle istog imena predaje stanje.
+ * @param handles – kontejner u HandleSet-u koji odgovara tipu T.
  *
  * Funkcija radi sledeće:
  * 1. Pretraži sve parametre u okviru `param_name` (npr. "topics.joystick", "topics.navigation"...).
@@ -186,12 +436,24 @@ void TwistMux::publishTwistStamped(const geometry_msgs::msg::TwistStamped::Const
  * Na kraju, "twist_mux" ima listu svih izvora brzinskih komandi ili lock-ova koje može da prati i upoređuje po prioritetu.
  */
 template<typename T>
-void TwistMux::getTopicHandles(const std::string & param_name, std::list<T> & topic_hs)
+void TwistMux::getTopicHandles(
+  const std::string & param_name, handle_container<T> & topic_hs,
+  const HandleSet * previous, std::shared_ptr<handle_container<T>> HandleSet::* handles)
 {
   RCLCPP_DEBUG(get_logger(), "getTopicHandles: %s", param_name.c_str());
 
   rcl_interfaces::msg::ListParametersResult list = list_parameters({param_name}, 10);
 
+  struct Config
+  {
+    std::string name;
+    std::string topic;
+    double timeout;
+    int priority;
+    bool expire_on_idle;
+  };
+  std::vector<Config> configs;
+
   try {
     for (auto prefix : list.prefixes) {
       RCLCPP_DEBUG(get_logger(), "Prefix: %s", prefix.c_str());
@@ -213,85 +475,374 @@ void TwistMux::getTopicHandles(const std::string & param_name, std::list<T> & to
       RCLCPP_DEBUG(get_logger(), "Listed priority: %d", priority);
       RCLCPP_DEBUG(get_logger(), "Listed expire_on_idle: %s", expire_on_idle ? "true" : "false");
 
-      topic_hs.emplace_back(prefix, topic, std::chrono::duration<double>(timeout), priority, expire_on_idle, this);
+      // Prazan topic uklanja ulaz (npr. ros2 param set /twist_mux topics.tablet.topic "").
+      if (!topic.empty()) {
+        configs.push_back({prefix, topic, timeout, priority, expire_on_idle});
+      }
     }
   } catch (const ParamsHelperException & e) {
     RCLCPP_FATAL(get_logger(), "Error parsing params '%s':\n\t%s", param_name.c_str(), e.what());
     throw e;
   }
+
+  // Handle-ovi idu redom po prioritetu (najveci prvi, isti prioritet po redu iz konfiguracije),
+  // pa i id-jevi iz arbitra prate taj redosled. Kapacitet je fiksan, handle-ovi se ne pomeraju.
+  std::stable_sort(
+    configs.begin(), configs.end(),
+    [](const Config & a, const Config & b) {
+      return clamp(a.priority, 0, 255) > clamp(b.priority, 0, 255);
+    });
+
+  topic_hs.reserve(configs.size());
+  for (const auto & config : configs) {
+    T & handle = topic_hs.emplace_back(
+      config.name, config.topic, std::chrono::duration<double>(config.timeout),
+      config.priority, config.expire_on_idle, this);
+
+    // Handle istog imena iz prethodne konfiguracije predaje poslednju poruku, stamp i metrike.
+    if (previous && handle.getNameId() < previous->slot.size()) {
+      const Arbiter::id_type slot = previous->slot[handle.getNameId()];
+      const auto & previous_hs = previous->*handles;
+      if (slot != Arbiter::NONE && previous_hs && slot < previous_hs->size()) {
+        handle.adopt((*previous_hs)[slot]);
+      }
+    }
+  }
 }
 
-// Vraća najveći prioritet među aktivnim lockovima (ako nema lockova → 0).
-// Taj broj služi kao granica: svi izvori sa nižim ili jednakim prioritetom od aktivnog locka → smatraju se blokiranim.
-int TwistMux::getLockPriority()
+/**
+ * @brief Napravi novi skup handle-ova iz trenutnih topics.* / locks.* parametara i zameni aktivni.
+ *
+ * Novi skup (handle-ovi + arbitar) se pravi pod mutex_-om i zameni aktivni jednim
+ * std::atomic_store; callback-ovi za to vreme čekaju, pa nijedan ne vidi pola zamene.
+ * Callback koji je već uzeo stari skup drži ga svojim shared_ptr-om. Handle istog imena
+ * preuzima poslednju poruku, stamp i metrike, a subscription čiji se topic nije promenio ostaje,
+ * pa komanda ne prekida (nema ponovnog DDS discovery-ja). Ako konfiguracija nije potpuna,
+ * izuzetak izlazi pre bilo kakve promene i aktivni skup ostaje isti.
+ */
+void TwistMux::reconfigure()
 {
-  LockTopicHandle::priority_type priority = 0;
-
-  /// max_element on the priority of lock topic handles satisfying
-  /// that is locked:
-  for (const auto & lock_h : *lock_hs_) {
-    if (lock_h.isLocked()) {
-      auto tmp = lock_h.getPriority();
-      if (priority < tmp) {
-        priority = tmp;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const rclcpp::Time now = this->now();
+  const std::shared_ptr<HandleSet> active = std::atomic_load(&handles_);
+  const HandleSet * previous = active.get();
+
+  auto set = std::make_shared<HandleSet>();
+  if (use_stamped_) {
+    set->velocity_stamped_hs = std::make_shared<velocity_stamped_topic_container>();
+    getTopicHandles(
+      "topics", *set->velocity_stamped_hs, previous, &HandleSet::velocity_stamped_hs);
+  } else {
+    set->velocity_hs = std::make_shared<velocity_topic_container>();
+    getTopicHandles("topics", *set->velocity_hs, previous, &HandleSet::velocity_hs);
+  }
+  set->lock_hs = std::make_shared<lock_topic_container>();
+  getTopicHandles("locks", *set->lock_hs, previous, &HandleSet::lock_hs);
+
+  // Id iz arbitra je pozicija handle-a u kontejneru; slot ga nalazi po imenu.
+  set->slot.assign(names_.size(), Arbiter::NONE);
+  feeds_.resize(names_.size());
+  auto attach = [this, &set](auto & handles, auto member) {
+      if (!handles) {
+        return;
+      }
+      for (auto & handle : *handles) {
+        handle.registerWith(set->arbiter);
+        set->slot[handle.getNameId()] = handle.getId();
+        subscribe(handle, member);
       }
+    };
+  attach(set->velocity_hs, &HandleSet::velocity_hs);
+  attach(set->velocity_stamped_hs, &HandleSet::velocity_stamped_hs);
+  attach(set->lock_hs, &HandleSet::lock_hs);
+  set->arbiter.advance(now.nanoseconds());
+
+  // Poslednji pobednik po imenu, da se komanda ne posalje ponovo ako se pobednik nije promenio.
+  Arbiter::id_type last_winner = Arbiter::NONE;
+  if (previous && last_winner_ != Arbiter::NONE) {
+    const NameTable::id_type name = previous->velocity_hs ?
+      (*previous->velocity_hs)[last_winner_].getNameId() :
+      (*previous->velocity_stamped_hs)[last_winner_].getNameId();
+    last_winner = set->slot[name];
+  }
+
+  std::atomic_store(&handles_, set);
+  last_winner_ = last_winner;
+
+  // Uklonjeni handle-ovi gube subscription.
+  for (NameTable::id_type name = 0; name < feeds_.size(); ++name) {
+    if (set->slot[name] == Arbiter::NONE) {
+      feeds_[name].subscription.reset();
     }
   }
 
-  RCLCPP_DEBUG(get_logger(), "Priority = %d.", static_cast<int>(priority));
+  status_->velocity_hs = set->velocity_hs;
+  status_->velocity_stamped_hs = set->velocity_stamped_hs;
+  status_->lock_hs = set->lock_hs;
+  metrics_msg_.layout.dim.clear();
 
-  return priority;
+  // Rokovi isteka su u novom arbitru; tajmer se naoruža iznova.
+  if (expiry_timer_) {
+    expiry_timer_->cancel();
+  }
+  expiry_pending_ = false;
+  rearbitrate(*set, now);
+
+  Arbiter::time_type deadline;
+  if (set->arbiter.nextDeadline(deadline)) {
+    armExpiry(deadline, now.nanoseconds());
+  }
 }
 
-// Vraca odgovor da li trenutni izvor (twist) ima najveci prioritet i nije blokiran lock-om.
-bool TwistMux::hasPriority(const VelocityTopicHandle & twist)
+/**
+ * @brief Subscription za handle; postojeći se zadržava dok se topic ne promeni.
+ *
+ * Callback nalazi handle po imenu u aktivnom skupu, pa isti subscription služi
+ * i handle-u istog imena iz svake naredne konfiguracije. Skup se uzima pod mutex_-om
+ * i predaje handle-u, pa cela obrada poruke radi nad jednim skupom.
+ */
+template<typename H>
+void TwistMux::subscribe(
+  const H & handle, std::shared_ptr<handle_container<H>> HandleSet::* handles)
 {
-  // Uzimamo najveći prioritet aktivnog lock-a
-  const auto lock_priority = getLockPriority();
-
-  LockTopicHandle::priority_type priority = 0;
-  std::string velocity_name = "NULL";
-
-  /// max_element on the priority of velocity topic handles satisfying
-  /// that is NOT masked by the lock priority:
-  // Prolazimo kroz sve izvore brzinskih komandi (joystick, nav2, keyboard...)
-  for (const auto & velocity_h : *velocity_hs_) {
-    // Ako izvor NIJE maskiran (nije istekao i nije ispod lock prioriteta)
-    if (!velocity_h.isMasked(lock_priority)) {
-      const auto velocity_priority = velocity_h.getPriority();
-      // Čuvamo onaj sa najvećim prioritetom
-      if (priority < velocity_priority) {
-        priority = velocity_priority;
-        velocity_name = velocity_h.getName();
+  using message_type = typename H::message_type;
+
+  const NameTable::id_type name = handle.getNameId();
+  Feed & feed = feeds_[name];
+  if (feed.subscription && feed.topic == handle.getTopicId()) {
+    return;
+  }
+  feed.topic = handle.getTopicId();
+  feed.subscription = this->create_subscription<message_type>(
+    handle.getTopic(), rclcpp::SystemDefaultsQoS(),
+    [this, name, handles](const typename message_type::ConstSharedPtr msg) -> void {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const std::shared_ptr<HandleSet> set = std::atomic_load(&handles_);
+      if (!set || name >= set->slot.size() || set->slot[name] == Arbiter::NONE) {
+        return;
       }
+      (*((*set).*handles))[set->slot[name]].callback(msg, *set);
+    });
+}
+
+/**
+ * @brief Proveri tipove promenjenih topics.* / locks.* parametara i zakaži rekonfiguraciju.
+ *
+ * Brisanje parametra (NOT_SET) je dozvoljeno; ulaz bez topic-a ili sa praznim topic-om se uklanja.
+ */
+rcl_interfaces::msg::SetParametersResult TwistMux::onSetParameters(
+  const std::vector<rclcpp::Parameter> & parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+
+  bool handles_changed = false;
+  for (const auto & parameter : parameters) {
+    const std::string & name = parameter.get_name();
+    if (name.compare(0, 7, "topics.") != 0 && name.compare(0, 6, "locks.") != 0) {
+      continue;
+    }
+    handles_changed = true;
+
+    const std::string field = name.substr(name.rfind('.') + 1);
+    rclcpp::ParameterType expected;
+    if (field == "topic") {
+      expected = rclcpp::ParameterType::PARAMETER_STRING;
+    } else if (field == "timeout") {
+      expected = rclcpp::ParameterType::PARAMETER_DOUBLE;
+    } else if (field == "priority") {
+      expected = rclcpp::ParameterType::PARAMETER_INTEGER;
+    } else if (field == "expire_on_idle") {
+      expected = rclcpp::ParameterType::PARAMETER_BOOL;
+    } else {
+      result.successful = false;
+      result.reason = "unknown field '" + field + "' in '" + name + "'";
+      break;
+    }
+
+    const auto type = parameter.get_type();
+    if (type != expected && type != rclcpp::ParameterType::PARAMETER_NOT_SET) {
+      result.successful = false;
+      result.reason = "'" + name + "' must be of type " + rclcpp::to_string(expected) +
+        ", got " + parameter.get_type_name();
+      break;
     }
   }
 
-  // Vraćamo true ako je ovaj konkretni izvor (twist) baš onaj koji trenutno ima najveći prioritet
-  return twist.getName() == velocity_name;
+  if (result.successful && handles_changed) {
+    scheduleReconfigure();
+  }
+  return result;
 }
 
+/**
+ * @brief Rekonfiguracija se izvršava iz jednokratnog tajmera: u trenutku poziva
+ * onSetParameters() nove vrednosti još nisu upisane u node.
+ */
+void TwistMux::scheduleReconfigure()
+{
+  if (reconfigure_timer_) {
+    return;
+  }
+  reconfigure_timer_ = this->create_wall_timer(
+    std::chrono::nanoseconds(0), [this]() -> void {
+      reconfigure_timer_->cancel();
+      reconfigure_timer_.reset();
+      try {
+        reconfigure();
+      } catch (const std::exception & e) {
+        RCLCPP_WARN(
+          get_logger(), "Reconfiguration failed, keeping the previous inputs: %s", e.what());
+      }
+    });
+}
 
-bool TwistMux::hasPriorityStamped(const VelocityStampedTopicHandle & twist)
+void TwistMux::updateInput(
+  HandleSet & set, Arbiter::id_type id, const rclcpp::Time & now, bool refresh)
 {
-  const auto lock_priority = getLockPriority();
-
-  LockTopicHandle::priority_type priority = 0;
-  std::string velocity_name = "NULL";
-
-  /// max_element on the priority of velocity topic handles satisfying
-  /// that is NOT masked by the lock priority:
-  for (const auto & velocity_stamped_h : *velocity_stamped_hs_) {
-    if (!velocity_stamped_h.isMasked(lock_priority)) {
-      const auto velocity_priority = velocity_stamped_h.getPriority();
-      if (priority < velocity_priority) {
-        priority = velocity_priority;
-        velocity_name = velocity_stamped_h.getName();
+  Arbiter & arbiter = set.arbiter;
+  arbiter.onInput(id, now.nanoseconds(), refresh);
+
+  Arbiter::time_type deadline;
+  if (arbiter.inputDeadline(id, deadline)) {
+    armExpiry(deadline, now.nanoseconds());
+  }
+  // Ako je ovaj ulaz pobednik, njegov callback sam salje poruku.
+  last_winner_ = arbiter.winner();
+}
+
+void TwistMux::updateLock(
+  HandleSet & set, Arbiter::id_type id, const rclcpp::Time & now, bool locked)
+{
+  Arbiter & arbiter = set.arbiter;
+  arbiter.onLock(id, now.nanoseconds(), locked);
+
+  Arbiter::time_type deadline;
+  if (arbiter.lockDeadline(id, deadline)) {
+    armExpiry(deadline, now.nanoseconds());
+  }
+  rearbitrate(set, now);
+}
+
+/**
+ * @brief Naoruža expiry_timer_ za rok isteka deadline, osim ako je već naoružan za raniji rok.
+ *
+ * Rokovi su u vremenu node-a (now()), pa je i tajmer na satu node-a: sa use_sim_time
+ * ističe po simuliranom vremenu i stoji dok je simulacija pauzirana. Tajmer se pravi
+ * jednom; ponovno naoružavanje samo menja period i resetuje ga, bez alokacije.
+ * Nove poruke samo pomeraju rokove unapred, pa se u ustaljenom radu ne dira;
+ * ako se probudi pre stvarnog isteka, onExpiry() ga naoruža za sledeći rok.
+ */
+void TwistMux::armExpiry(Arbiter::time_type deadline, Arbiter::time_type now)
+{
+  if (expiry_pending_ && deadline >= expiry_armed_) {
+    return;
+  }
+  expiry_armed_ = deadline;
+  expiry_pending_ = true;
+
+  // Handle istekne tek kada je now > deadline.
+  const auto delay = std::max<Arbiter::time_type>(deadline - now + 1, 1);
+  if (!expiry_timer_) {
+    expiry_timer_ = rclcpp::create_timer(
+      this, this->get_clock(), std::chrono::nanoseconds(delay), [this]() -> void {
+        onExpiry();
+      });
+    return;
+  }
+  int64_t old_period;
+  if (rcl_timer_exchange_period(
+      expiry_timer_->get_timer_handle().get(), delay, &old_period) != RCL_RET_OK)
+  {
+    RCLCPP_WARN(get_logger(), "Cannot re-arm the expiry timer: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+  expiry_timer_->reset();
+}
+
+void TwistMux::onExpiry()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Tajmer je jednokratan: stoji do sledećeg armExpiry().
+  expiry_timer_->cancel();
+  expiry_pending_ = false;
+
+  const rclcpp::Time now = this->now();
+  const std::shared_ptr<HandleSet> set = std::atomic_load(&handles_);
+  rearbitrate(*set, now);
+
+  Arbiter::time_type deadline;
+  if (set->arbiter.nextDeadline(deadline)) {
+    armExpiry(deadline, now.nanoseconds());
+  }
+}
+
+/**
+ * @brief Primeni isteke do now i reaguj ako se pobednik promenio.
+ *
+ * U event modu odmah šalje poslednju komandu novog pobednika, ili nultu komandu
+ * (publish_stop_on_expiry) ako pobednika više nema; u fixed-rate modu to radi publishOutput().
+ * Status dijagnostike se ažurira odmah, a objavljuje ga tajmer dijagnostike.
+ * Zove se sa mutex_-om, nad aktivnim skupom set.
+ */
+void TwistMux::rearbitrate(HandleSet & set, const rclcpp::Time & now)
+{
+  set.arbiter.advance(now.nanoseconds());
+  const auto winner = set.arbiter.winner();
+  if (winner == last_winner_) {
+    return;
+  }
+  last_winner_ = winner;
+
+  if (!isFixedRate()) {
+    if (cmd_pub_) {
+      if (winner != Arbiter::NONE) {
+        sendTwist((*set.velocity_hs)[winner].getMessage());
+      } else if (publish_stop_on_expiry_) {
+        sendTwist(geometry_msgs::msg::Twist());
+      }
+    } else {
+      if (winner != Arbiter::NONE) {
+        sendTwistStamped((*set.velocity_stamped_hs)[winner].getMessage());
+      } else if (publish_stop_on_expiry_) {
+        geometry_msgs::msg::TwistStamped stop;
+        stop.header.stamp = now;
+        sendTwistStamped(stop);
       }
     }
   }
 
-  return twist.getName() == velocity_name;
+  updateStatus();
+}
+
+// Vraća najveći prioritet među aktivnim lockovima (ako nema lockova → 0).
+// Taj broj služi kao granica: svi izvori sa nižim ili jednakim prioritetom od aktivnog locka → smatraju se blokiranim.
+// Arbiter ga drži keširanog; ovde samo primenjujemo isteke do trenutnog vremena.
+int TwistMux::getLockPriority()
+{
+  Arbiter & arbiter = current().arbiter;
+  arbiter.advance(now().nanoseconds());
+  const auto priority = arbiter.lockPriority();
+
+  RCLCPP_DEBUG(get_logger(), "Priority = %d.", static_cast<int>(priority));
+
+  return priority;
+}
+
+// Vraca odgovor da li trenutni izvor (twist) ima najveci prioritet i nije blokiran lock-om.
+// Pobednik je keširan u arbitru aktivnog skupa, pa se porede samo celobrojni id-jevi.
+bool TwistMux::hasPriority(const HandleSet & set, const VelocityTopicHandle & twist)
+{
+  return set.arbiter.hasPriority(twist.getId());
+}
+
+bool TwistMux::hasPriorityStamped(const HandleSet & set, const VelocityStampedTopicHandle & twist)
+{
+  return set.arbiter.hasPriority(twist.getId());
 }
 
 }  // namespace twist_mux
+
+#include <rclcpp_components/register_node_macro.hpp>
+
+RCLCPP_COMPONENTS_REGISTER_NODE(twist_mux::TwistMux)
@@ -38,10 +38,33 @@
 #include <diagnostic_updater/diagnostic_updater.hpp>
 
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace twist_mux
 {
+/**
+ * @brief Dodaje red sa brojačima jednog handle-a (brzina poruka, prosleđene/potisnute,
+ * jitter, kašnjenje stamp-a, vreme arbitraže).
+ */
+static void addMetrics(
+  diagnostic_updater::DiagnosticStatusWrapper & stat,
+  const std::string & name, const HandleMetrics & m)
+{
+  stat.addf(
+    "metrics " + name,
+    "%.1f Hz, forwarded %llu, suppressed %llu, jitter p50 %.3f ms p99 %.3f ms, "
+    "stamp latency mean %.3f ms max %.3f ms, arbitration mean %.0f ns max %lld ns",
+    m.rate(),
+    static_cast<unsigned long long>(m.forwarded()),
+    static_cast<unsigned long long>(m.suppressed()),
+    m.jitter().percentile(0.5) * 1e-6, m.jitter().percentile(0.99) * 1e-6,
+    m.stampLatency().mean() * 1e-6, m.stampLatency().max() * 1e-6,
+    m.arbitration().mean(), static_cast<long long>(m.arbitration().max()));
+}
+
 TwistMuxDiagnostics::TwistMuxDiagnostics(TwistMux * mux)
+: mutex_(&mux->mutex())
 {
   diagnostic_ = std::make_shared<diagnostic_updater::Updater>(mux);
   status_ = std::make_shared<status_type>();
@@ -61,13 +84,12 @@ void TwistMuxDiagnostics::updateStatus(const status_type::ConstPtr & status)
   status_->velocity_hs = status->velocity_hs;
   status_->velocity_stamped_hs = status->velocity_stamped_hs;
   status_->lock_hs = status->lock_hs;
+  status_->lock_transitions = status->lock_transitions;
   status_->priority = status->priority;
 
   status_->main_loop_time = status->main_loop_time;
   status_->reading_age = status->reading_age;
   status_->use_stamped = status->use_stamped;
-
-  update(); // Nakon ažuriranja odmah forsiramo update dijagnostike
 }
 
 /**
@@ -77,6 +99,9 @@ void TwistMuxDiagnostics::updateStatus(const status_type::ConstPtr & status)
  */
 void TwistMuxDiagnostics::diagnostics(diagnostic_updater::DiagnosticStatusWrapper & stat)
 {
+  // Handle-ove menjaju callback-ovi twist_mux-a; čitaju se pod istim mutex-om.
+  std::lock_guard<std::mutex> lock(*mutex_);
+
   /// Check if the loop period is quick enough
   // main_loop_time -> koliko traje glavna petlja twist_mux noda (koliko često se okida timer)
   if (status_->main_loop_time > MAIN_LOOP_TIME_MIN) {
@@ -105,6 +130,7 @@ void TwistMuxDiagnostics::diagnostics(diagnostic_updater::DiagnosticStatusWrappe
         (velocity_stamped_h.isMasked(status_->priority) ? "masked" : "unmasked"),
         velocity_stamped_h.getTopic().c_str(),
         velocity_stamped_h.getTimeout().seconds(), static_cast<int>(velocity_stamped_h.getPriority()));
+      addMetrics(stat, velocity_stamped_h.getName(), velocity_stamped_h.getMetrics());
     }
   }
   else
@@ -115,15 +141,24 @@ void TwistMuxDiagnostics::diagnostics(diagnostic_updater::DiagnosticStatusWrappe
         (velocity_h.isMasked(status_->priority) ? "masked" : "unmasked"),
         velocity_h.getTopic().c_str(),
         velocity_h.getTimeout().seconds(), static_cast<int>(velocity_h.getPriority()));
+      addMetrics(stat, velocity_h.getName(), velocity_h.getMetrics());
     }
   }
 
+  std::size_t lock_index = 0;
   for (const auto & lock_h : *status_->lock_hs) {
     stat.addf(
       "lock " + lock_h.getName(), " %s (listening to %s @ %fs with priority #%d)",
       (lock_h.isLocked() ? "locked" : "free"), lock_h.getTopic().c_str(),
       lock_h.getTimeout().seconds(),
       static_cast<int>(lock_h.getPriority()));
+    if (lock_index < status_->lock_transitions.size()) {
+      stat.addf(
+        "metrics " + lock_h.getName(), "%.1f Hz, %llu transitions",
+        lock_h.getMetrics().rate(),
+        static_cast<unsigned long long>(status_->lock_transitions[lock_index]));
+    }
+    ++lock_index;
   }
 
   stat.add("current priority", static_cast<int>(status_->priority)); // Koji lock prioritet trenutno važi
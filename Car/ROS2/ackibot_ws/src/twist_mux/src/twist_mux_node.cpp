@@ -1,52 +0,0 @@
-// Copyright 2020 PAL Robotics S.L.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-//
-//    * Redistributions of source code must retain the above copyright
-//      notice, this list of conditions and the following disclaimer.
-//
-//    * Redistributions in binary form must reproduce the above copyright
-//      notice, this list of conditions and the following disclaimer in the
-//      documentation and/or other materials provided with the distribution.
-//
-//    * Neither the name of the PAL Robotics S.L. nor the names of its
-//      contributors may be used to endorse or promote products derived from
-//      this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
-// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
-// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
-// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
-// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
-// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
-// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
-// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
-// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
-// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
-// POSSIBILITY OF SUCH DAMAGE.
-
-/*
- * @author Enrique Fernandez
- * @author Siegfried Gevatter
- * @author Jeremie Deray
- */
-
-#include <twist_mux/twist_mux.hpp>
-
-#include <memory>
-
-int main(int argc, char * argv[])
-{
-  rclcpp::init(argc, argv); // Inicijalizacija ROS2 sistema
-
-  auto twist_mux_node = std::make_shared<twist_mux::TwistMux>(); // Kreiramo instancu našeg node-a twist_mux, koristeći std::make_shared
-
-  twist_mux_node->init(); // Pozivamo init() metodu da node učita parametre (topics, locks) i pripremi publisere, subscribere i dijagnostiku
-
-  rclcpp::spin(twist_mux_node); // Pokrećemo glavnu petlju (event loop) - ovde ROS2 obrađuje sve callback-ove (subscribe, timer, diag…)
-
-  rclcpp::shutdown(); // Kada se node završi (npr. Ctrl+C), uredno gasimo ROS2
-
-  return EXIT_SUCCESS;
-}
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#ifndef ARBITER_ORACLE_HPP_
+#define ARBITER_ORACLE_HPP_
+
+#include <twist_mux/arbiter.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace twist_mux
+{
+namespace test
+{
+/**
+ * @brief Oracle Straight port of the original linear scans in TwistMux
+ * (getLockPriority / hasPriority), evaluated lazily at a given time.
+ */
+class Oracle
+{
+public:
+  struct Handle
+  {
+    int priority;
+    Arbiter::time_type timeout;
+    Arbiter::time_type stamp;
+    bool data;
+  };
+
+  void addInput(int priority, Arbiter::time_type timeout)
+  {
+    inputs_.push_back({priority, timeout, NEVER, false});
+  }
+
+  void addLock(int priority, Arbiter::time_type timeout)
+  {
+    locks_.push_back({priority, timeout, NEVER, false});
+  }
+
+  void onInput(std::size_t id, Arbiter::time_type now, bool refresh)
+  {
+    if (refresh) {
+      inputs_[id].stamp = now;
+    }
+  }
+
+  void onLock(std::size_t id, Arbiter::time_type now, bool data)
+  {
+    locks_[id].stamp = now;
+    locks_[id].data = data;
+  }
+
+  int lockPriority(Arbiter::time_type now) const
+  {
+    int priority = 0;
+    for (const auto & lock : locks_) {
+      if ((expired(lock, now) || lock.data) && priority < lock.priority) {
+        priority = lock.priority;
+      }
+    }
+    return priority;
+  }
+
+  Arbiter::id_type winner(Arbiter::time_type now) const
+  {
+    const int lock_priority = lockPriority(now);
+    int priority = 0;
+    Arbiter::id_type winner = Arbiter::NONE;
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+      const auto & input = inputs_[i];
+      if (!expired(input, now) && !(input.priority < lock_priority) && priority < input.priority) {
+        priority = input.priority;
+        winner = i;
+      }
+    }
+    return winner;
+  }
+
+private:
+  static constexpr Arbiter::time_type NEVER = std::numeric_limits<Arbiter::time_type>::min() / 2;
+
+  static bool expired(const Handle & h, Arbiter::time_type now)
+  {
+    return h.timeout > 0 && (now - h.stamp) > h.timeout;
+  }
+
+  std::vector<Handle> inputs_;
+  std::vector<Handle> locks_;
+};
+}  // namespace test
+}  // namespace twist_mux
+
+#endif  // ARBITER_ORACLE_HPP_
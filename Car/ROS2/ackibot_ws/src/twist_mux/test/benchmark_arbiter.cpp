@@ -0,0 +1,196 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <twist_mux/arbiter.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+// Micro-benchmark of the per-message arbitration cost with 4, 16 and 64
+// inputs: the Arbiter against the original list scan of TwistMux, which
+// rebuilt the lock priority and the winner name on every message and
+// compared names. Both run the same message sequence; their decisions must
+// agree, the timings are only printed.
+
+using twist_mux::Arbiter;
+
+namespace
+{
+constexpr Arbiter::time_type MS = 1000000;
+constexpr int LOCKS = 2;
+constexpr int MESSAGES = 200000;
+
+/**
+ * @brief LegacyMux The arbitration of the original TwistMux: handles in a
+ * std::list with string names, a scan of all locks and inputs per message.
+ */
+class LegacyMux
+{
+public:
+  struct Handle
+  {
+    std::string name;
+    int priority;
+    Arbiter::time_type timeout;
+    Arbiter::time_type stamp;
+    bool data;
+
+    bool hasExpired(Arbiter::time_type now) const
+    {
+      return timeout > 0 && (now - stamp) > timeout;
+    }
+  };
+
+  void addInput(const std::string & name, int priority, Arbiter::time_type timeout)
+  {
+    inputs_.push_back({name, priority, timeout, 0, false});
+    index_.push_back(&inputs_.back());
+  }
+
+  void addLock(const std::string & name, int priority, Arbiter::time_type timeout)
+  {
+    locks_.push_back({name, priority, timeout, 0, false});
+  }
+
+  bool onInput(std::size_t id, Arbiter::time_type now)
+  {
+    Handle & twist = *index_[id];
+    twist.stamp = now;
+    return hasPriority(twist, now);
+  }
+
+private:
+  int getLockPriority(Arbiter::time_type now) const
+  {
+    int priority = 0;
+    for (const auto & lock_h : locks_) {
+      if (lock_h.hasExpired(now) || lock_h.data) {
+        if (priority < lock_h.priority) {
+          priority = lock_h.priority;
+        }
+      }
+    }
+    return priority;
+  }
+
+  bool hasPriority(const Handle & twist, Arbiter::time_type now) const
+  {
+    const int lock_priority = getLockPriority(now);
+
+    int priority = 0;
+    std::string velocity_name = "NULL";
+    for (const auto & velocity_h : inputs_) {
+      if (!(velocity_h.hasExpired(now) || velocity_h.priority < lock_priority)) {
+        if (priority < velocity_h.priority) {
+          priority = velocity_h.priority;
+          velocity_name = velocity_h.name;
+        }
+      }
+    }
+    return twist.name == velocity_name;
+  }
+
+  std::list<Handle> inputs_;
+  std::list<Handle> locks_;
+  std::vector<Handle *> index_;
+};
+
+struct Message
+{
+  std::size_t id;
+  Arbiter::time_type stamp;
+};
+
+std::vector<Message> makeMessages(int inputs)
+{
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> id(0, inputs - 1);
+  std::uniform_int_distribution<int> step_us(10, 2000);
+
+  std::vector<Message> messages;
+  messages.reserve(MESSAGES);
+  Arbiter::time_type now = 1000 * MS;
+  for (int i = 0; i < MESSAGES; ++i) {
+    now += step_us(rng) * 1000;
+    messages.push_back({static_cast<std::size_t>(id(rng)), now});
+  }
+  return messages;
+}
+
+template<typename F>
+double nanosecondsPerMessage(F && body)
+{
+  const auto start = std::chrono::steady_clock::now();
+  body();
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / MESSAGES;
+}
+
+void benchmark(int inputs)
+{
+  // Priorities repeat every 8 inputs, with long names so the legacy copies allocate.
+  Arbiter arbiter;
+  LegacyMux legacy;
+  for (int i = 0; i < inputs; ++i) {
+    const int priority = 10 + (i % 8) * 30;
+    const Arbiter::time_type timeout = (50 + 10 * (i % 8)) * MS;
+    arbiter.addInput(priority, timeout);
+    legacy.addInput("topics.velocity_input_" + std::to_string(i), priority, timeout);
+  }
+  for (int i = 0; i < LOCKS; ++i) {
+    arbiter.addLock(200 + i, 0);
+    legacy.addLock("locks.lock_" + std::to_string(i), 200 + i, 0);
+  }
+
+  const std::vector<Message> messages = makeMessages(inputs);
+
+  std::vector<char> arbiter_forwarded(messages.size());
+  std::vector<char> legacy_forwarded(messages.size());
+
+  const double arbiter_ns = nanosecondsPerMessage(
+    [&] {
+      for (std::size_t i = 0; i < messages.size(); ++i) {
+        const Message & m = messages[i];
+        arbiter.advance(m.stamp);
+        arbiter.onInput(m.id, m.stamp);
+        arbiter_forwarded[i] = arbiter.hasPriority(m.id);
+      }
+    });
+  const double legacy_ns = nanosecondsPerMessage(
+    [&] {
+      for (std::size_t i = 0; i < messages.size(); ++i) {
+        const Message & m = messages[i];
+        legacy_forwarded[i] = legacy.onInput(m.id, m.stamp);
+      }
+    });
+
+  std::printf(
+    "[ arbiter  ] inputs=%2d  arbiter=%7.1f ns/msg  list scan=%7.1f ns/msg  (%.1fx)\n",
+    inputs, arbiter_ns, legacy_ns, legacy_ns / arbiter_ns);
+
+  EXPECT_EQ(legacy_forwarded, arbiter_forwarded) << inputs << " inputs";
+}
+}  // namespace
+
+TEST(ArbiterBenchmark, Inputs4)
+{
+  benchmark(4);
+}
+
+TEST(ArbiterBenchmark, Inputs16)
+{
+  benchmark(16);
+}
+
+TEST(ArbiterBenchmark, Inputs64)
+{
+  benchmark(64);
+}
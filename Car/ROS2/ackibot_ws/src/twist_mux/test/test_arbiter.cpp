@@ -0,0 +1,176 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <twist_mux/arbiter.hpp>
+
+#include "arbiter_oracle.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using twist_mux::Arbiter;
+using twist_mux::test::Oracle;
+
+namespace
+{
+constexpr Arbiter::time_type MS = 1000000;
+const Arbiter::id_type NONE = Arbiter::NONE;
+}  // namespace
+
+TEST(Arbiter, HighestUnmaskedInputWins)
+{
+  Arbiter arbiter;
+  const auto navigation = arbiter.addInput(10, 500 * MS);
+  const auto joystick = arbiter.addInput(100, 500 * MS);
+  const auto pause = arbiter.addLock(200, 0);
+
+  EXPECT_EQ(NONE, arbiter.winner());
+
+  arbiter.onInput(navigation, 1000 * MS);
+  EXPECT_EQ(navigation, arbiter.winner());
+
+  arbiter.onInput(joystick, 1100 * MS);
+  EXPECT_EQ(joystick, arbiter.winner());
+
+  arbiter.onLock(pause, 1200 * MS, true);
+  EXPECT_EQ(200, arbiter.lockPriority());
+  EXPECT_EQ(NONE, arbiter.winner());
+
+  arbiter.onLock(pause, 1300 * MS, false);
+  EXPECT_EQ(0, arbiter.lockPriority());
+  EXPECT_EQ(joystick, arbiter.winner());
+
+  // Joystick times out first, navigation takes over, then nothing is left.
+  arbiter.advance(1601 * MS);
+  EXPECT_EQ(NONE, arbiter.winner());
+  arbiter.onInput(navigation, 1650 * MS);
+  EXPECT_EQ(navigation, arbiter.winner());
+  arbiter.advance(2151 * MS);
+  EXPECT_EQ(NONE, arbiter.winner());
+}
+
+TEST(Arbiter, LockExpiresIntoLocked)
+{
+  Arbiter arbiter;
+  const auto input = arbiter.addInput(50, 0);
+  const auto loop_closure = arbiter.addLock(100, 200 * MS);
+
+  // Never heard from: expired, therefore locked.
+  EXPECT_TRUE(arbiter.isLocked(loop_closure));
+  EXPECT_EQ(NONE, arbiter.winner());
+
+  arbiter.onLock(loop_closure, 1000 * MS, false);
+  EXPECT_EQ(input, arbiter.winner());
+
+  arbiter.advance(1200 * MS);
+  EXPECT_EQ(input, arbiter.winner());
+  arbiter.advance(1200 * MS + 1);
+  EXPECT_TRUE(arbiter.isLocked(loop_closure));
+  EXPECT_EQ(NONE, arbiter.winner());
+  EXPECT_EQ(2u, arbiter.lockTransitions(loop_closure));
+}
+
+TEST(Arbiter, TiesGoToFirstRegisteredAndZeroNeverWins)
+{
+  Arbiter arbiter;
+  const auto idle = arbiter.addInput(0, 0);
+  const auto first = arbiter.addInput(20, 0);
+  const auto second = arbiter.addInput(20, 0);
+
+  EXPECT_EQ(first, arbiter.winner());
+  EXPECT_NE(second, arbiter.winner());
+  EXPECT_NE(idle, arbiter.winner());
+}
+
+TEST(Arbiter, IdleMessageDoesNotRefresh)
+{
+  Arbiter arbiter;
+  const auto joystick = arbiter.addInput(100, 100 * MS);
+
+  arbiter.onInput(joystick, 1000 * MS, true);
+  arbiter.onInput(joystick, 1050 * MS, false);
+  arbiter.advance(1101 * MS);
+  EXPECT_EQ(NONE, arbiter.winner());
+}
+
+TEST(Arbiter, ReportsDeadlines)
+{
+  Arbiter arbiter;
+  const auto forever = arbiter.addInput(10, 0);
+  const auto joystick = arbiter.addInput(100, 500 * MS);
+  const auto lock = arbiter.addLock(50, 200 * MS);
+
+  Arbiter::time_type deadline = 0;
+  EXPECT_FALSE(arbiter.nextDeadline(deadline));
+  EXPECT_FALSE(arbiter.inputDeadline(forever, deadline));
+
+  arbiter.onInput(joystick, 1000 * MS);
+  arbiter.onLock(lock, 1100 * MS, false);
+  ASSERT_TRUE(arbiter.inputDeadline(joystick, deadline));
+  EXPECT_EQ(1500 * MS, deadline);
+  ASSERT_TRUE(arbiter.lockDeadline(lock, deadline));
+  EXPECT_EQ(1300 * MS, deadline);
+  ASSERT_TRUE(arbiter.nextDeadline(deadline));
+  EXPECT_EQ(1300 * MS, deadline);
+
+  arbiter.advance(1300 * MS + 1);
+  EXPECT_FALSE(arbiter.lockDeadline(lock, deadline));
+  ASSERT_TRUE(arbiter.nextDeadline(deadline));
+  EXPECT_EQ(1500 * MS, deadline);
+}
+
+TEST(Arbiter, MatchesLinearScan)
+{
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> priority(0, 255);
+  std::uniform_int_distribution<int> timeout_ms(0, 400);
+  std::uniform_int_distribution<int> step_us(0, 20000);
+  std::uniform_int_distribution<int> coin(0, 3);
+
+  for (int round = 0; round < 20; ++round) {
+    Arbiter arbiter;
+    Oracle oracle;
+
+    const int n_inputs = 1 + round * 3;
+    const int n_locks = round % 5;
+    for (int i = 0; i < n_inputs; ++i) {
+      // Draw few distinct priorities so that ties happen.
+      const int p = priority(rng) % 8 * 32;
+      const Arbiter::time_type t = (coin(rng) == 0) ? 0 : timeout_ms(rng) * MS;
+      arbiter.addInput(p, t);
+      oracle.addInput(p, t);
+    }
+    for (int i = 0; i < n_locks; ++i) {
+      const int p = priority(rng);
+      const Arbiter::time_type t = (coin(rng) == 0) ? 0 : timeout_ms(rng) * MS;
+      arbiter.addLock(p, t);
+      oracle.addLock(p, t);
+    }
+
+    Arbiter::time_type now = 1000 * MS;
+    for (int event = 0; event < 5000; ++event) {
+      now += step_us(rng) * 1000;
+      if (n_locks > 0 && coin(rng) == 0) {
+        const std::size_t id = rng() % n_locks;
+        const bool data = coin(rng) == 0;
+        arbiter.onLock(id, now, data);
+        oracle.onLock(id, now, data);
+      } else if (coin(rng) != 0) {
+        const std::size_t id = rng() % n_inputs;
+        const bool refresh = coin(rng) != 0;
+        arbiter.onInput(id, now, refresh);
+        oracle.onInput(id, now, refresh);
+      } else {
+        arbiter.advance(now);
+      }
+
+      ASSERT_EQ(oracle.lockPriority(now), arbiter.lockPriority()) << "round " << round << " event " << event;
+      ASSERT_EQ(oracle.winner(now), arbiter.winner()) << "round " << round << " event " << event;
+    }
+  }
+}
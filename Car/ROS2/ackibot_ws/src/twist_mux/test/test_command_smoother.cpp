@@ -0,0 +1,85 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <twist_mux/command_smoother.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using twist_mux::CommandSmoother;
+using twist_mux::RateLimiter;
+
+namespace
+{
+constexpr double DT = 0.02;  // 50 Hz output
+}
+
+TEST(RateLimiter, UnlimitedFollowsTarget)
+{
+  RateLimiter limiter;
+  EXPECT_DOUBLE_EQ(1.5, limiter.step(1.5, DT));
+  EXPECT_DOUBLE_EQ(-0.5, limiter.step(-0.5, DT));
+}
+
+TEST(RateLimiter, AccelerationLimit)
+{
+  RateLimiter limiter(1.0, 0.0);  // 1 m/s^2
+  for (int i = 0; i < 25; ++i) {
+    limiter.step(1.0, DT);
+  }
+  EXPECT_NEAR(0.5, limiter.velocity(), 1e-9);
+
+  for (int i = 0; i < 100; ++i) {
+    limiter.step(1.0, DT);
+  }
+  EXPECT_DOUBLE_EQ(1.0, limiter.velocity());
+}
+
+TEST(RateLimiter, JerkLimitWithoutOvershoot)
+{
+  const double max_acceleration = 2.0;
+  const double max_jerk = 10.0;
+  RateLimiter limiter(max_acceleration, max_jerk);
+
+  double previous_acceleration = 0.0;
+  double peak = 0.0;
+  for (int i = 0; i < 200; ++i) {
+    limiter.step(1.0, DT);
+    peak = std::max(peak, limiter.velocity());
+    EXPECT_LE(std::abs(limiter.acceleration()), max_acceleration + 1e-9);
+    // Jerk is bounded except for the final snap onto the target.
+    if (limiter.velocity() < 1.0) {
+      EXPECT_LE(std::abs(limiter.acceleration() - previous_acceleration), max_jerk * DT + 1e-9);
+    }
+    previous_acceleration = limiter.acceleration();
+  }
+  EXPECT_DOUBLE_EQ(1.0, limiter.velocity());
+  EXPECT_LE(peak, 1.0);
+}
+
+TEST(CommandSmoother, LimitsOnlyLinearXAndAngularZ)
+{
+  struct Vector3
+  {
+    double x, y, z;
+  };
+  struct Twist
+  {
+    Vector3 linear, angular;
+  };
+
+  CommandSmoother smoother(1.0, 0.0, 2.0, 0.0);
+  Twist target{{1.0, 0.3, 0.0}, {0.0, 0.0, 1.0}};
+  Twist out{};
+  smoother.step(target, DT, out);
+
+  EXPECT_NEAR(1.0 * DT, out.linear.x, 1e-12);
+  EXPECT_NEAR(2.0 * DT, out.angular.z, 1e-12);
+  EXPECT_DOUBLE_EQ(0.3, out.linear.y);
+
+  smoother.reset();
+  EXPECT_DOUBLE_EQ(0.0, smoother.linear().velocity());
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <twist_mux/handle_storage.hpp>
+
+#include <string>
+#include <vector>
+
+using twist_mux::HandleArray;
+using twist_mux::NameTable;
+
+namespace
+{
+// Like a topic handle: neither copyable nor movable, and it keeps its address.
+struct Pinned
+{
+  Pinned(int value, int & destroyed)
+  : value(value), self(this), destroyed(destroyed) {}
+
+  Pinned(const Pinned &) = delete;
+  Pinned & operator=(const Pinned &) = delete;
+
+  ~Pinned()
+  {
+    ++destroyed;
+  }
+
+  int value;
+  const Pinned * self;
+  int & destroyed;
+};
+}  // namespace
+
+TEST(HandleArray, BuildsInPlaceAndKeepsAddresses)
+{
+  int destroyed = 0;
+  {
+    HandleArray<Pinned> handles;
+    handles.reserve(3);
+    for (int i = 0; i < 3; ++i) {
+      handles.emplace_back(i, destroyed);
+    }
+
+    ASSERT_EQ(3u, handles.size());
+    EXPECT_EQ(0, handles.front().value);
+    int expected = 0;
+    for (const auto & handle : handles) {
+      EXPECT_EQ(expected++, handle.value);
+      EXPECT_EQ(&handle, handle.self);
+    }
+    // Contiguous.
+    EXPECT_EQ(&handles[0] + 2, &handles[2]);
+    EXPECT_EQ(0, destroyed);
+  }
+  EXPECT_EQ(3, destroyed);
+}
+
+TEST(HandleArray, EmptyArray)
+{
+  HandleArray<Pinned> handles;
+  handles.reserve(0);
+  EXPECT_TRUE(handles.empty());
+  EXPECT_EQ(handles.begin(), handles.end());
+}
+
+TEST(NameTable, InternsOnce)
+{
+  NameTable names;
+  const auto joystick = names.intern("topics.joystick");
+  const auto topic = names.intern("/cmd_vel_joy");
+  EXPECT_NE(joystick, topic);
+  EXPECT_EQ(joystick, names.intern("topics.joystick"));
+  EXPECT_EQ(2u, names.size());
+  EXPECT_EQ("/cmd_vel_joy", names[topic]);
+}
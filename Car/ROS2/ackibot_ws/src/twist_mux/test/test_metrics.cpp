@@ -0,0 +1,83 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <twist_mux/metrics.hpp>
+
+#include <cstdint>
+#include <thread>
+
+using twist_mux::HandleMetrics;
+using twist_mux::Histogram;
+using twist_mux::LatencyStats;
+
+namespace
+{
+constexpr std::int64_t US = 1000;
+constexpr std::int64_t MS = 1000 * US;
+}
+
+TEST(Histogram, PowerOfTwoBuckets)
+{
+  Histogram h;
+  h.record(0);
+  h.record(1 * US);
+  h.record(3 * US);
+  h.record(1000 * MS);
+  EXPECT_EQ(2u, h.count(0));
+  EXPECT_EQ(1u, h.count(1));
+  EXPECT_EQ(1u, h.count(Histogram::BUCKETS - 1));
+
+  EXPECT_EQ(2 * US, h.percentile(0.5));
+  EXPECT_EQ(Histogram::upperEdge(Histogram::BUCKETS - 1), h.percentile(1.0));
+}
+
+TEST(LatencyStats, MeanAndMax)
+{
+  LatencyStats stats;
+  EXPECT_EQ(0.0, stats.mean());
+  stats.record(100);
+  stats.record(300);
+  EXPECT_EQ(2u, stats.count());
+  EXPECT_DOUBLE_EQ(200.0, stats.mean());
+  EXPECT_EQ(300, stats.max());
+}
+
+TEST(HandleMetrics, JitterAndRate)
+{
+  HandleMetrics m;
+  // 100 Hz with every other period 2 ms late.
+  std::int64_t t = 1000 * MS;
+  for (int i = 0; i < 100; ++i) {
+    m.onArrival(t);
+    t += (i % 2) ? 12 * MS : 8 * MS;
+  }
+  EXPECT_EQ(100u, m.received());
+  // |12 - 8| = 4 ms: bucket [2048, 4096) us.
+  EXPECT_EQ(4096 * US, m.jitter().percentile(0.5));
+
+  m.updateRate(1000 * MS);
+  m.onArrival(t);
+  EXPECT_DOUBLE_EQ(1.0, m.updateRate(2000 * MS));
+}
+
+TEST(HandleMetrics, ConcurrentReaderNeverBlocksWriter)
+{
+  HandleMetrics m;
+  std::thread writer([&m]() {
+      for (int i = 1; i <= 100000; ++i) {
+        m.onArrival(i * MS);
+        m.onForwarded();
+      }
+    });
+  std::uint64_t last = 0;
+  while (last < 100000) {
+    const auto now = m.forwarded();
+    EXPECT_GE(now, last);
+    last = now;
+  }
+  writer.join();
+  EXPECT_EQ(100000u, m.received());
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <rclcpp/rclcpp.hpp>
+#include <geometry_msgs/msg/twist_stamped.hpp>
+
+#include <twist_mux/twist_mux.hpp>
+#include <twist_mux/topic_handle.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+using twist_mux::Arbiter;
+using twist_mux::TwistMux;
+
+std::shared_ptr<TwistMux> makeMux()
+{
+  std::vector<std::string> args = {
+    "test_reconfigure", "--ros-args",
+    "-p", "topics.joystick.topic:=joy_vel",
+    "-p", "topics.joystick.timeout:=10.0",
+    "-p", "topics.joystick.priority:=100",
+    "-p", "topics.joystick.expire_on_idle:=false",
+    "-p", "locks.pause.topic:=pause",
+    "-p", "locks.pause.timeout:=0.0",
+    "-p", "locks.pause.priority:=150",
+  };
+  std::vector<const char *> argv;
+  for (const auto & arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  rclcpp::init(static_cast<int>(argv.size()), argv.data());
+
+  return std::make_shared<TwistMux>();
+}
+
+// Reconfiguration runs from a one-shot timer after the parameters are set.
+void spinUntil(const std::shared_ptr<TwistMux> & mux, const std::function<bool()> & done)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (!done() && std::chrono::steady_clock::now() < deadline) {
+    rclcpp::spin_some(mux);
+  }
+}
+
+std::vector<rclcpp::Parameter> input(
+  const std::string & name, const std::string & topic, double timeout, int priority)
+{
+  const std::string prefix = "topics." + name;
+  return {
+    rclcpp::Parameter(prefix + ".topic", topic),
+    rclcpp::Parameter(prefix + ".timeout", timeout),
+    rclcpp::Parameter(prefix + ".priority", priority),
+    rclcpp::Parameter(prefix + ".expire_on_idle", false),
+  };
+}
+
+std::vector<std::string> inputNames(const TwistMux & mux)
+{
+  std::vector<std::string> names;
+  for (const auto & handle : *mux.current().velocity_stamped_hs) {
+    names.push_back(handle.getName());
+  }
+  return names;
+}
+
+geometry_msgs::msg::TwistStamped::ConstSharedPtr command(double x)
+{
+  auto msg = std::make_shared<geometry_msgs::msg::TwistStamped>();
+  msg->twist.linear.x = x;
+  return msg;
+}
+}  // namespace
+
+class Reconfigure : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    mux_ = makeMux();
+  }
+
+  void TearDown() override
+  {
+    mux_.reset();
+    rclcpp::shutdown();
+  }
+
+  void apply(const std::vector<rclcpp::Parameter> & parameters)
+  {
+    const auto * before = &mux_->current();
+    ASSERT_TRUE(mux_->set_parameters_atomically(parameters).successful);
+    spinUntil(mux_, [&]() {return &mux_->current() != before;});
+    ASSERT_NE(before, &mux_->current());
+  }
+
+  std::shared_ptr<TwistMux> mux_;
+};
+
+TEST_F(Reconfigure, AddsInputByPriority)
+{
+  EXPECT_EQ(std::vector<std::string>({"topics.joystick"}), inputNames(*mux_));
+
+  apply(input("navigation", "nav_vel", 0.5, 10));
+  apply(input("safety", "safety_vel", 0.5, 200));
+
+  EXPECT_EQ(
+    std::vector<std::string>({"topics.safety", "topics.joystick", "topics.navigation"}),
+    inputNames(*mux_));
+  EXPECT_EQ(1u, mux_->current().lock_hs->size());
+}
+
+TEST_F(Reconfigure, ChangesPriorityAndKeepsState)
+{
+  apply(input("navigation", "nav_vel", 10.0, 10));
+
+  // The joystick wins with the last command it sent.
+  auto & joystick = mux_->current().velocity_stamped_hs->front();
+  joystick.callback(command(0.3), mux_->current());
+  ASSERT_EQ(joystick.getId(), mux_->current().arbiter.winner());
+
+  // Navigation now outranks the joystick, but has not sent anything yet.
+  apply({rclcpp::Parameter("topics.navigation.priority", 120)});
+  EXPECT_EQ(
+    std::vector<std::string>({"topics.navigation", "topics.joystick"}),
+    inputNames(*mux_));
+
+  const auto & moved = (*mux_->current().velocity_stamped_hs)[1];
+  EXPECT_EQ(moved.getId(), mux_->current().arbiter.winner());
+  EXPECT_DOUBLE_EQ(0.3, moved.getMessage().twist.linear.x);
+  EXPECT_EQ(1u, moved.getMetrics().received());
+
+  auto & navigation = mux_->current().velocity_stamped_hs->front();
+  navigation.callback(command(0.1), mux_->current());
+  EXPECT_EQ(navigation.getId(), mux_->current().arbiter.winner());
+}
+
+TEST_F(Reconfigure, RemovesInputWithEmptyTopic)
+{
+  apply(input("navigation", "nav_vel", 0.5, 10));
+  apply({rclcpp::Parameter("topics.navigation.topic", std::string())});
+
+  EXPECT_EQ(std::vector<std::string>({"topics.joystick"}), inputNames(*mux_));
+  EXPECT_EQ(Arbiter::NONE, mux_->current().arbiter.winner());
+}
+
+TEST_F(Reconfigure, RejectsWrongType)
+{
+  const auto * before = &mux_->current();
+  const auto result = mux_->set_parameters_atomically(
+    {rclcpp::Parameter("topics.joystick.priority", std::string("high"))});
+
+  EXPECT_FALSE(result.successful);
+  rclcpp::spin_some(mux_);
+  EXPECT_EQ(before, &mux_->current());
+}
+
+TEST_F(Reconfigure, KeepsInputsOnIncompleteConfiguration)
+{
+  const auto * before = &mux_->current();
+  // An input without timeout and priority cannot be built.
+  ASSERT_TRUE(
+    mux_->set_parameters_atomically(
+      {rclcpp::Parameter("topics.tablet.topic", std::string("tablet_vel"))}).successful);
+  spinUntil(mux_, []() {return false;});
+
+  EXPECT_EQ(before, &mux_->current());
+  EXPECT_EQ(std::vector<std::string>({"topics.joystick"}), inputNames(*mux_));
+}
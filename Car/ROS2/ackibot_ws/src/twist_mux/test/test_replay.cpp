@@ -0,0 +1,379 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+// Deterministic replay and load test for the arbitration path.
+//
+// A schedule of velocity and lock events, recorded (test/replay_schedule.txt,
+// or the file in TWIST_MUX_REPLAY) or synthetic at a given aggregate rate, is
+// fed in-process to the handle callbacks of a TwistMux running on simulated
+// time. After every event the winner and, for velocity events, whether the
+// command was forwarded are checked against the Oracle (the original linear
+// scans). The callback time of every event is measured and run through a
+// single-server queue at the schedule's arrival times, which gives the
+// arbitration cost per message and the worst queueing delay at that rate.
+
+#include <gtest/gtest.h>
+
+#include <rcl/time.h>
+#include <rclcpp/rclcpp.hpp>
+#include <geometry_msgs/msg/twist_stamped.hpp>
+#include <std_msgs/msg/bool.hpp>
+
+#include <twist_mux/twist_mux.hpp>
+#include <twist_mux/topic_handle.hpp>
+
+#include "arbiter_oracle.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef TWIST_MUX_TEST_DIR
+#define TWIST_MUX_TEST_DIR "test"
+#endif
+
+namespace
+{
+using twist_mux::Arbiter;
+using twist_mux::TwistMux;
+using twist_mux::test::Oracle;
+
+struct Source
+{
+  std::string name;
+  int priority;
+  double timeout;
+  bool expire_on_idle;
+};
+
+struct Event
+{
+  Arbiter::time_type time;  // [ns]
+  bool lock;
+  std::size_t source;
+  double value;  // linear.x, or lock data
+};
+
+struct Schedule
+{
+  std::vector<Source> inputs;
+  std::vector<Source> locks;
+  std::vector<Event> events;
+};
+
+// Simulated time starts here, so that a zero stamp still means "never received".
+constexpr Arbiter::time_type START = 1000000000;
+
+std::size_t indexOf(const std::vector<Source> & sources, const std::string & name)
+{
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    if (sources[i].name == name) {
+      return i;
+    }
+  }
+  throw std::runtime_error("unknown source '" + name + "'");
+}
+
+Schedule loadSchedule(const std::string & path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("cannot open " + path);
+  }
+
+  Schedule schedule;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream in(line);
+    std::string first;
+    if (!(in >> first) || first[0] == '#') {
+      continue;
+    }
+
+    Source source{};
+    if (first == "input") {
+      in >> source.name >> source.priority >> source.timeout >> source.expire_on_idle;
+      schedule.inputs.push_back(source);
+    } else if (first == "lock") {
+      in >> source.name >> source.priority >> source.timeout;
+      schedule.locks.push_back(source);
+    } else {
+      std::string kind, name;
+      Event event{};
+      in >> kind >> name >> event.value;
+      event.time = START + std::llround(std::stod(first) * 1e9);
+      event.lock = kind == "l";
+      event.source = indexOf(event.lock ? schedule.locks : schedule.inputs, name);
+      schedule.events.push_back(event);
+    }
+    if (in.fail()) {
+      throw std::runtime_error("malformed line in " + path + ": " + line);
+    }
+  }
+  return schedule;
+}
+
+/**
+ * @brief Synthetic schedule: Poisson arrivals at the aggregate rate, spread
+ * over four inputs and two locks. Every input goes silent for part of its
+ * cycle so its timeout expires, the joystick sends zero twists (expire_on_idle),
+ * pause toggles and the e-stop heartbeat drops out now and then.
+ */
+Schedule syntheticSchedule(double rate, double duration, unsigned seed)
+{
+  struct Spec
+  {
+    double share;  // of the aggregate rate
+    double cycle;  // [s]
+    double silent;  // silent part of the cycle [s]
+  };
+
+  Schedule schedule;
+  schedule.inputs = {
+    {"navigation", 10, 0.5, false},
+    {"teleop", 50, 0.3, false},
+    {"joystick", 100, 0.3, true},
+    {"safety", 200, 0.2, false},
+  };
+  schedule.locks = {
+    {"pause", 150, 0.0, false},
+    {"e_stop", 255, 1.0, false},
+  };
+  const std::vector<Spec> specs = {
+    {0.45, 7.0, 1.0}, {0.20, 3.0, 1.5}, {0.20, 2.0, 0.8}, {0.05, 5.0, 4.0},
+    {0.05, 4.0, 0.0}, {0.05, 11.0, 1.5},
+  };
+
+  std::mt19937 rng(seed);
+  std::exponential_distribution<double> gap(rate);
+  std::discrete_distribution<std::size_t> pick(
+    {specs[0].share, specs[1].share, specs[2].share, specs[3].share, specs[4].share,
+      specs[5].share});
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  for (double t = gap(rng); t < duration; t += gap(rng)) {
+    const std::size_t k = pick(rng);
+    if (std::fmod(t + 0.37 * k, specs[k].cycle) < specs[k].silent) {
+      continue;
+    }
+
+    Event event{};
+    event.time = START + std::llround(t * 1e9);
+    event.lock = k >= schedule.inputs.size();
+    event.source = event.lock ? k - schedule.inputs.size() : k;
+    if (!event.lock) {
+      const bool idle = schedule.inputs[k].expire_on_idle && uniform(rng) < 0.3;
+      event.value = idle ? 0.0 : 0.1 + uniform(rng);
+    } else if (schedule.locks[event.source].name == "pause") {
+      event.value = std::fmod(t, specs[k].cycle) < 0.5 ? 1.0 : 0.0;
+    }
+    schedule.events.push_back(event);
+  }
+  return schedule;
+}
+
+struct Report
+{
+  std::size_t events = 0;
+  std::size_t forwarded = 0;
+  double mean_ns = 0.0;  // callback time per message
+  double max_ns = 0.0;
+  double max_queue_ns = 0.0;  // worst wait before the callback could start
+  double busy = 0.0;  // callback time / schedule span
+  std::string mismatch;  // first disagreement with the oracle
+};
+
+Report replay(const Schedule & schedule)
+{
+  std::vector<rclcpp::Parameter> overrides = {rclcpp::Parameter("use_sim_time", true)};
+  for (const auto & input : schedule.inputs) {
+    const std::string prefix = "topics." + input.name;
+    overrides.emplace_back(prefix + ".topic", "replay/" + input.name);
+    overrides.emplace_back(prefix + ".timeout", input.timeout);
+    overrides.emplace_back(prefix + ".priority", input.priority);
+    overrides.emplace_back(prefix + ".expire_on_idle", input.expire_on_idle);
+  }
+  for (const auto & lock : schedule.locks) {
+    const std::string prefix = "locks." + lock.name;
+    overrides.emplace_back(prefix + ".topic", "replay/" + lock.name);
+    overrides.emplace_back(prefix + ".timeout", lock.timeout);
+    overrides.emplace_back(prefix + ".priority", lock.priority);
+  }
+  auto mux = std::make_shared<TwistMux>(rclcpp::NodeOptions().parameter_overrides(overrides));
+
+  // Simulated time is set directly; nothing is spun, so no timer ever fires.
+  rcl_clock_t * clock = mux->get_clock()->get_clock_handle();
+  rcl_enable_ros_time_override(clock);
+  rcl_set_ros_time_override(clock, START);
+
+  // Handles are in priority order; map them to the schedule order.
+  auto & set = mux->current();
+  std::vector<twist_mux::VelocityStampedTopicHandle *> inputs;
+  std::vector<twist_mux::LockTopicHandle *> locks;
+  std::vector<std::size_t> source_of(set.velocity_stamped_hs->size());
+  for (const auto & input : schedule.inputs) {
+    for (auto & handle : *set.velocity_stamped_hs) {
+      if (handle.getName() == "topics." + input.name) {
+        source_of[handle.getId()] = inputs.size();
+        inputs.push_back(&handle);
+      }
+    }
+  }
+  for (const auto & lock : schedule.locks) {
+    for (auto & handle : *set.lock_hs) {
+      if (handle.getName() == "locks." + lock.name) {
+        locks.push_back(&handle);
+      }
+    }
+  }
+
+  Oracle oracle;
+  for (const auto & input : schedule.inputs) {
+    oracle.addInput(input.priority, std::llround(input.timeout * 1e9));
+  }
+  for (const auto & lock : schedule.locks) {
+    oracle.addLock(lock.priority, std::llround(lock.timeout * 1e9));
+  }
+
+  // Messages are built up front, so only the mux is timed.
+  std::vector<geometry_msgs::msg::TwistStamped::ConstSharedPtr> twists(schedule.events.size());
+  std::vector<std_msgs::msg::Bool::ConstSharedPtr> bools(schedule.events.size());
+  for (std::size_t i = 0; i < schedule.events.size(); ++i) {
+    const Event & event = schedule.events[i];
+    if (event.lock) {
+      auto msg = std::make_shared<std_msgs::msg::Bool>();
+      msg->data = event.value != 0.0;
+      bools[i] = msg;
+    } else {
+      auto msg = std::make_shared<geometry_msgs::msg::TwistStamped>();
+      msg->header.stamp = rclcpp::Time(event.time);
+      msg->twist.linear.x = event.value;
+      twists[i] = msg;
+    }
+  }
+
+  Report report;
+  report.events = schedule.events.size();
+  double total_ns = 0.0;
+  double free_at = 0.0;  // when the previous callback finished [ns]
+  for (std::size_t i = 0; i < schedule.events.size(); ++i) {
+    const Event & event = schedule.events[i];
+    rcl_set_ros_time_override(clock, event.time);
+
+    bool forwarded = false;
+    const auto start = std::chrono::steady_clock::now();
+    if (event.lock) {
+      locks[event.source]->callback(bools[i], set);
+    } else {
+      auto & handle = *inputs[event.source];
+      const auto before = handle.getMetrics().forwarded();
+      handle.callback(twists[i], set);
+      forwarded = handle.getMetrics().forwarded() != before;
+    }
+    const double ns = std::chrono::duration<double, std::nano>(
+      std::chrono::steady_clock::now() - start).count();
+
+    total_ns += ns;
+    report.max_ns = std::max(report.max_ns, ns);
+    const double begin = std::max(static_cast<double>(event.time), free_at);
+    report.max_queue_ns = std::max(report.max_queue_ns, begin - event.time);
+    free_at = begin + ns;
+
+    // Oracle.
+    Arbiter::id_type expected;
+    if (event.lock) {
+      oracle.onLock(event.source, event.time, event.value != 0.0);
+      expected = oracle.winner(event.time);
+    } else {
+      const bool refresh = !schedule.inputs[event.source].expire_on_idle || event.value != 0.0;
+      oracle.onInput(event.source, event.time, refresh);
+      expected = oracle.winner(event.time);
+      report.forwarded += forwarded;
+    }
+    const Arbiter::id_type winner = mux->current().arbiter.winner();
+    const Arbiter::id_type actual = winner == Arbiter::NONE ? Arbiter::NONE : source_of[winner];
+
+    const bool forward_ok = event.lock || forwarded == (expected == event.source);
+    if (actual != expected || !forward_ok) {
+      std::ostringstream what;
+      what << "event " << i << " at " << (event.time - START) * 1e-9 << " s ("
+           << (event.lock ? "lock " : "input ") << event.source << "): winner " <<
+        static_cast<long>(actual) << ", oracle " << static_cast<long>(expected) <<
+        (forward_ok ? "" : ", forwarding differs");
+      report.mismatch = what.str();
+      break;
+    }
+  }
+
+  if (report.events > 0) {
+    report.mean_ns = total_ns / report.events;
+    const double span = static_cast<double>(
+      schedule.events.back().time - schedule.events.front().time);
+    report.busy = span > 0 ? total_ns / span : 0.0;
+  }
+  return report;
+}
+
+class RclcppEnvironment : public ::testing::Environment
+{
+public:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown() override
+  {
+    rclcpp::shutdown();
+  }
+};
+
+::testing::Environment * const rclcpp_environment =
+  ::testing::AddGlobalTestEnvironment(new RclcppEnvironment);
+}  // namespace
+
+TEST(Replay, RecordedScheduleMatchesOracle)
+{
+  const char * path = std::getenv("TWIST_MUX_REPLAY");
+  const Schedule schedule = loadSchedule(
+    path ? path : TWIST_MUX_TEST_DIR "/replay_schedule.txt");
+  ASSERT_FALSE(schedule.events.empty());
+
+  const Report report = replay(schedule);
+  EXPECT_EQ("", report.mismatch);
+  EXPECT_GT(report.forwarded, 0u);
+  EXPECT_LT(report.forwarded, report.events);
+}
+
+class ReplayLoad : public ::testing::TestWithParam<double>
+{
+};
+
+// Aggregate input rate [Hz] over 20 s of simulated time.
+TEST_P(ReplayLoad, MatchesOracleAndReports)
+{
+  const double rate = GetParam();
+  const Schedule schedule = syntheticSchedule(rate, 20.0, 42);
+
+  const Report report = replay(schedule);
+  EXPECT_EQ("", report.mismatch);
+
+  std::printf(
+    "[ replay %6.0f Hz ] %zu events, %zu forwarded: %.0f ns/msg (max %.0f ns), "
+    "max queueing delay %.0f ns, busy %.3f%%\n",
+    rate, report.events, report.forwarded, report.mean_ns, report.max_ns,
+    report.max_queue_ns, 100.0 * report.busy);
+  RecordProperty("ns_per_msg", static_cast<int>(report.mean_ns));
+  RecordProperty("max_queueing_delay_ns", static_cast<int>(report.max_queue_ns));
+}
+
+INSTANTIATE_TEST_SUITE_P(TwistMux, ReplayLoad, ::testing::Values(100.0, 1000.0, 10000.0));
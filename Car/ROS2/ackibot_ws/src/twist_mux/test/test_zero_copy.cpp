@@ -0,0 +1,168 @@
+// Copyright (c) 2024 Milos Subotic
+//
+// Licensed under the MIT License; see LICENSE in the repository root.
+
+#include <gtest/gtest.h>
+
+#include <rclcpp/rclcpp.hpp>
+#include <geometry_msgs/msg/twist_stamped.hpp>
+
+#include <twist_mux/twist_mux.hpp>
+#include <twist_mux/topic_handle.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts the heap allocations of each thread, so rclcpp's background threads
+// do not add noise to what the test thread measures.
+static thread_local std::size_t t_allocations = 0;
+
+void * operator new(std::size_t size)
+{
+  ++t_allocations;
+  if (void * p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+constexpr int MESSAGES = 1000;
+constexpr auto PERIOD = std::chrono::milliseconds(1);  // 1 kHz input
+// Allocations the mux may add over a bare publish() for the whole run, i.e.
+// well under one per message: only one-time growth (first copy of the
+// message, arbiter and metrics state) is allowed, nothing per message.
+constexpr std::size_t MAX_EXTRA_ALLOCATIONS = MESSAGES / 100;
+
+/**
+ * @brief TestTwistMux Exposes the input handles so the test can feed them
+ * directly, bypassing the executor.
+ */
+class TestTwistMux : public twist_mux::TwistMux
+{
+public:
+  twist_mux::VelocityStampedTopicHandle & input()
+  {
+    return current().velocity_stamped_hs->front();
+  }
+};
+
+std::vector<geometry_msgs::msg::TwistStamped::ConstSharedPtr> makeMessages()
+{
+  std::vector<geometry_msgs::msg::TwistStamped::ConstSharedPtr> msgs;
+  for (int i = 0; i < MESSAGES; ++i) {
+    auto msg = std::make_shared<geometry_msgs::msg::TwistStamped>();
+    // Longer than the small string buffer, so copying the header allocates.
+    msg->header.frame_id = "base_link_with_a_long_frame_name";
+    msg->twist.linear.x = 0.5;
+    msg->twist.angular.z = 0.1 * (i % 10);
+    msgs.push_back(msg);
+  }
+  return msgs;
+}
+
+// Feeds every message at 1 kHz and returns the allocations it took.
+template<typename F>
+std::size_t allocationsAt1kHz(
+  const std::vector<geometry_msgs::msg::TwistStamped::ConstSharedPtr> & msgs, F && feed)
+{
+  auto next = std::chrono::steady_clock::now();
+  std::size_t allocations = 0;
+  for (const auto & msg : msgs) {
+    const std::size_t before = t_allocations;
+    feed(msg);
+    allocations += t_allocations - before;
+    next += PERIOD;
+    std::this_thread::sleep_until(next);
+  }
+  return allocations;
+}
+
+std::shared_ptr<TestTwistMux> makeMux(bool zero_copy)
+{
+  std::vector<std::string> args = {
+    "test_zero_copy", "--ros-args",
+    "-p", std::string("zero_copy:=") + (zero_copy ? "true" : "false"),
+    "-p", "topics.fast.topic:=fast_vel",
+    "-p", "topics.fast.timeout:=0.5",
+    "-p", "topics.fast.priority:=100",
+    "-p", "topics.fast.expire_on_idle:=false",
+  };
+  std::vector<const char *> argv;
+  for (const auto & arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  rclcpp::init(static_cast<int>(argv.size()), argv.data());
+
+  return std::make_shared<TestTwistMux>();
+}
+}  // namespace
+
+class ZeroCopy : public ::testing::TestWithParam<bool>
+{
+protected:
+  void TearDown() override
+  {
+    rclcpp::shutdown();
+  }
+};
+
+// Forwarding a message allocates no more than publishing it directly, up to
+// MAX_EXTRA_ALLOCATIONS for the whole run. In zero-copy mode the handle also
+// keeps the received message itself, not a copy.
+TEST_P(ZeroCopy, ForwardsWithoutExtraAllocations)
+{
+  const bool zero_copy = GetParam();
+  auto mux = makeMux(zero_copy);
+  ASSERT_EQ(zero_copy, mux->isZeroCopy());
+
+  const auto msgs = makeMessages();
+
+  // Baseline: a bare publisher of the same type, published the same way.
+  auto raw_node = std::make_shared<rclcpp::Node>("raw_publisher");
+  auto raw_pub = raw_node->create_publisher<geometry_msgs::msg::TwistStamped>(
+    "raw_vel", rclcpp::QoS(rclcpp::KeepLast(1)));
+  const std::size_t raw = allocationsAt1kHz(
+    msgs, [&](const geometry_msgs::msg::TwistStamped::ConstSharedPtr & msg) {
+      raw_pub->publish(*msg);
+    });
+
+  auto & input = mux->input();
+  const std::size_t muxed = allocationsAt1kHz(
+    msgs, [&](const geometry_msgs::msg::TwistStamped::ConstSharedPtr & msg) {
+      input.callback(msg, mux->current());
+    });
+
+  RecordProperty("raw_allocations", static_cast<int>(raw));
+  RecordProperty("mux_allocations", static_cast<int>(muxed));
+  std::printf(
+    "[ zero_copy=%d ] raw publish: %zu allocations, mux: %zu allocations for %d messages\n",
+    zero_copy, raw, muxed, MESSAGES);
+  EXPECT_LE(muxed, raw + MAX_EXTRA_ALLOCATIONS);
+
+  if (zero_copy) {
+    // Only the pointer to the last message is held, not a copy.
+    EXPECT_EQ(msgs.back().get(), &input.getMessage());
+  } else {
+    EXPECT_NE(msgs.back().get(), &input.getMessage());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(TwistMux, ZeroCopy, ::testing::Values(false, true));
@@ -31,23 +31,46 @@ class MFCCProcessor:
                 n_mfcc=n_mfcc,
             )
 
-    def process_frame(self, frame):
+    def resample(self, y, orig_sr):
         """
-        Processing audio frame (512 samples) and returns MFCC (n_mfcc,).
-        Padding/trunc if frame is not 512 samples.
+        Resample a whole signal from `orig_sr` to `sample_rate`.
+        Uses the native polyphase resampler when available, librosa otherwise.
         """
+        if orig_sr == self.sample_rate:
+            return np.asarray(y, dtype=np.float32)
+
+        if reson is not None:
+            resampler = reson.dsp.PolyphaseResampler(
+                input_rate=int(orig_sr),
+                output_rate=int(self.sample_rate),
+            )
+            return np.asarray(resampler.process(np.asarray(y, dtype=np.float32)))
+
+        return librosa.resample(y, orig_sr=orig_sr, target_sr=self.sample_rate)
+
+    def _fit_frame(self, frame):
         frame_len = len(frame)
         if frame_len < 512:
             frame = np.pad(frame, (0, 512 - frame_len))
         elif frame_len > 512:
             frame = frame[:512]
+        return frame
 
-        if self.mfcc_pipeline is not None:
-            frame_obj = reson.core.Frame512()
-            for i in range(512):
-                frame_obj[i] = float(frame[i])
+    def _to_reson_frame(self, frame):
+        frame_obj = reson.core.Frame512()
+        for i in range(512):
+            frame_obj[i] = float(frame[i])
+        return frame_obj
+
+    def process_frame(self, frame):
+        """
+        Processing audio frame (512 samples) and returns MFCC (n_mfcc,).
+        Padding/trunc if frame is not 512 samples.
+        """
+        frame = self._fit_frame(frame)
 
-            mfccs = self.mfcc_pipeline.process(frame_obj)
+        if self.mfcc_pipeline is not None:
+            mfccs = self.mfcc_pipeline.process(self._to_reson_frame(frame))
             mfccs = np.asarray(mfccs, dtype=np.float32)
             return mfccs.reshape(-1)
 
@@ -64,6 +87,34 @@ class MFCCProcessor:
         )
         return np.asarray(mfcc[:, 0], dtype=np.float32)
 
+    def process_chunk_gated(self, frames):
+        """
+        MFCCs of a whole chunk, gated by activity: returns (active, MFCC),
+        MFCC of shape (n_frames, n_mfcc).
+        With the native backend a chunk without any active frame skips the
+        Mel/log/DCT stages and returns (False, None). An active chunk gets
+        the same MFCCs as `process_frame()` for every frame, silent ones
+        included, since the model is trained on ungated features.
+        The librosa fallback reports every chunk as active.
+        """
+        if self.mfcc_pipeline is None:
+            return True, np.array([self.process_frame(f) for f in frames])
+
+        frame_objs = [self._to_reson_frame(self._fit_frame(f)) for f in frames]
+        active, mfccs = self.mfcc_pipeline.process_chunk_gated(frame_objs)
+        if not active:
+            return False, None
+        return True, np.asarray(mfccs, dtype=np.float32)
+
+    def reset_activity(self):
+        """
+        Forget the activity detector state (noise floor, hangover).
+        Call at every song/stream boundary, so one track does not
+        gate the start of the next. No-op for the librosa fallback.
+        """
+        if self.mfcc_pipeline is not None:
+            self.mfcc_pipeline.reset_activity()
+
 # ================= AUDIO AUGMENTOR =================
 class AudioAugmentor:
     def __init__(self, sr=22050):
@@ -66,26 +66,30 @@ mfcc_proc = MFCCProcessor(sample_rate=SR)
 def extract_features(y):
     frame_size = 512
     hop = 256
-    frames = []
-
-    for i in range(0, len(y) - frame_size, hop):
-        frame = y[i:i+frame_size]
-        mfcc = mfcc_proc.process_frame(frame)
-        frames.append(mfcc)
+    frames = [y[i:i+frame_size] for i in range(0, len(y) - frame_size, hop)]
 
     if len(frames) == 0:
-        frames.append(np.zeros(13))
+        mfcc = np.zeros((13, 1))
+    else:
+        # Only whole silent chunks are skipped; an active chunk gets real
+        # MFCCs for every frame, the same as in training
+        active, mfccs = mfcc_proc.process_chunk_gated(frames)
+        if not active:
+            return None, False
+        mfcc = mfccs.T
 
-    mfcc = np.array(frames).T
     delta = librosa.feature.delta(mfcc)
     delta2 = librosa.feature.delta(mfcc, order=2)
     feat = np.stack([mfcc, delta, delta2], axis=1)
     feat = np.transpose(feat, (2,1,0))
-    return feat
+    return feat, True
 
 # ===== PREDICT SONG =====
 def predict_song(path):
-    y, _ = librosa.load(path, sr=SR)
+    y, orig_sr = librosa.load(path, sr=None)
+    y = mfcc_proc.resample(y, orig_sr)
+    # New song: noise floor of the previous one must not gate this one
+    mfcc_proc.reset_activity()
     num_chunks = max(1, len(y) // chunk_len)
     predictions = []
 
@@ -94,7 +98,10 @@ def predict_song(path):
 
     for i in tqdm(range(num_chunks), desc="Chunk prediction"):
         chunk = y[i*chunk_len:(i+1)*chunk_len]
-        features = extract_features(chunk)
+        features, active = extract_features(chunk)
+        if not active:
+            # Silent chunk, nothing to classify
+            continue
 
         # padding/trimming
         if features.shape[0] < FRAMES_PER_CHUNK:
@@ -107,6 +114,10 @@ def predict_song(path):
         pred = np.argmax(model.predict(features, verbose=0))
         predictions.append(pred)
 
+    if len(predictions) == 0:
+        print("\nNo activity detected in the song.")
+        return ""
+
     vote = Counter(predictions).most_common(1)[0][0]
     print(f"\nPredicted country: {inverse_labels[vote]}")
     return inverse_labels[vote]
@@ -126,6 +137,8 @@ if __name__ == "__main__":
         pg.mixer.music.play()    
         MESSAGE = predict_song(selected_file)
         MESSAGE = MESSAGE.strip()  # Remove any leading/trailing whitespace
+        if not MESSAGE:
+            continue
 
     
 
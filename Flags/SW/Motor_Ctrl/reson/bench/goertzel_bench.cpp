@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "../include/core/frame.hpp"
+#include "../include/core/spectre.hpp"
+#include "../include/dsp/fft.hpp"
+#include "../include/dsp/helpers.hpp"
+#include "../include/dsp/goertzel.hpp"
+#include "../tests/generator.hpp"
+
+// Goertzel vs FFT benchmark.
+//
+// For each frame size, times FFT<N> + power_spectrum() against Goertzel<N>
+// with K target bins and reports the largest K for which Goertzel is still
+// faster.
+
+template<typename F>
+double ns_per_frame(int iterations, F&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) body();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+template<size_t N>
+void run(int iterations) {
+    const float sample_rate = 22050.0f;
+    const auto frame = create_sum_sinusoids_frame<N>({440.0f, 1000.0f, 3150.0f}, 0.3f, sample_rate);
+
+    reson::dsp::FFT<N> fft;
+    reson::core::SpectreSoA<N> spectre;
+    volatile float sink = 0.0f;
+
+    const double fft_ns = ns_per_frame(iterations, [&] {
+        fft.process(frame, spectre);
+        sink = sink + reson::dsp::power_spectrum(spectre)[N / 8];
+    });
+
+    std::printf("N=%zu  FFT+power: %.0f ns/frame\n", N, fft_ns);
+    std::printf("  %4s  %14s  %8s\n", "K", "Goertzel ns", "speedup");
+
+    size_t crossover = 0;
+    for (size_t K : {1, 2, 3, 4, 8, 12, 16, 32, 64}) {
+        std::vector<float> freqs;
+        for (size_t k = 0; k < K; ++k)
+            freqs.push_back(100.0f + k * (sample_rate / 2 - 200.0f) / K);
+
+        reson::dsp::Goertzel<N> goertzel(sample_rate, freqs);
+        std::vector<float> power;
+        const double g_ns = ns_per_frame(iterations, [&] {
+            goertzel.process(frame, power);
+            sink = sink + power[0];
+        });
+
+        std::printf("  %4zu  %14.0f  %7.2fx\n", K, g_ns, fft_ns / g_ns);
+        if (g_ns < fft_ns) crossover = K;
+    }
+    std::printf("  Goertzel faster up to K=%zu bins\n\n", crossover);
+}
+
+int main() {
+    run<256>(20000);
+    run<512>(10000);
+    run<1024>(5000);
+    run<2048>(2000);
+    return 0;
+}
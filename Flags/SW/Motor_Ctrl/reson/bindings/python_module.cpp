@@ -1,12 +1,16 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/complex.h>
+#include <pybind11/numpy.h>
 
 #include "../include/core/frame.hpp"
 #include "../include/core/spectre.hpp"
 #include "../include/dsp/fft.hpp"
 #include "../include/dsp/window.hpp"
 #include "../include/dsp/mel.hpp"
+#include "../include/dsp/activity.hpp"
+#include "../include/dsp/goertzel.hpp"
+#include "../include/dsp/resampler.hpp"
 
 #include "../include/features/mfcc_pipeline.hpp"
 
@@ -34,12 +38,32 @@ namespace py = pybind11;
 #define BIND_FFT_CLASS(module, cls, name) \
   py::class_<cls>(module, name) \
       .def(py::init<>()) \
-      .def("process", &cls::process)
+      .def("process", py::overload_cast<const cls::frame_type&, cls::spectre_type&>(&cls::process, py::const_))
+
+#define BIND_GOERTZEL_CLASSES(module, goertzel_cls, sliding_cls, name, sliding_name) \
+  py::class_<goertzel_cls>(module, name) \
+      .def(py::init<float, const std::vector<float>&>(), py::arg("sample_rate"), py::arg("frequencies_hz")) \
+      .def("process", py::overload_cast<const goertzel_cls::frame_type&>(&goertzel_cls::process, py::const_)) \
+      .def("frequencies", &goertzel_cls::frequencies); \
+  py::class_<sliding_cls>(module, sliding_name) \
+      .def(py::init<float, const std::vector<float>&>(), py::arg("sample_rate"), py::arg("frequencies_hz")) \
+      .def("push", py::overload_cast<float>(&sliding_cls::push)) \
+      .def("push_frame", py::overload_cast<const sliding_cls::frame_type&>(&sliding_cls::push)) \
+      .def("power", py::overload_cast<>(&sliding_cls::power, py::const_)) \
+      .def("bins", &sliding_cls::bins) \
+      .def("reset", &sliding_cls::reset)
 
 #define BIND_MFCC_PIPELINE(module, cls, name) \
   py::class_<cls>(module, name) \
-      .def(py::init<int, int, int, int, int, int>(), py::arg("sample_rate"), py::arg("n_mels"), py::arg("n_fft"), py::arg("n_mfcc"), py::arg("fmin_hz")=0, py::arg("fmax_hz")=-1) \
-      .def("process", &cls::process)
+      .def(py::init<int, int, int, int, int, int, const reson::dsp::ActivityConfig&>(), py::arg("sample_rate"), py::arg("n_mels"), py::arg("n_fft"), py::arg("n_mfcc"), py::arg("fmin_hz")=0, py::arg("fmax_hz")=-1, py::arg("activity_config")=reson::dsp::ActivityConfig()) \
+      .def("process", &cls::process) \
+      .def("process_chunk_gated", [](cls& obj, const std::vector<cls::frame_type>& frames) { \
+          bool active = false; \
+          auto mfccs = obj.process_chunk_gated(frames, active); \
+          return py::make_tuple(active, mfccs); \
+      }, py::arg("frames")) \
+      .def("is_active", [](const cls& obj) { return obj.activity().is_active(); }) \
+      .def("reset_activity", [](cls& obj) { obj.activity().reset(); })
 
 
 PYBIND11_MODULE(reson, m) {
@@ -65,6 +89,9 @@ PYBIND11_MODULE(reson, m) {
   //Bind FFT<128>
   BIND_FFT_CLASS(dsp, reson::dsp::FFT<128>, "FFT128");
 
+  //Bind Goertzel<128>, SlidingGoertzel<128>
+  BIND_GOERTZEL_CLASSES(dsp, reson::dsp::Goertzel<128>, reson::dsp::SlidingGoertzel<128>, "Goertzel128", "SlidingGoertzel128");
+
   // Bind Frame<256>
   BIND_ARRAY_CLASS(core, reson::core::Frame<256>, "Frame256", float);
   
@@ -78,6 +105,9 @@ PYBIND11_MODULE(reson, m) {
   //Bind FFT<256>
   BIND_FFT_CLASS(dsp, reson::dsp::FFT<256>, "FFT256");
 
+  //Bind Goertzel<256>, SlidingGoertzel<256>
+  BIND_GOERTZEL_CLASSES(dsp, reson::dsp::Goertzel<256>, reson::dsp::SlidingGoertzel<256>, "Goertzel256", "SlidingGoertzel256");
+
   // Bind Frame<512>
   BIND_ARRAY_CLASS(core, reson::core::Frame<512>, "Frame512", float);
   
@@ -91,6 +121,9 @@ PYBIND11_MODULE(reson, m) {
   //Bind FFT<512>
   BIND_FFT_CLASS(dsp, reson::dsp::FFT<512>, "FFT512");
 
+  //Bind Goertzel<512>, SlidingGoertzel<512>
+  BIND_GOERTZEL_CLASSES(dsp, reson::dsp::Goertzel<512>, reson::dsp::SlidingGoertzel<512>, "Goertzel512", "SlidingGoertzel512");
+
   // Bind Frame<1024>
   BIND_ARRAY_CLASS(core, reson::core::Frame<1024>, "Frame1024", float);
   
@@ -104,12 +137,37 @@ PYBIND11_MODULE(reson, m) {
   //Bind FFT<1024>
   BIND_FFT_CLASS(dsp, reson::dsp::FFT<1024>, "FFT1024");
 
+  //Bind Goertzel<1024>, SlidingGoertzel<1024>
+  BIND_GOERTZEL_CLASSES(dsp, reson::dsp::Goertzel<1024>, reson::dsp::SlidingGoertzel<1024>, "Goertzel1024", "SlidingGoertzel1024");
+
   // Bind MelFilterBank
   py::class_<reson::dsp::MelFilterBank>(dsp, "MelFilterBank")
       .def(py::init<int, int, int, float, float, bool>(), py::arg("sample_rate"), py::arg("n_fft"), py::arg("n_mels"), py::arg("fmin_hz")=0.0f, py::arg("fmax_hz")=-1.0f, py::arg("normalize_by_sum")=true)
       .def("apply", &reson::dsp::MelFilterBank::apply)
       .def("get_filterbank", &reson::dsp::MelFilterBank::get_filterbank);
 
+  // Bind PolyphaseResampler
+  py::class_<reson::dsp::PolyphaseResampler>(dsp, "PolyphaseResampler")
+      .def(py::init<int, int, int, float, float>(), py::arg("input_rate"), py::arg("output_rate"), py::arg("taps_per_phase")=32, py::arg("cutoff")=0.9f, py::arg("kaiser_beta")=8.0f)
+      .def("process", [](reson::dsp::PolyphaseResampler& obj, py::array_t<float, py::array::c_style | py::array::forcecast> in) {
+          std::vector<float> out;
+          obj.process(in.data(), static_cast<size_t>(in.size()), out);
+          return py::array_t<float>(out.size(), out.data());
+      }, py::arg("samples"))
+      .def("reset", &reson::dsp::PolyphaseResampler::reset)
+      .def("up", &reson::dsp::PolyphaseResampler::up)
+      .def("down", &reson::dsp::PolyphaseResampler::down)
+      .def("delay", &reson::dsp::PolyphaseResampler::delay);
+
+  // Bind ActivityConfig
+  py::class_<reson::dsp::ActivityConfig>(dsp, "ActivityConfig")
+      .def(py::init<>())
+      .def_readwrite("energy_margin_db", &reson::dsp::ActivityConfig::energy_margin_db)
+      .def_readwrite("flatness_threshold", &reson::dsp::ActivityConfig::flatness_threshold)
+      .def_readwrite("min_energy_db", &reson::dsp::ActivityConfig::min_energy_db)
+      .def_readwrite("noise_adapt", &reson::dsp::ActivityConfig::noise_adapt)
+      .def_readwrite("hangover_frames", &reson::dsp::ActivityConfig::hangover_frames);
+
   // Bind MFCCPipeline<128>
   BIND_MFCC_PIPELINE(features, MFCCPipeline<128>, "MFCCPipeline128");
 
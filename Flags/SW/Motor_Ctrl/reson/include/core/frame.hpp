@@ -9,13 +9,14 @@ namespace reson::core{
      * @ingroup core
      * @brief Fixed-size time-domain audio frame.
      *
-     * Lightweight wrapper around `std::array<float, N>`.
+     * Lightweight wrapper around `std::array<float, N>`, aligned to
+     * `SIMD_ALIGNMENT` so vector kernels can use aligned loads.
      *
      * @tparam N Number of samples in the frame.
      */
     template<size_t N>
     struct Frame{
-        std::array<float, N> samples;
+        alignas(SIMD_ALIGNMENT) std::array<float, N> samples;
         
         float& operator[](size_t i) { return samples[i]; }
         const float& operator[](size_t i) const { return samples[i]; }
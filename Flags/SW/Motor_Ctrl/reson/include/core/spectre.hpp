@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <array>
 #include <complex>
+#include "types.hpp"
 
 namespace reson::core{
 
@@ -24,4 +25,87 @@ namespace reson::core{
 
         size_t length() const { return N; }
     };
-}
\ No newline at end of file
+
+    /**
+     * @ingroup core
+     * @brief Structure-of-Arrays complex spectrum.
+     *
+     * Real and imaginary parts live in separate, `SIMD_ALIGNMENT`-aligned
+     * arrays, so vector kernels (FFT butterflies, power spectrum) work on
+     * contiguous lanes without re/im shuffles. Produced natively by
+     * `reson::dsp::FFT<N>`.
+     *
+     * `operator[]` returns a `ComplexRef` view over `re[i]`/`im[i]`, so
+     * elements can be read and assigned like `std::complex<float>` without
+     * copying the spectrum. `FFT<N>` writes both layouts natively; only code
+     * that needs an actual `Spectre<N>` object has to copy with
+     * `to_interleaved()`.
+     *
+     * @tparam N Number of complex FFT bins.
+     */
+    template<size_t N>
+    struct SpectreSoA{
+        alignas(SIMD_ALIGNMENT) std::array<float, N> re;
+        alignas(SIMD_ALIGNMENT) std::array<float, N> im;
+
+        /**
+         * @brief Reference to one bin, split over `re` and `im`.
+         */
+        struct ComplexRef {
+            float& re;
+            float& im;
+
+            operator std::complex<float>() const { return { re, im }; }
+            float real() const { return re; }
+            float imag() const { return im; }
+
+            ComplexRef& operator=(const std::complex<float>& value) {
+                re = value.real();
+                im = value.imag();
+                return *this;
+            }
+            ComplexRef& operator=(const ComplexRef& other) {
+                return *this = std::complex<float>(other);
+            }
+        };
+
+        SpectreSoA() = default;
+
+        ComplexRef operator[](size_t i) { return { re[i], im[i] }; }
+        std::complex<float> operator[](size_t i) const { return { re[i], im[i] }; }
+
+        void set(size_t i, const std::complex<float>& value) {
+            re[i] = value.real();
+            im[i] = value.imag();
+        }
+
+        size_t length() const { return N; }
+    };
+
+    /**
+     * @ingroup core
+     * @brief Copy an SoA spectrum into interleaved complex storage.
+     *
+     * A full O(N) copy, not a view; prefer `SpectreSoA::operator[]` or
+     * running `FFT<N>` straight into the layout that is needed.
+     */
+    template<size_t N>
+    void to_interleaved(const SpectreSoA<N>& in, Spectre<N>& out) {
+        for (size_t i = 0; i < N; ++i)
+            out[i] = { in.re[i], in.im[i] };
+    }
+
+    /**
+     * @ingroup core
+     * @brief Split an interleaved spectrum into SoA storage.
+     *
+     * A full O(N) copy, not a view.
+     */
+    template<size_t N>
+    void to_soa(const Spectre<N>& in, SpectreSoA<N>& out) {
+        for (size_t i = 0; i < N; ++i) {
+            out.re[i] = in[i].real();
+            out.im[i] = in[i].imag();
+        }
+    }
+}
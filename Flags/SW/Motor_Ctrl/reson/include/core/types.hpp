@@ -29,6 +29,13 @@ namespace reson::core{
     constexpr float DEFAULT_SAMPLE_RATE = 44100.0f; 
     /** @ingroup core */
     constexpr float PI = 3.14159265359f;
+    /**
+     * @ingroup core
+     * @brief Alignment (bytes) of sample and spectrum storage.
+     *
+     * One cache line; also covers AVX (32) and AVX-512 (64) loads.
+     */
+    constexpr size_t SIMD_ALIGNMENT = 64;
 
 
 
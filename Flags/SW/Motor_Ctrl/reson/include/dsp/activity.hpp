@@ -0,0 +1,141 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "../core/types.hpp"
+
+namespace reson::dsp {
+
+/**
+ * @ingroup dsp
+ * @brief Tuning parameters for `ActivityDetector<N>`.
+ */
+struct ActivityConfig {
+    /** Frame energy must exceed the tracked noise floor by this many dB. */
+    float energy_margin_db = 6.0f;
+    /**
+     * Spectral flatness (0 = pure tone, 1 = flat spectrum) must be below this.
+     * A white noise periodogram lands around 0.56.
+     */
+    float flatness_threshold = 0.3f;
+    /** Absolute energy floor (dB); frames below it are always inactive. */
+    float min_energy_db = -80.0f;
+    /** Smoothing factor for the noise floor update on inactive frames. */
+    float noise_adapt = 0.05f;
+    /** Number of frames to stay active after the last detection. */
+    int hangover_frames = 3;
+};
+
+template<size_t N>
+/**
+ * @ingroup dsp
+ * @brief Energy + spectral-flatness voice/music activity detector.
+ *
+ * Works on the power spectrum that the MFCC pipeline already computes, so the
+ * only extra cost per frame is one pass over the `N/2 + 1` positive bins.
+ * Keeps a running noise floor estimate (fast attack downwards, slow
+ * adaptation upwards on inactive frames) and a short hangover so that word
+ * or note boundaries are not clipped.
+ *
+ * @tparam N Frame size (power spectrum holds `N` bins, only `N/2 + 1` are used).
+ */
+class ActivityDetector {
+public:
+
+    explicit ActivityDetector(const ActivityConfig& config = ActivityConfig())
+        : config_(config)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Classify one frame.
+     * @param power_spec Power spectrum as returned by `power_spectrum<N>()`.
+     * @return True if the frame carries voice/music activity.
+     */
+    bool update(const std::array<float, N>& power_spec) {
+        constexpr size_t n_bins = N / 2 + 1;
+
+        // Energy over all positive bins, flatness without the DC bin.
+        float energy = power_spec[0];
+        float sum = 0.0f;
+        float log_sum = 0.0f;
+        for (size_t k = 1; k < n_bins; ++k) {
+            const float p = power_spec[k] + EPS;
+            energy += power_spec[k];
+            sum += p;
+            log_sum += std::log(p);
+        }
+
+        constexpr float n_flat = static_cast<float>(n_bins - 1);
+        const float arith_mean = sum / n_flat;
+        flatness_ = std::exp(log_sum / n_flat) / arith_mean;
+        energy_db_ = 10.0f * std::log10(energy + EPS);
+
+        ++frames_seen_;
+
+        const bool loud = energy_db_ > config_.min_energy_db &&
+                          energy_db_ > noise_floor_db_ + config_.energy_margin_db;
+        const bool structured = flatness_ < config_.flatness_threshold;
+        const bool detected = loud && structured;
+
+        if (detected) {
+            hangover_ = config_.hangover_frames;
+            active_ = true;
+        } else if (hangover_ > 0) {
+            --hangover_;
+            active_ = true;
+        } else {
+            active_ = false;
+        }
+
+        // Track the noise floor: follow drops immediately, adapt slowly to
+        // stationary noise while nothing is detected.
+        if (energy_db_ < noise_floor_db_) {
+            noise_floor_db_ = energy_db_;
+        } else if (!detected) {
+            noise_floor_db_ += config_.noise_adapt * (energy_db_ - noise_floor_db_);
+        }
+
+        if (active_) {
+            ++active_frames_;
+        }
+        return active_;
+    }
+
+    /**
+     * @brief Forget the noise floor and all counters.
+     */
+    void reset() {
+        energy_db_ = config_.min_energy_db;
+        noise_floor_db_ = config_.min_energy_db;
+        flatness_ = 1.0f;
+        hangover_ = 0;
+        active_ = false;
+        frames_seen_ = 0;
+        active_frames_ = 0;
+    }
+
+    bool is_active() const { return active_; }
+    float energy_db() const { return energy_db_; }
+    float noise_floor_db() const { return noise_floor_db_; }
+    float flatness() const { return flatness_; }
+    size_t frames_seen() const { return frames_seen_; }
+    size_t active_frames() const { return active_frames_; }
+
+    const ActivityConfig& config() const { return config_; }
+
+private:
+    static constexpr float EPS = 1e-10f;
+
+    ActivityConfig config_;
+    float energy_db_;
+    float noise_floor_db_;
+    float flatness_;
+    int hangover_;
+    bool active_;
+    size_t frames_seen_;
+    size_t active_frames_;
+};
+
+}
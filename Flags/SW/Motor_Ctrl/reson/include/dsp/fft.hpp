@@ -15,17 +15,25 @@ template<size_t N>
  * @ingroup dsp
  * @brief Radix-2 Cooley–Tukey FFT.
  *
- * Converts a real input frame (`reson::core::Frame<N>`) into a complex spectrum
- * (`reson::core::Spectre<N>`).
+ * Converts a real input frame (`reson::core::Frame<N>`) into a complex spectrum.
+ * The butterflies use per-stage contiguous twiddles and run in place on
+ * either output layout: Structure-of-Arrays (`reson::core::SpectreSoA<N>`),
+ * where the inner loop is plain aligned float arithmetic the compiler can
+ * vectorize, or interleaved (`reson::core::Spectre<N>`), with re/im at a
+ * stride of two floats. Neither layout goes through a copy of the other.
  *
  * @tparam N FFT size (must be a power of 2).
  */
 class FFT{
 
 public:
+    using frame_type = core::Frame<N>;
+    using spectre_type = core::Spectre<N>;
+    using spectre_soa_type = core::SpectreSoA<N>;
 
     FFT() {
         compute_twiddle();
+        compute_bit_reverse();
     }
 
     /**
@@ -34,34 +42,52 @@ public:
      * @param out Output complex spectrum.
      */
     void process(const core::Frame<N>& in, core::Spectre<N>& out) const {
-
         for(size_t i = 0; i < N; i++){
-            buffer[i] = { in[i], 0.0f };
+            out[i] = { in[bit_reverse[i]], 0.0f };
         }
-        
-        bit_reverse(buffer);
 
-        compute_fft(buffer);
+        // std::complex<float> is layout-compatible with float[2]
+        float* data = reinterpret_cast<float*>(out.bins.data());
+        compute_fft<2>(data, data + 1);
+    }
 
-        for(size_t i = 0; i < N; i ++){
-            out[i] = buffer[i];
+    /**
+     * @brief Compute the FFT of a single frame into SoA storage.
+     * @param in Input time-domain frame.
+     * @param out Output complex spectrum (separate re/im arrays).
+     */
+    void process(const core::Frame<N>& in, core::SpectreSoA<N>& out) const {
+        for(size_t i = 0; i < N; i++){
+            out.re[i] = in[bit_reverse[i]];
         }
+        out.im.fill(0.0f);
+
+        compute_fft<1>(out.re.data(), out.im.data());
     }
 
 private:
 
-    using Complex = core::ComplexSample;
-    mutable std::array<Complex, N> buffer;
-    std::array<Complex, N/2> twiddle;
+    // Stage with half-length h keeps its h twiddles at [h, 2h).
+    alignas(core::SIMD_ALIGNMENT) std::array<float, N> twiddle_re;
+    alignas(core::SIMD_ALIGNMENT) std::array<float, N> twiddle_im;
+    std::array<size_t, N> bit_reverse;
 
     void compute_twiddle(){
-        for(size_t i = 0; i < N / 2; i++){
-            float angle = -2.0f * core::PI * i / N;
-            twiddle[i] = { std::cos(angle), std::sin(angle) };
+        twiddle_re.fill(0.0f);
+        twiddle_im.fill(0.0f);
+        for(size_t half = 1; half < N; half <<= 1){
+            size_t step = N / (2 * half);
+            for(size_t j = 0; j < half; j++){
+                float angle = -2.0f * core::PI * (j * step) / N;
+                twiddle_re[half + j] = std::cos(angle);
+                twiddle_im[half + j] = std::sin(angle);
+            }
         }
     }
 
-    void bit_reverse(std::array<Complex, N>& data) const {
+    void compute_bit_reverse(){
+        if (N == 0) return;
+        bit_reverse[0] = 0;
         size_t j = 0;
         for (size_t i = 1; i < N; ++i) {
             size_t bit = N >> 1;
@@ -70,24 +96,32 @@ private:
                 bit >>= 1;
             }
             j |= bit;
-            if (i < j)
-                std::swap(data[i], data[j]);
+            bit_reverse[i] = j;
         }
     }
 
-    void compute_fft(std::array<Complex, N>& data) const {
-        for (size_t len = 2; len <= N; len <<= 1) {
-            size_t half = len >> 1;
-            size_t step = N / len;
+    // Bin k lives at re[k * Stride], im[k * Stride]: 1 for SoA, 2 for interleaved.
+    template<size_t Stride>
+    void compute_fft(float* re, float* im) const {
+        for (size_t half = 1; half < N; half <<= 1) {
+            const float* wr = twiddle_re.data() + half;
+            const float* wi = twiddle_im.data() + half;
 
-            for (size_t i = 0; i < N; i += len) {
-                for (size_t j = 0; j < half; ++j) {
-                    const auto& w = twiddle[j * step];
-                    Complex u = data[i + j];
-                    Complex v = data[i + j + half] * w;
+            for (size_t i = 0; i < N; i += 2 * half) {
+                float* ur = re + i * Stride;
+                float* ui = im + i * Stride;
+                float* vr = re + (i + half) * Stride;
+                float* vi = im + (i + half) * Stride;
 
-                    data[i + j] = u + v;
-                    data[i + j + half] = u - v;
+                for (size_t j = 0; j < half; ++j) {
+                    const size_t k = j * Stride;
+                    const float tr = vr[k] * wr[j] - vi[k] * wi[j];
+                    const float ti = vr[k] * wi[j] + vi[k] * wr[j];
+
+                    vr[k] = ur[k] - tr;
+                    vi[k] = ui[k] - ti;
+                    ur[k] = ur[k] + tr;
+                    ui[k] = ui[k] + ti;
                 }
             }
         }
@@ -97,4 +131,3 @@ private:
 
 
 }
-
@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "../core/frame.hpp"
+#include "../core/types.hpp"
+
+namespace reson::dsp {
+
+template<size_t N>
+/**
+ * @ingroup dsp
+ * @brief Multi-bin Goertzel detector for a few known frequencies.
+ *
+ * Evaluates the power at K target frequencies of a `Frame<N>` in O(K*N),
+ * which beats a full `FFT<N>` + `power_spectrum()` when K is small (see
+ * `bench/goertzel_bench.cpp`). The filter states of a group of bins are
+ * updated together per sample, so the inner loop vectorizes across bins.
+ *
+ * Frequencies do not have to sit on FFT bin centers. The returned power uses
+ * the same scaling as `power_spectrum()` (`|X|^2 / N`).
+ *
+ * @tparam N Frame size.
+ */
+class Goertzel {
+public:
+    using frame_type = core::Frame<N>;
+
+    /**
+     * @param sample_rate Input signal sample rate (Hz).
+     * @param frequencies_hz Target frequencies (Hz).
+     */
+    Goertzel(float sample_rate, const std::vector<float>& frequencies_hz)
+        : frequencies_(frequencies_hz),
+          coeff_(frequencies_hz.size())
+    {
+        for (size_t k = 0; k < frequencies_.size(); ++k) {
+            const float w = 2.0f * core::PI * frequencies_[k] / sample_rate;
+            coeff_[k] = 2.0f * std::cos(w);
+        }
+    }
+
+    /**
+     * @brief Compute the power of every target frequency in one frame.
+     * @param frame Input time-domain frame.
+     * @param power Output, one value per target frequency.
+     */
+    void process(const core::Frame<N>& frame, std::vector<float>& power) const {
+        const size_t K = coeff_.size();
+        power.resize(K);
+
+        // Bins are processed in groups of LANES with the filter states in
+        // local arrays, so the per-sample update becomes a few vector ops and
+        // the independent lanes hide the latency of the recursion. The last
+        // group runs a kernel only as wide as the bins left in it, so a few
+        // bins do not pay for a full group.
+        size_t k0 = 0;
+        for (; k0 + LANES <= K; k0 += LANES) {
+            process_group<LANES>(frame, coeff_.data() + k0, LANES, power.data() + k0);
+        }
+
+        const size_t m = K - k0;
+        const float* c = coeff_.data() + k0;
+        float* p = power.data() + k0;
+        if (m > 8) {
+            process_group<16>(frame, c, m, p);
+        } else if (m > 4) {
+            process_group<8>(frame, c, m, p);
+        } else if (m > 2) {
+            process_group<4>(frame, c, m, p);
+        } else if (m == 2) {
+            process_group<2>(frame, c, m, p);
+        } else if (m == 1) {
+            process_group<1>(frame, c, m, p);
+        }
+    }
+
+    std::vector<float> process(const core::Frame<N>& frame) const {
+        std::vector<float> power;
+        process(frame, power);
+        return power;
+    }
+
+    const std::vector<float>& frequencies() const { return frequencies_; }
+    size_t size() const { return frequencies_.size(); }
+
+private:
+    static constexpr size_t LANES = 16;
+
+    // m <= W bins starting at coeff, W filters updated together per sample.
+    template<size_t W>
+    static void process_group(const core::Frame<N>& frame, const float* coeff, size_t m, float* power) {
+        float c[W] = {};
+        float s1[W] = {};
+        float s2[W] = {};
+        for (size_t j = 0; j < m; ++j) c[j] = coeff[j];
+
+        for (size_t n = 0; n < N; ++n) {
+            const float x = frame[n];
+            for (size_t j = 0; j < W; ++j) {
+                const float s0 = x + c[j] * s1[j] - s2[j];
+                s2[j] = s1[j];
+                s1[j] = s0;
+            }
+        }
+
+        for (size_t j = 0; j < m; ++j) {
+            const float p = s1[j] * s1[j] + s2[j] * s2[j] - c[j] * s1[j] * s2[j];
+            power[j] = std::max(p, 0.0f) / N;
+        }
+    }
+
+    std::vector<float> frequencies_;
+    std::vector<float> coeff_;
+};
+
+template<size_t N>
+/**
+ * @ingroup dsp
+ * @brief Sliding-window multi-bin detector.
+ *
+ * Tracks the DFT of the last `N` samples at K bins with a per-sample O(K)
+ * sliding DFT update, so the power of the target frequencies is available
+ * after every pushed sample. Target frequencies are rounded to the nearest
+ * bin of an `N`-point DFT (required for the recursive update to be exact).
+ *
+ * To keep float rounding from accumulating, the bin values are recomputed
+ * from the sample history with a Goertzel pass once every `N` samples, which
+ * costs O(K) per sample amortized.
+ *
+ * @tparam N Window length.
+ */
+class SlidingGoertzel {
+public:
+    using frame_type = core::Frame<N>;
+
+    /**
+     * @param sample_rate Input signal sample rate (Hz).
+     * @param frequencies_hz Target frequencies (Hz), rounded to DFT bins.
+     */
+    SlidingGoertzel(float sample_rate, const std::vector<float>& frequencies_hz)
+        : bins_(frequencies_hz.size()),
+          rot_re_(frequencies_hz.size()),
+          rot_im_(frequencies_hz.size()),
+          coeff_(frequencies_hz.size()),
+          re_(frequencies_hz.size()),
+          im_(frequencies_hz.size()),
+          s1_(frequencies_hz.size()),
+          s2_(frequencies_hz.size())
+    {
+        for (size_t k = 0; k < bins_.size(); ++k) {
+            long bin = std::lround(frequencies_hz[k] * N / sample_rate);
+            bin = std::min<long>(std::max<long>(bin, 0), N / 2);
+            bins_[k] = static_cast<size_t>(bin);
+
+            const double w = 2.0 * M_PI * bins_[k] / N;
+            rot_re_[k] = static_cast<float>(std::cos(w));
+            rot_im_[k] = static_cast<float>(std::sin(w));
+            coeff_[k] = 2.0f * rot_re_[k];
+        }
+        reset();
+    }
+
+    /**
+     * @brief Clear the window (all zeros) and the bin values.
+     */
+    void reset() {
+        history_.fill(0.0f);
+        pos_ = 0;
+        std::fill(re_.begin(), re_.end(), 0.0f);
+        std::fill(im_.begin(), im_.end(), 0.0f);
+    }
+
+    /**
+     * @brief Push one sample; the window now ends at this sample.
+     */
+    void push(float x) {
+        const float delta = x - history_[pos_];
+        history_[pos_] = x;
+        pos_ = (pos_ + 1) % N;
+
+        const size_t K = bins_.size();
+        float* re = re_.data();
+        float* im = im_.data();
+        const float* cr = rot_re_.data();
+        const float* ci = rot_im_.data();
+        for (size_t k = 0; k < K; ++k) {
+            const float r = re[k] + delta;
+            const float i = im[k];
+            re[k] = r * cr[k] - i * ci[k];
+            im[k] = r * ci[k] + i * cr[k];
+        }
+
+        if (pos_ == 0) {
+            resync();
+        }
+    }
+
+    /**
+     * @brief Push a block of samples.
+     */
+    void push(const float* samples, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            push(samples[i]);
+        }
+    }
+
+    /**
+     * @brief Push a whole frame (hop of `N`).
+     */
+    void push(const core::Frame<N>& frame) {
+        push(frame.samples.data(), N);
+    }
+
+    /**
+     * @brief Power (`|X|^2 / N`) of each target bin over the current window.
+     */
+    void power(std::vector<float>& out) const {
+        out.resize(bins_.size());
+        for (size_t k = 0; k < bins_.size(); ++k) {
+            out[k] = (re_[k] * re_[k] + im_[k] * im_[k]) / N;
+        }
+    }
+
+    std::vector<float> power() const {
+        std::vector<float> out;
+        power(out);
+        return out;
+    }
+
+    /** DFT bin index each target frequency was rounded to. */
+    const std::vector<size_t>& bins() const { return bins_; }
+    size_t size() const { return bins_.size(); }
+
+private:
+    std::vector<size_t> bins_;
+    std::vector<float> rot_re_;
+    std::vector<float> rot_im_;
+    std::vector<float> coeff_;
+    std::vector<float> re_;
+    std::vector<float> im_;
+    std::vector<float> s1_;
+    std::vector<float> s2_;
+    std::array<float, N> history_;
+    size_t pos_;
+
+    // Recompute the bin values from the history (oldest sample at pos_).
+    // Goertzel output y = e^{jw(N-1)} X; for integer bins X = e^{jw} y.
+    void resync() {
+        const size_t K = bins_.size();
+        float* s1 = s1_.data();
+        float* s2 = s2_.data();
+        const float* c = coeff_.data();
+        for (size_t k = 0; k < K; ++k) {
+            s1[k] = 0.0f;
+            s2[k] = 0.0f;
+        }
+
+        for (size_t n = 0; n < N; ++n) {
+            const float x = history_[(pos_ + n) % N];
+            for (size_t k = 0; k < K; ++k) {
+                const float s0 = x + c[k] * s1[k] - s2[k];
+                s2[k] = s1[k];
+                s1[k] = s0;
+            }
+        }
+
+        for (size_t k = 0; k < K; ++k) {
+            // y = s1 - e^{-jw} s2
+            const float yr = s1[k] - rot_re_[k] * s2[k];
+            const float yi = rot_im_[k] * s2[k];
+            re_[k] = yr * rot_re_[k] - yi * rot_im_[k];
+            im_[k] = yr * rot_im_[k] + yi * rot_re_[k];
+        }
+    }
+};
+
+}
@@ -38,6 +38,21 @@ namespace reson::dsp {
         return out;
     }
 
+    template<size_t N>
+    /**
+     * @ingroup dsp
+     * @brief Compute power spectrum from an SoA complex spectrum.
+     *
+     * Same result as the `Spectre<N>` overload, without re/im shuffles.
+     */
+    std::array<float, N> power_spectrum(const reson::core::SpectreSoA<N>& spec) {
+        std::array<float, N> out{};
+        constexpr float scale = 1.0f / N;
+        for (size_t i = 0; i < N; ++i)
+            out[i] = (spec.re[i] * spec.re[i] + spec.im[i] * spec.im[i]) * scale;
+        return out;
+    }
+
     inline int clamp_int(int v,int lo,int hi){ return std::min(hi,std::max(lo,v)); }
 
     /**
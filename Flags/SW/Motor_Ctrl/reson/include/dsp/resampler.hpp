@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "../core/types.hpp"
+
+namespace reson::dsp {
+
+/**
+ * @ingroup dsp
+ * @brief Streaming polyphase FIR resampler for rational rate ratios.
+ *
+ * Converts `input_rate` to `output_rate` by the reduced ratio `L / M`
+ * (upsample by `L`, low-pass, downsample by `M`) without ever building the
+ * upsampled signal: every output sample is one dot product of `taps_per_phase`
+ * input samples with one polyphase branch of a Kaiser-windowed sinc.
+ *
+ * Input can be pushed in blocks of any size; the filter history and the
+ * output phase are carried between calls, so block-wise processing gives the
+ * same samples as processing the whole signal at once. The output is delayed
+ * by `delay()` input samples (linear-phase filter).
+ *
+ * Branch coefficients are stored reversed and zero-padded to a multiple of
+ * `LANES`, so the dot product runs over contiguous memory with independent
+ * accumulators and vectorizes.
+ */
+class PolyphaseResampler {
+public:
+
+    /**
+     * @param input_rate Input sample rate (Hz).
+     * @param output_rate Output sample rate (Hz).
+     * @param taps_per_phase Filter taps per polyphase branch (quality vs. cost).
+     * @param cutoff Pass-band edge as a fraction of the lower Nyquist rate.
+     * @param kaiser_beta Kaiser window shape (stop-band attenuation).
+     */
+    PolyphaseResampler(int input_rate, int output_rate, int taps_per_phase = 32,
+                       float cutoff = 0.9f, float kaiser_beta = 8.0f)
+    {
+        if (input_rate <= 0 || output_rate <= 0)
+            throw std::invalid_argument("sample rates must be positive");
+        if (taps_per_phase <= 0)
+            throw std::invalid_argument("taps_per_phase must be positive");
+
+        const int g = std::gcd(input_rate, output_rate);
+        up_ = output_rate / g;
+        down_ = input_rate / g;
+        taps_ = static_cast<size_t>(taps_per_phase);
+        stride_ = (taps_ + LANES - 1) / LANES * LANES;
+
+        build_filter(cutoff, kaiser_beta);
+        reset();
+    }
+
+    /**
+     * @brief Clear the filter history and restart the output phase.
+     */
+    void reset() {
+        history_.assign(taps_ - 1, 0.0f);
+        position_ = 0;
+    }
+
+    /**
+     * @brief Resample a block of input samples.
+     * @param in Input samples.
+     * @param count Number of input samples.
+     * @param out Output samples are appended here.
+     * @return Number of output samples produced.
+     */
+    size_t process(const float* in, size_t count, std::vector<float>& out) {
+        history_.insert(history_.end(), in, in + count);
+
+        const size_t available = history_.size() - (taps_ - 1);
+        const size_t before = out.size();
+        out.reserve(before + (count * up_) / down_ + 1);
+
+        while (position_ / up_ < available) {
+            const size_t n = position_ / up_;
+            const size_t phase = position_ % up_;
+            out.push_back(dot(&coeffs_[phase * stride_], &history_[n]));
+            position_ += down_;
+        }
+
+        // Keep the taps_ - 1 samples in front of the next input sample needed.
+        const size_t consumed = std::min(position_ / up_, available);
+        history_.erase(history_.begin(), history_.begin() + consumed);
+        position_ -= consumed * up_;
+
+        return out.size() - before;
+    }
+
+    std::vector<float> process(const std::vector<float>& in) {
+        std::vector<float> out;
+        process(in.data(), in.size(), out);
+        return out;
+    }
+
+    /** Upsampling factor `L` of the reduced ratio. */
+    size_t up() const { return up_; }
+    /** Downsampling factor `M` of the reduced ratio. */
+    size_t down() const { return down_; }
+    size_t taps_per_phase() const { return taps_; }
+
+    /**
+     * @brief Group delay of the filter in input samples.
+     */
+    float delay() const { return (static_cast<float>(up_ * taps_) - 1.0f) / (2.0f * up_); }
+
+private:
+    static constexpr size_t LANES = 8;
+
+    size_t up_;
+    size_t down_;
+    size_t taps_;
+    size_t stride_;
+    // Branch p occupies [p * stride_, p * stride_ + stride_), reversed in time.
+    std::vector<float> coeffs_;
+    std::vector<float> history_;
+    // Position of the next output in the upsampled domain, relative to the
+    // first input sample that follows the carried history.
+    size_t position_;
+
+    float dot(const float* c, const float* x) const {
+        float acc[LANES] = {};
+        // Branch tail beyond taps_ is zero, but x may end there; stop at taps_.
+        size_t j = 0;
+        for (; j + LANES <= taps_; j += LANES)
+            for (size_t l = 0; l < LANES; ++l)
+                acc[l] += c[j + l] * x[j + l];
+        float sum = 0.0f;
+        for (; j < taps_; ++j)
+            sum += c[j] * x[j];
+        for (size_t l = 0; l < LANES; ++l)
+            sum += acc[l];
+        return sum;
+    }
+
+    static double bessel_i0(double x) {
+        double sum = 1.0, term = 1.0;
+        const double q = x * x / 4.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= q / (double(k) * k);
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    void build_filter(float cutoff, float beta) {
+        const size_t length = up_ * taps_;
+        // Cut-off in cycles per upsampled sample.
+        const double fc = 0.5 * cutoff / std::max(up_, down_);
+        const double center = (length - 1) / 2.0;
+        const double i0_beta = bessel_i0(beta);
+
+        std::vector<double> h(length);
+        for (size_t i = 0; i < length; ++i) {
+            const double t = i - center;
+            const double sinc = (t == 0.0) ? 1.0 : std::sin(2.0 * M_PI * fc * t) / (2.0 * M_PI * fc * t);
+            const double r = (length > 1) ? 2.0 * i / (length - 1) - 1.0 : 0.0;
+            const double w = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0_beta;
+            h[i] = 2.0 * fc * sinc * w;
+        }
+
+        // Normalize every branch to unit DC gain so there is no phase-dependent ripple.
+        coeffs_.assign(up_ * stride_, 0.0f);
+        for (size_t p = 0; p < up_; ++p) {
+            double sum = 0.0;
+            for (size_t t = 0; t < taps_; ++t) sum += h[p + up_ * t];
+            for (size_t t = 0; t < taps_; ++t)
+                coeffs_[p * stride_ + (taps_ - 1 - t)] = static_cast<float>(h[p + up_ * t] / sum);
+        }
+    }
+};
+
+}
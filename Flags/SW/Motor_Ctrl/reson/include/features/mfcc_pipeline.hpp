@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <vector>
 #include "../core/frame.hpp"
 #include "../core/spectre.hpp"
 #include "../core/types.hpp"
@@ -6,6 +8,7 @@
 #include "../dsp/helpers.hpp"
 #include "../dsp/window.hpp"
 #include "../dsp/mel.hpp"
+#include "../dsp/activity.hpp"
 
 
 template<size_t N>
@@ -21,12 +24,20 @@ template<size_t N>
  * - log compression
  * - DCT (keep first `n_mfcc`)
  *
+ * `process_chunk_gated()` runs an `ActivityDetector<N>` on the power spectra
+ * of a whole chunk of frames and skips the Mel/log/DCT stages only when no
+ * frame of the chunk is active. Frames of an active chunk always get their
+ * real MFCCs, the same as `process()`, because the model is trained on
+ * ungated features.
+ *
  * @tparam N Frame size.
  */
 class MFCCPipeline {
     public:
+        using frame_type = reson::core::Frame<N>;
       
-        MFCCPipeline(int sample_rate, int n_mels, int n_fft, int n_mfcc, int fmin_hz=0, int fmax_hz=-1)
+        MFCCPipeline(int sample_rate, int n_mels, int n_fft, int n_mfcc, int fmin_hz=0, int fmax_hz=-1,
+                     const reson::dsp::ActivityConfig& activity_config = reson::dsp::ActivityConfig())
             : fft_(),
               window_(reson::dsp::WindowType::Hann),
               mel_filter_bank_(sample_rate, n_fft, n_mels, fmin_hz, fmax_hz, true),
@@ -35,12 +46,12 @@ class MFCCPipeline {
               n_mels_(n_mels),
               n_fft_(n_fft),
               fmin_hz_(fmin_hz),
-              fmax_hz_(fmax_hz)
+              fmax_hz_(fmax_hz),
+              activity_(activity_config)
         {
           if(fmax_hz_ == -1) {
               fmax_hz_ = sample_rate_ / 2;
           }
-
         }
 
         /**
@@ -49,23 +60,65 @@ class MFCCPipeline {
          * @return Vector of MFCC coefficients (size = `n_mfcc`).
          */
         std::vector<float> process(const reson::core::Frame<N>& frame) {
+            auto power_spec = spectrum(frame);
+            std::vector<float> power_spec_vec(power_spec.begin(), power_spec.begin() + N/2 + 1);
+
+            return cepstrum(power_spec_vec);
+        }
+
+        /**
+         * @brief Run MFCC extraction on a chunk of frames, gated by the activity detector.
+         *
+         * All frames go through the power spectrum and the activity detector.
+         * If none of them is active the chunk stops there and the result is
+         * empty; otherwise every frame gets the same MFCCs as `process()`.
+         *
+         * @param frames Consecutive time-domain frames of one chunk.
+         * @param active Set to true if any frame of the chunk is active.
+         * @return One MFCC vector per frame, or nothing for an inactive chunk.
+         */
+        std::vector<std::vector<float>> process_chunk_gated(const std::vector<reson::core::Frame<N>>& frames, bool& active) {
+            chunk_spectra_.resize(frames.size());
+            active = false;
+            for(size_t i = 0; i < frames.size(); ++i) {
+                chunk_spectra_[i] = spectrum(frames[i]);
+                active |= activity_.update(chunk_spectra_[i]);
+            }
+
+            std::vector<std::vector<float>> mfccs;
+            if(!active) {
+                return mfccs;
+            }
+
+            mfccs.reserve(frames.size());
+            std::vector<float> power_spec_vec(N/2 + 1);
+            for(const auto& power_spec : chunk_spectra_) {
+                std::copy(power_spec.begin(), power_spec.begin() + N/2 + 1, power_spec_vec.begin());
+                mfccs.push_back(cepstrum(power_spec_vec));
+            }
+            return mfccs;
+        }
+
+        const reson::dsp::ActivityDetector<N>& activity() const { return activity_; }
+        reson::dsp::ActivityDetector<N>& activity() { return activity_; }
+
+    private:
+        std::array<float, N> spectrum(const reson::core::Frame<N>& frame) const {
             reson::core::Frame<N> windowed_frame = frame;
             window_.apply_window(windowed_frame);
 
-            reson::core::Spectre<N> spectre;
+            reson::core::SpectreSoA<N> spectre;
             fft_.process(windowed_frame, spectre);
 
-            auto power_spec = reson::dsp::power_spectrum(spectre);
-            std::vector<float> power_spec_vec(power_spec.begin(), power_spec.begin() + N/2 + 1);
+            return reson::dsp::power_spectrum(spectre);
+        }
 
-            auto mel_energies = mel_filter_bank_.apply(power_spec_vec);
+        std::vector<float> cepstrum(const std::vector<float>& power_spec) const {
+            auto mel_energies = mel_filter_bank_.apply(power_spec);
             auto log_mel = reson::dsp::log_compression(mel_energies);
-            auto mfccs = reson::dsp::dct(log_mel, n_mfcc_);
-
-            return mfccs;
+            return reson::dsp::dct(log_mel, n_mfcc_);
         }
 
-    private:
         reson::dsp::FFT<N> fft_;
         reson::dsp::Window<N> window_;
         reson::dsp::MelFilterBank mel_filter_bank_;
@@ -75,4 +128,6 @@ class MFCCPipeline {
         int n_fft_;
         int fmin_hz_;
         int fmax_hz_;
+        reson::dsp::ActivityDetector<N> activity_;
+        std::vector<std::array<float, N>> chunk_spectra_;
 };
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <dirent.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/features/mfcc_pipeline.hpp"
+#include "generator.hpp"
+#include "reference_mfcc.hpp"
+#include "wav_reader.hpp"
+
+// Accuracy-and-throughput regression harness.
+//
+// Runs MFCCPipeline<N> and the double-precision ReferenceMFCC<N> on the same
+// frames and reports per-coefficient max/mean absolute error together with
+// frames per second of both implementations. Optimizations of the pipeline
+// are accepted only while every signal family stays inside the error budget
+// below.
+
+#ifndef RESON_FIXTURE_DIR
+#define RESON_FIXTURE_DIR "tests/fixtures"
+#endif
+
+namespace {
+
+constexpr size_t N = 512;
+constexpr int SAMPLE_RATE = 16000;
+constexpr int N_MELS = 40;
+constexpr int N_MFCC = 13;
+
+// Error budget in the MFCC domain (natural-log Mel energies through an
+// orthonormal DCT). Bands that only catch window leakage sit close to the
+// log(1e-10) floor, where float rounding is amplified the most; that is what
+// sets the max bound.
+constexpr double MAX_ABS_ERROR_BUDGET = 1e-2;
+constexpr double MEAN_ABS_ERROR_BUDGET = 2e-3;
+
+struct ErrorReport {
+    std::string family;
+    size_t frames = 0;
+    std::vector<double> max_abs;
+    std::vector<double> mean_abs;
+    double reson_fps = 0.0;
+    double reference_fps = 0.0;
+
+    double worst_max() const { return *std::max_element(max_abs.begin(), max_abs.end()); }
+    double worst_mean() const { return *std::max_element(mean_abs.begin(), mean_abs.end()); }
+};
+
+template<typename F>
+double frames_per_second(size_t n_frames, F&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto stop = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    return seconds > 0.0 ? n_frames / seconds : 0.0;
+}
+
+ErrorReport measure(const std::string& family, const std::vector<reson::core::Frame<N>>& frames,
+                    int sample_rate = SAMPLE_RATE, int repeats = 20) {
+    MFCCPipeline<N> pipeline(sample_rate, N_MELS, N, N_MFCC);
+    ReferenceMFCC<N> reference(sample_rate, N_MELS, N, N_MFCC);
+
+    ErrorReport report;
+    report.family = family;
+    report.frames = frames.size();
+    report.max_abs.assign(N_MFCC, 0.0);
+    report.mean_abs.assign(N_MFCC, 0.0);
+
+    for (const auto& frame : frames) {
+        const auto got = pipeline.process(frame);
+        const auto want = reference.process(frame);
+        for (int c = 0; c < N_MFCC; ++c) {
+            const double err = std::abs(double(got[c]) - want[c]);
+            report.max_abs[c] = std::max(report.max_abs[c], err);
+            report.mean_abs[c] += err;
+        }
+    }
+    for (auto& e : report.mean_abs) e /= frames.size();
+
+    float sink = 0.0f;
+    report.reson_fps = frames_per_second(frames.size() * repeats, [&] {
+        for (int r = 0; r < repeats; ++r)
+            for (const auto& frame : frames)
+                sink += pipeline.process(frame)[0];
+    });
+    double ref_sink = 0.0;
+    report.reference_fps = frames_per_second(frames.size(), [&] {
+        for (const auto& frame : frames)
+            ref_sink += reference.process(frame)[0];
+    });
+    EXPECT_TRUE(std::isfinite(sink));
+    EXPECT_TRUE(std::isfinite(ref_sink));
+
+    return report;
+}
+
+void print_report(const ErrorReport& report) {
+    std::printf("[ accuracy ] %-14s frames=%zu  reson=%.0f fps  reference=%.0f fps\n",
+                report.family.c_str(), report.frames, report.reson_fps, report.reference_fps);
+    std::printf("[ accuracy ]   coeff   max_abs       mean_abs\n");
+    for (size_t c = 0; c < report.max_abs.size(); ++c)
+        std::printf("[ accuracy ]   %5zu   %.6e  %.6e\n", c, report.max_abs[c], report.mean_abs[c]);
+}
+
+void expect_within_budget(const ErrorReport& report) {
+    print_report(report);
+    EXPECT_LE(report.worst_max(), MAX_ABS_ERROR_BUDGET) << report.family;
+    EXPECT_LE(report.worst_mean(), MEAN_ABS_ERROR_BUDGET) << report.family;
+}
+
+std::vector<reson::core::Frame<N>> frames_from_signal(const std::vector<float>& signal, size_t hop) {
+    std::vector<reson::core::Frame<N>> frames;
+    for (size_t start = 0; start + N <= signal.size(); start += hop) {
+        reson::core::Frame<N> frame;
+        std::copy(signal.begin() + start, signal.begin() + start + N, frame.samples.begin());
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+}
+
+TEST(Accuracy, SinusoidsWithinBudget) {
+    std::vector<reson::core::Frame<N>> frames;
+    for (float f : {100.0f, 440.0f, 1000.0f, 3000.0f, 7000.0f})
+        for (float a : {0.05f, 0.5f, 1.0f})
+            frames.push_back(create_single_sinusoid_frame<N>(a, f, SAMPLE_RATE));
+    frames.push_back(create_sum_sinusoids_frame<N>({220.0f, 440.0f, 880.0f}, 0.3f, SAMPLE_RATE));
+    frames.push_back(create_sum_sinusoids_frame<N>({300.0f, 1200.0f, 5000.0f}, 0.3f, SAMPLE_RATE));
+
+    expect_within_budget(measure("sinusoids", frames));
+}
+
+TEST(Accuracy, WhiteNoiseWithinBudget) {
+    std::vector<reson::core::Frame<N>> frames;
+    for (float a : {0.01f, 0.1f, 0.5f, 1.0f})
+        frames.push_back(create_white_noise_frame<N>(a));
+
+    expect_within_budget(measure("white_noise", frames));
+}
+
+TEST(Accuracy, ImpulseAndRampWithinBudget) {
+    std::vector<reson::core::Frame<N>> frames;
+    frames.push_back(create_impulse_frame<N>(1.0f));
+    frames.push_back(create_impulse_frame<N>(0.1f));
+    frames.push_back(create_ramp_frame<N>(0.0f, 1.0f));
+    frames.push_back(create_ramp_frame<N>(-1.0f, 1.0f));
+
+    expect_within_budget(measure("impulse_ramp", frames));
+}
+
+TEST(Accuracy, DcAndZeroWithinBudget) {
+    std::vector<reson::core::Frame<N>> frames;
+    frames.push_back(create_dc_frame<N>(1.0f));
+    frames.push_back(create_dc_frame<N>(0.25f));
+    frames.push_back(create_zero_frame<N>());
+
+    expect_within_budget(measure("dc_zero", frames));
+}
+
+// Generated clip written as 16-bit stereo PCM and read back, so the WAV reader
+// and the fixture path run even when no recording is committed: two detuned
+// Karplus-Strong plucks per note (one per channel) over quiet noise, 2 s at
+// 22050 Hz.
+TEST(Accuracy, GeneratedWavWithinBudget) {
+    constexpr int rate = 22050;
+    constexpr size_t length = 2 * rate;
+    std::default_random_engine generator(7);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    std::vector<float> channels[2];
+    for (int c = 0; c < 2; ++c) {
+        channels[c].assign(length, 0.0f);
+        size_t start = 0;
+        for (float note : {196.0f, 247.0f, 294.0f, 392.0f}) {
+            const size_t period = static_cast<size_t>(rate / (note * (1.0f + 0.003f * c)));
+            std::vector<float> line(period);
+            for (auto& v : line) v = 0.4f * noise(generator);
+            for (size_t i = start; i < std::min(length, start + rate / 2); ++i) {
+                const size_t k = (i - start) % period;
+                const float out = line[k];
+                line[k] = 0.498f * (out + line[(k + 1) % period]);
+                channels[c][i] = out;
+            }
+            start += rate / 2;
+        }
+        for (auto& v : channels[c]) v += 0.002f * noise(generator);
+    }
+
+    std::vector<float> interleaved(2 * length);
+    for (size_t i = 0; i < length; ++i) {
+        interleaved[2 * i] = channels[0][i];
+        interleaved[2 * i + 1] = channels[1][i];
+    }
+    const std::string path = ::testing::TempDir() + "reson_generated_pluck.wav";
+    ASSERT_TRUE(write_wav_pcm16(path, rate, 2, interleaved)) << path;
+
+    WavData wav;
+    ASSERT_TRUE(read_wav(path, wav)) << path;
+    std::remove(path.c_str());
+    ASSERT_EQ(wav.sample_rate, rate);
+    ASSERT_EQ(wav.samples.size(), length);
+    for (size_t i = 0; i < length; ++i) {
+        // downmix of two 16-bit quantized channels
+        ASSERT_NEAR(wav.samples[i], 0.5f * (channels[0][i] + channels[1][i]), 2.0f / 32767.0f) << i;
+    }
+
+    auto frames = frames_from_signal(wav.samples, N / 2);
+    ASSERT_FALSE(frames.empty());
+    expect_within_budget(measure("generated_wav", frames, wav.sample_rate, 1));
+}
+
+// Recorded fixtures: every *.wav in RESON_FIXTURE_DIR, framed with hop N/2.
+TEST(Accuracy, WavFixturesWithinBudget) {
+    DIR* dir = opendir(RESON_FIXTURE_DIR);
+    if (dir == nullptr)
+        GTEST_SKIP() << "no fixture directory " << RESON_FIXTURE_DIR;
+
+    std::vector<std::string> paths;
+    while (dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0)
+            paths.push_back(std::string(RESON_FIXTURE_DIR) + "/" + name);
+    }
+    closedir(dir);
+    if (paths.empty())
+        GTEST_SKIP() << "no *.wav fixtures in " << RESON_FIXTURE_DIR;
+
+    std::sort(paths.begin(), paths.end());
+    for (const auto& path : paths) {
+        WavData wav;
+        ASSERT_TRUE(read_wav(path, wav)) << path;
+
+        auto frames = frames_from_signal(wav.samples, N / 2);
+        if (frames.empty()) continue;
+
+        expect_within_budget(measure(path.substr(path.find_last_of('/') + 1), frames, wav.sample_rate, 1));
+    }
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../include/core/frame.hpp"
+#include "../include/core/spectre.hpp"
+#include "../include/dsp/fft.hpp"
+#include "../include/dsp/helpers.hpp"
+#include "../include/dsp/activity.hpp"
+#include "../include/features/mfcc_pipeline.hpp"
+#include "generator.hpp"
+
+template<size_t N>
+std::array<float, N> power_of(const reson::core::Frame<N>& frame) {
+    reson::dsp::FFT<N> fft;
+    reson::core::Spectre<N> spectre;
+    fft.process(frame, spectre);
+    return reson::dsp::power_spectrum(spectre);
+}
+
+// Test that silence is inactive and a tone after silence is active
+TEST(ActivityDetector, SilenceInactiveToneActive) {
+    constexpr size_t N = 512;
+    reson::dsp::ActivityDetector<N> detector;
+
+    auto silence = power_of(create_zero_frame<N>());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(detector.update(silence));
+    }
+
+    auto tone = power_of(create_single_sinusoid_frame<N>(0.5f, 440.0f, 16000.0f));
+    EXPECT_TRUE(detector.update(tone));
+    EXPECT_LT(detector.flatness(), 0.3f);
+    EXPECT_GT(detector.energy_db(), detector.noise_floor_db());
+}
+
+// Test that stationary white noise is not reported as activity
+TEST(ActivityDetector, WhiteNoiseIsInactive) {
+    constexpr size_t N = 512;
+    reson::dsp::ActivityDetector<N> detector;
+
+    auto noise = power_of(create_white_noise_frame<N>(0.1f));
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_FALSE(detector.update(noise));
+    }
+    EXPECT_GT(detector.flatness(), 0.3f);
+}
+
+// Test that the hangover keeps the flag up for a few frames after activity
+TEST(ActivityDetector, HangoverHoldsActivity) {
+    constexpr size_t N = 512;
+    reson::dsp::ActivityConfig config;
+    config.hangover_frames = 2;
+    reson::dsp::ActivityDetector<N> detector(config);
+
+    auto silence = power_of(create_zero_frame<N>());
+    auto tone = power_of(create_single_sinusoid_frame<N>(0.5f, 440.0f, 16000.0f));
+
+    detector.update(silence);
+    EXPECT_TRUE(detector.update(tone));
+    EXPECT_TRUE(detector.update(silence));
+    EXPECT_TRUE(detector.update(silence));
+    EXPECT_FALSE(detector.update(silence));
+    EXPECT_EQ(detector.active_frames(), 3u);
+    EXPECT_EQ(detector.frames_seen(), 5u);
+}
+
+// Test that an active chunk with pauses gets exactly the ungated MFCCs for every frame,
+// so the model sees the same features it was trained on
+TEST(MFCCPipeline, ActiveChunkMatchesUngated) {
+    constexpr size_t N = 512;
+    MFCCPipeline<N> gated_pipeline(16000, 40, 512, 13);
+    MFCCPipeline<N> ungated_pipeline(16000, 40, 512, 13);
+
+    std::vector<reson::core::Frame<N>> chunk;
+    chunk.push_back(create_single_sinusoid_frame<N>(0.5f, 440.0f, 16000.0f));
+    for (int i = 0; i < 4; ++i) {
+        chunk.push_back(create_zero_frame<N>()); // pause
+    }
+    chunk.push_back(create_white_noise_frame<N>(0.01f)); // quiet passage
+    chunk.push_back(create_single_sinusoid_frame<N>(0.05f, 880.0f, 16000.0f)); // fade
+
+    bool active = false;
+    auto gated = gated_pipeline.process_chunk_gated(chunk, active);
+    EXPECT_TRUE(active);
+    ASSERT_EQ(gated.size(), chunk.size());
+    for (size_t f = 0; f < chunk.size(); ++f) {
+        auto ungated = ungated_pipeline.process(chunk[f]);
+        ASSERT_EQ(gated[f].size(), ungated.size());
+        for (size_t i = 0; i < ungated.size(); ++i) {
+            EXPECT_FLOAT_EQ(gated[f][i], ungated[i]) << "frame " << f;
+        }
+    }
+}
+
+// Test that a chunk without activity skips the Mel/log/DCT stages
+TEST(MFCCPipeline, SilentChunkIsSkipped) {
+    constexpr size_t N = 512;
+    MFCCPipeline<N> mfcc_pipeline(16000, 40, 512, 13);
+
+    std::vector<reson::core::Frame<N>> chunk(8, create_zero_frame<N>());
+    bool active = true;
+    auto mfccs = mfcc_pipeline.process_chunk_gated(chunk, active);
+    EXPECT_FALSE(active);
+    EXPECT_TRUE(mfccs.empty());
+}
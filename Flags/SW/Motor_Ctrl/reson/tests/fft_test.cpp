@@ -109,3 +109,62 @@ TEST(Helpers, LogCompressionAndDctReturnFinite) {
         EXPECT_TRUE(std::isfinite(val));
     }
 }
+
+// Test that the SoA output matches the interleaved output and the copy helpers
+TEST(FFT, SoAMatchesInterleaved) {
+    constexpr size_t N = 512;
+    reson::core::Frame<N> frame = create_sum_sinusoids_frame<N>({440.0f, 1250.0f, 3000.0f}, 0.5f, 16000.0f);
+    reson::core::Spectre<N> spectre;
+    reson::core::SpectreSoA<N> soa;
+
+    reson::dsp::FFT<N> fft;
+    fft.process(frame, spectre);
+    fft.process(frame, soa);
+
+    reson::core::Spectre<N> converted;
+    reson::core::to_interleaved(soa, converted);
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_FLOAT_EQ(soa[i].real(), spectre[i].real());
+        EXPECT_FLOAT_EQ(soa[i].imag(), spectre[i].imag());
+        EXPECT_EQ(converted[i], spectre[i]);
+    }
+
+    reson::core::SpectreSoA<N> back;
+    reson::core::to_soa(spectre, back);
+    auto power = reson::dsp::power_spectrum(spectre);
+    auto power_soa = reson::dsp::power_spectrum(back);
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_FLOAT_EQ(power[i], power_soa[i]);
+    }
+}
+
+// Test that SoA element access is a view over re/im, not a copy
+TEST(CoreFrameSpectre, SoAElementIsView) {
+    constexpr size_t N = 8;
+    reson::core::SpectreSoA<N> soa;
+    soa.re.fill(0.0f);
+    soa.im.fill(0.0f);
+
+    soa[3] = std::complex<float>(1.5f, -2.0f);
+    EXPECT_FLOAT_EQ(soa.re[3], 1.5f);
+    EXPECT_FLOAT_EQ(soa.im[3], -2.0f);
+
+    soa[5] = soa[3];
+    std::complex<float> value = soa[5];
+    EXPECT_EQ(value, std::complex<float>(1.5f, -2.0f));
+
+    soa.re[3] = 4.0f;
+    EXPECT_FLOAT_EQ(soa[3].real(), 4.0f);
+    EXPECT_FLOAT_EQ(soa[5].real(), 1.5f);
+}
+
+// Test that frame and SoA storage are SIMD aligned
+TEST(CoreFrameSpectre, StorageIsAligned) {
+    constexpr size_t N = 512;
+    reson::core::Frame<N> frame;
+    reson::core::SpectreSoA<N> soa;
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(frame.samples.data()) % reson::core::SIMD_ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(soa.re.data()) % reson::core::SIMD_ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(soa.im.data()) % reson::core::SIMD_ALIGNMENT, 0u);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "../include/core/frame.hpp"
+#include "../include/core/spectre.hpp"
+#include "../include/dsp/fft.hpp"
+#include "../include/dsp/helpers.hpp"
+#include "../include/dsp/goertzel.hpp"
+#include "generator.hpp"
+
+// Test that Goertzel power matches the FFT power spectrum on bin centers
+TEST(Goertzel, MatchesFFTOnBinCenters) {
+    constexpr size_t N = 512;
+    const float sample_rate = 16000.0f;
+    const std::vector<size_t> bins = {5, 14, 64, 200};
+
+    std::vector<float> freqs;
+    for (size_t k : bins) freqs.push_back(k * sample_rate / N);
+
+    reson::core::Frame<N> frame = create_sum_sinusoids_frame<N>({440.0f, 2000.0f, 6250.0f}, 0.5f, sample_rate);
+
+    reson::dsp::FFT<N> fft;
+    reson::core::SpectreSoA<N> spectre;
+    fft.process(frame, spectre);
+    auto expected = reson::dsp::power_spectrum(spectre);
+
+    reson::dsp::Goertzel<N> goertzel(sample_rate, freqs);
+    auto power = goertzel.process(frame);
+
+    ASSERT_EQ(power.size(), bins.size());
+    for (size_t i = 0; i < bins.size(); ++i) {
+        EXPECT_NEAR(power[i], expected[bins[i]], 1e-3f + expected[bins[i]] * 1e-3f);
+    }
+}
+
+// Test that an off-bin tone is picked up at its own frequency and not elsewhere
+TEST(Goertzel, DetectsOffBinTone) {
+    constexpr size_t N = 1024;
+    const float sample_rate = 22050.0f;
+    reson::core::Frame<N> frame = create_single_sinusoid_frame<N>(1.0f, 1234.5f, sample_rate);
+
+    reson::dsp::Goertzel<N> goertzel(sample_rate, {1234.5f, 3000.0f});
+    auto power = goertzel.process(frame);
+
+    EXPECT_NEAR(power[0], N / 4.0f, N / 4.0f * 0.01f);
+    EXPECT_LT(power[1], power[0] * 1e-3f);
+}
+
+// Test that every group width (full groups and 1/2/4/8/16-wide tails) gives the
+// same power as evaluating each bin on its own
+TEST(Goertzel, GroupWidthsMatchSingleBins) {
+    constexpr size_t N = 512;
+    const float sample_rate = 16000.0f;
+    reson::core::Frame<N> frame = create_sum_sinusoids_frame<N>({440.0f, 2000.0f, 6250.0f}, 0.5f, sample_rate);
+
+    for (size_t K : {1u, 2u, 3u, 5u, 9u, 16u, 17u, 35u}) {
+        std::vector<float> freqs;
+        for (size_t k = 0; k < K; ++k) freqs.push_back(100.0f + 211.0f * k);
+
+        reson::dsp::Goertzel<N> goertzel(sample_rate, freqs);
+        auto power = goertzel.process(frame);
+        ASSERT_EQ(power.size(), K);
+        for (size_t k = 0; k < K; ++k) {
+            reson::dsp::Goertzel<N> single(sample_rate, {freqs[k]});
+            EXPECT_FLOAT_EQ(power[k], single.process(frame)[0]) << "K=" << K << " k=" << k;
+        }
+    }
+}
+
+// Test that the sliding detector matches a block Goertzel over the same window
+TEST(SlidingGoertzel, MatchesBlockOverWindow) {
+    constexpr size_t N = 256;
+    const float sample_rate = 8000.0f;
+    const std::vector<float> freqs = {500.0f, 1000.0f, 1531.25f};
+
+    std::vector<float> signal(3 * N + 77);
+    for (size_t n = 0; n < signal.size(); ++n)
+        signal[n] = 0.7f * std::sin(2.0f * reson::core::PI * 1000.0f * n / sample_rate)
+                  + 0.2f * std::sin(2.0f * reson::core::PI * 1531.25f * n / sample_rate);
+
+    reson::dsp::SlidingGoertzel<N> sliding(sample_rate, freqs);
+    reson::dsp::Goertzel<N> block(sample_rate, freqs);
+
+    for (size_t end = 0; end < signal.size(); ++end) {
+        sliding.push(signal[end]);
+        if (end + 1 < N || (end % 37) != 0) continue;
+
+        reson::core::Frame<N> window;
+        for (size_t n = 0; n < N; ++n) window[n] = signal[end + 1 - N + n];
+
+        auto expected = block.process(window);
+        auto power = sliding.power();
+        for (size_t k = 0; k < freqs.size(); ++k)
+            EXPECT_NEAR(power[k], expected[k], 1e-3f + expected[k] * 1e-3f) << "end=" << end << " k=" << k;
+    }
+}
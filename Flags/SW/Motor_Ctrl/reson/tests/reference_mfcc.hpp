@@ -0,0 +1,118 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include "../include/core/frame.hpp"
+
+// Double-precision reference MFCC used to measure the error of the reson
+// pipeline. Deliberately straightforward: direct DFT, dense filter bank,
+// no shortcuts. Follows the same conventions as MFCCPipeline (symmetric Hann
+// window, |X[k]|^2 / N, sum-normalized triangular Mel filters, log(x + 1e-10),
+// orthonormal DCT-II).
+template<size_t N>
+class ReferenceMFCC {
+public:
+    ReferenceMFCC(int sample_rate, int n_mels, int n_fft, int n_mfcc, double fmin_hz = 0.0, double fmax_hz = -1.0)
+        : sample_rate_(sample_rate), n_mels_(n_mels), n_fft_(n_fft), n_mfcc_(n_mfcc)
+    {
+        if (fmax_hz <= 0) fmax_hz = sample_rate / 2.0;
+
+        window_.resize(N);
+        for (size_t n = 0; n < N; ++n)
+            window_[n] = 0.5 * (1.0 - std::cos(2.0 * M_PI * n / (N - 1)));
+
+        const size_t n_bins = N / 2 + 1;
+        cos_table_.resize(n_bins * N);
+        sin_table_.resize(n_bins * N);
+        for (size_t k = 0; k < n_bins; ++k) {
+            for (size_t n = 0; n < N; ++n) {
+                const double angle = 2.0 * M_PI * double((k * n) % N) / N;
+                cos_table_[k * N + n] = std::cos(angle);
+                sin_table_[k * N + n] = std::sin(angle);
+            }
+        }
+
+        build_filterbank(fmin_hz, fmax_hz);
+    }
+
+    std::vector<double> process(const reson::core::Frame<N>& frame) const {
+        const size_t n_bins = N / 2 + 1;
+
+        std::vector<double> x(N);
+        for (size_t n = 0; n < N; ++n)
+            x[n] = double(frame[n]) * window_[n];
+
+        std::vector<double> power(n_bins);
+        for (size_t k = 0; k < n_bins; ++k) {
+            double re = 0.0, im = 0.0;
+            for (size_t n = 0; n < N; ++n) {
+                re += x[n] * cos_table_[k * N + n];
+                im -= x[n] * sin_table_[k * N + n];
+            }
+            power[k] = (re * re + im * im) / N;
+        }
+
+        std::vector<double> log_mel(n_mels_);
+        for (int m = 0; m < n_mels_; ++m) {
+            double e = 0.0;
+            for (size_t k = 0; k < n_bins; ++k)
+                e += power[k] * filterbank_[m][k];
+            log_mel[m] = std::log(e + 1e-10);
+        }
+
+        std::vector<double> mfcc(n_mfcc_, 0.0);
+        for (int c = 0; c < n_mfcc_; ++c) {
+            const double factor = (c == 0) ? std::sqrt(1.0 / n_mels_) : std::sqrt(2.0 / n_mels_);
+            for (int m = 0; m < n_mels_; ++m)
+                mfcc[c] += log_mel[m] * std::cos(M_PI * c * (m + 0.5) / n_mels_);
+            mfcc[c] *= factor;
+        }
+        return mfcc;
+    }
+
+private:
+    int sample_rate_;
+    int n_mels_;
+    int n_fft_;
+    int n_mfcc_;
+    std::vector<double> window_;
+    std::vector<double> cos_table_;
+    std::vector<double> sin_table_;
+    std::vector<std::vector<double>> filterbank_;
+
+    static double hz_to_mel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+    static double mel_to_hz(double mel) { return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0); }
+
+    void build_filterbank(double fmin_hz, double fmax_hz) {
+        const int n_bins = n_fft_ / 2 + 1;
+        const double mel_min = hz_to_mel(fmin_hz);
+        const double mel_max = hz_to_mel(fmax_hz);
+
+        std::vector<int> bin_points(n_mels_ + 2);
+        for (int i = 0; i < n_mels_ + 2; ++i) {
+            const double mel = mel_min + i * (mel_max - mel_min) / (n_mels_ + 1);
+            const int bin = static_cast<int>(std::floor(mel_to_hz(mel) * n_fft_ / sample_rate_));
+            bin_points[i] = std::min(n_bins - 1, std::max(0, bin));
+        }
+
+        filterbank_.assign(n_mels_, std::vector<double>(n_bins, 0.0));
+        for (int m = 0; m < n_mels_; ++m) {
+            int left = bin_points[m];
+            int center = bin_points[m + 1];
+            int right = bin_points[m + 2];
+            if (left == center) center = std::min(center + 1, n_bins - 1);
+            if (center == right) right = std::min(right + 1, n_bins - 1);
+
+            for (int k = left; k < center; ++k)
+                filterbank_[m][k] = (double(k) - left) / double(center - left);
+            for (int k = center; k < right; ++k)
+                filterbank_[m][k] = (right - double(k)) / double(right - center);
+
+            double sum = 0.0;
+            for (double w : filterbank_[m]) sum += w;
+            if (sum > 0.0)
+                for (double& w : filterbank_[m]) w /= sum;
+        }
+    }
+};
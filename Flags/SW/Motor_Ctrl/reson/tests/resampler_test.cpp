@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "../include/core/frame.hpp"
+#include "../include/dsp/resampler.hpp"
+#include "../include/dsp/goertzel.hpp"
+
+static std::vector<float> tone(float freq, float sample_rate, size_t n, float amplitude = 0.5f) {
+    std::vector<float> out(n);
+    for (size_t i = 0; i < n; ++i)
+        out[i] = amplitude * std::sin(2.0f * reson::core::PI * freq * i / sample_rate);
+    return out;
+}
+
+// Test that the rate ratio is reduced and the output length follows it
+TEST(PolyphaseResampler, ReducesRatioAndKeepsLength) {
+    reson::dsp::PolyphaseResampler half(44100, 22050);
+    EXPECT_EQ(half.up(), 1u);
+    EXPECT_EQ(half.down(), 2u);
+
+    reson::dsp::PolyphaseResampler odd(48000, 22050);
+    EXPECT_EQ(odd.up(), 147u);
+    EXPECT_EQ(odd.down(), 320u);
+
+    auto out = odd.process(std::vector<float>(48000, 0.0f));
+    EXPECT_NEAR(static_cast<double>(out.size()), 22050.0, 1.0);
+}
+
+// Test that block-wise streaming gives exactly the same samples as one call
+TEST(PolyphaseResampler, StreamingMatchesOneShot) {
+    auto in = tone(1000.0f, 48000.0f, 10000);
+
+    reson::dsp::PolyphaseResampler one_shot(48000, 22050);
+    auto expected = one_shot.process(in);
+
+    reson::dsp::PolyphaseResampler streaming(48000, 22050);
+    std::vector<float> out;
+    size_t pos = 0;
+    const size_t blocks[] = {1, 7, 128, 333, 1024, 5};
+    for (size_t b = 0; pos < in.size(); ++b) {
+        const size_t count = std::min(blocks[b % 6], in.size() - pos);
+        streaming.process(in.data() + pos, count, out);
+        pos += count;
+    }
+
+    ASSERT_EQ(out.size(), expected.size());
+    for (size_t i = 0; i < out.size(); ++i)
+        EXPECT_EQ(out[i], expected[i]) << i;
+}
+
+// Test that an in-band tone keeps its frequency and amplitude
+TEST(PolyphaseResampler, PreservesInBandTone) {
+    constexpr size_t N = 1024;
+    const float f = 1000.0f;
+    for (int input_rate : {44100, 48000}) {
+        reson::dsp::PolyphaseResampler resampler(input_rate, 22050);
+        auto out = resampler.process(tone(f, static_cast<float>(input_rate), input_rate / 2));
+
+        // Skip the filter start-up, then check the DC/tone gain.
+        reson::core::Frame<N> frame;
+        for (size_t i = 0; i < N; ++i) frame[i] = out[2000 + i];
+
+        reson::dsp::Goertzel<N> goertzel(22050.0f, {f, 5000.0f});
+        auto power = goertzel.process(frame);
+        // 0.5 amplitude tone: |X|^2 / N = (0.5 * N / 2)^2 / N
+        const float expected = 0.25f * N / 4.0f;
+        EXPECT_NEAR(power[0], expected, expected * 0.05f) << input_rate;
+        EXPECT_LT(power[1], expected * 1e-3f) << input_rate;
+    }
+}
+
+// Test that a tone above the output Nyquist rate is suppressed, not aliased
+TEST(PolyphaseResampler, RejectsAliasingTone) {
+    reson::dsp::PolyphaseResampler resampler(48000, 22050);
+    auto out = resampler.process(tone(15000.0f, 48000.0f, 24000));
+
+    double energy = 0.0;
+    for (size_t i = 2000; i < out.size(); ++i) energy += out[i] * out[i];
+    const double rms = std::sqrt(energy / (out.size() - 2000));
+    EXPECT_LT(rms, 0.5 / std::sqrt(2.0) * 1e-3);
+}
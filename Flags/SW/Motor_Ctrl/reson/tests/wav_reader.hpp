@@ -0,0 +1,105 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Minimal RIFF/WAVE reader for test fixtures. Supports 16-bit PCM and 32-bit
+// float, any channel count (channels are averaged to mono). `write_wav_pcm16`
+// writes the 16-bit PCM files the reader expects, for generated fixtures.
+struct WavData {
+    int sample_rate = 0;
+    std::vector<float> samples;
+};
+
+inline bool read_wav(const std::string& path, WavData& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char riff[12];
+    if (!file.read(riff, 12) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+        return false;
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t sample_rate = 0;
+    bool have_fmt = false;
+
+    char id[4];
+    uint32_t size = 0;
+    while (file.read(id, 4) && file.read(reinterpret_cast<char*>(&size), 4)) {
+        if (std::memcmp(id, "fmt ", 4) == 0) {
+            std::vector<char> fmt(size);
+            if (size < 16 || !file.read(fmt.data(), size)) return false;
+            std::memcpy(&format, fmt.data(), 2);
+            std::memcpy(&channels, fmt.data() + 2, 2);
+            std::memcpy(&sample_rate, fmt.data() + 4, 4);
+            std::memcpy(&bits, fmt.data() + 14, 2);
+            have_fmt = true;
+        } else if (std::memcmp(id, "data", 4) == 0) {
+            if (!have_fmt || channels == 0) return false;
+            const bool pcm16 = format == 1 && bits == 16;
+            const bool float32 = format == 3 && bits == 32;
+            if (!pcm16 && !float32) return false;
+
+            std::vector<char> raw(size);
+            if (!file.read(raw.data(), size)) return false;
+
+            const size_t bytes = bits / 8;
+            const size_t n_frames = size / (bytes * channels);
+            out.sample_rate = static_cast<int>(sample_rate);
+            out.samples.assign(n_frames, 0.0f);
+            for (size_t i = 0; i < n_frames; ++i) {
+                float acc = 0.0f;
+                for (size_t c = 0; c < channels; ++c) {
+                    const char* p = raw.data() + (i * channels + c) * bytes;
+                    if (pcm16) {
+                        int16_t v;
+                        std::memcpy(&v, p, 2);
+                        acc += v / 32768.0f;
+                    } else {
+                        float v;
+                        std::memcpy(&v, p, 4);
+                        acc += v;
+                    }
+                }
+                out.samples[i] = acc / channels;
+            }
+            return true;
+        } else {
+            file.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+    return false;
+}
+
+// Writes interleaved samples in [-1, 1] as 16-bit PCM.
+inline bool write_wav_pcm16(const std::string& path, int sample_rate, int channels,
+                            const std::vector<float>& interleaved) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    auto put16 = [&](uint16_t v) { file.write(reinterpret_cast<const char*>(&v), 2); };
+    auto put32 = [&](uint32_t v) { file.write(reinterpret_cast<const char*>(&v), 4); };
+
+    const uint32_t data_size = static_cast<uint32_t>(interleaved.size() * 2);
+    file.write("RIFF", 4);
+    put32(36 + data_size);
+    file.write("WAVE", 4);
+    file.write("fmt ", 4);
+    put32(16);
+    put16(1);
+    put16(static_cast<uint16_t>(channels));
+    put32(static_cast<uint32_t>(sample_rate));
+    put32(static_cast<uint32_t>(sample_rate * channels * 2));
+    put16(static_cast<uint16_t>(channels * 2));
+    put16(16);
+    file.write("data", 4);
+    put32(data_size);
+    for (float x : interleaved) {
+        const float clamped = x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x);
+        put16(static_cast<uint16_t>(static_cast<int16_t>(std::lround(clamped * 32767.0f))));
+    }
+    return static_cast<bool>(file);
+}